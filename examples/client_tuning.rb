@@ -0,0 +1,22 @@
+require_relative './common/common'
+
+def main
+  Common::Common.run_example do |client, namespace, set, logger|
+    settings = {
+      max_connections_per_node: 64,
+      min_connections_per_node: 16,
+      connect_timeout: 500,
+      tender_interval: 1000,
+      thread_pool_size: 4
+    }
+    started = Time.now
+    tuned_client = AerospikeNative::Client.new([{host: '127.0.0.1', port: 3010}], settings)
+    logger.info "Connected with warmed up pools in #{((Time.now - started) * 1000).round} ms"
+
+    key = AerospikeNative::Key.new(namespace, set, 'tuning')
+    tuned_client.put(key, {'value' => 1})
+    logger.info tuned_client.get(key).inspect
+  end
+end
+
+main
@@ -0,0 +1,26 @@
+require_relative './common/common'
+
+def main
+  Common::Common.run_example do |client, namespace, set, logger|
+    nodes = client.nodes
+    nodes.each do |node|
+      logger.info "Node #{node['name']} at #{node['address']} (build #{node['build']}), master partitions: #{node['partitions'].inspect}"
+    end
+
+    logger.info "Sets: #{client.info("sets/#{namespace}/#{set}", node: nodes.first['name']).inspect}"
+    logger.info "Statistics: #{client.info('statistics', raw: true).inspect}"
+
+    10.times do |i|
+      key = AerospikeNative::Key.new(namespace, set, i)
+      client.put(key, {'value' => i})
+    end
+
+    stats = client.namespace_stats(namespace)
+    logger.info "Namespace #{namespace} totals: #{stats['total'].inspect}"
+    stats['nodes'].each do |name, node_stats|
+      logger.info "Node #{name} objects: #{node_stats['objects'] || node_stats['master-objects']}"
+    end
+  end
+end
+
+main
@@ -0,0 +1,26 @@
+require_relative './common/common'
+require 'tmpdir'
+
+def main
+  Common::Common.run_example do |client, namespace, set, logger|
+    1000.times do |i|
+      client.put(AerospikeNative::Key.new(namespace, set, i), {'number' => i, 'info' => {'user' => "user#{i}"}})
+    end
+
+    Dir.mktmpdir do |dir|
+      path = File.join(dir, 'records.msgpack')
+      records = client.scan(namespace, set).export(path)
+      logger.info "exported #{records} records into #{path}"
+
+      stats = client.import(path, namespace, "#{set}_copy", {concurrency: 32, progress_interval: 100}) do |progress|
+        logger.info "import progress: #{progress.inspect}"
+      end
+      logger.info "imported: #{stats.inspect}"
+    end
+
+    record = client.get(AerospikeNative::Key.new(namespace, "#{set}_copy", 10))
+    logger.info "copied record: #{record.inspect}"
+  end
+end
+
+main
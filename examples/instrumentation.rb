@@ -0,0 +1,27 @@
+require_relative './common/common'
+
+def main
+  Common::Common.run_example do |client, namespace, set, logger|
+    events = Queue.new
+    AerospikeNative.event_sample_rate = 0.5
+    subscriber = AerospikeNative.subscribe { |event| events << event }
+
+    100.times do |i|
+      key = AerospikeNative::Key.new(namespace, set, i)
+      client.put(key, {'value' => i, 'payload' => 'x' * 100})
+      client.get(key)
+    end
+    client.scan(namespace, set).exec
+
+    AerospikeNative.flush_events
+    logger.info "Sampled events: #{events.size}"
+    event = events.pop
+    logger.info "#{event['command']} #{event['namespace']}.#{event['set']} result #{event['result']} " \
+      "in #{event['duration']} us (network #{event['network']} us), sent #{event['bytes_sent']} bytes, received #{event['bytes_received']} bytes"
+
+    AerospikeNative.unsubscribe(subscriber)
+    AerospikeNative.event_sample_rate = 1.0
+  end
+end
+
+main
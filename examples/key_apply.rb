@@ -0,0 +1,23 @@
+require_relative './common/common'
+
+def main
+  Common::Common.run_example do |client, namespace, set, logger|
+    client.udf.put("./examples/lua/test_udf.lua")
+    client.udf.wait("test_udf.lua", 1000)
+
+    key = AerospikeNative::Key.new(namespace, set, "key_apply_test")
+    client.put(key, {'number' => 1})
+
+    5.times do
+      value = client.apply(key, "test_udf", "increment_capped", ['number', 2, 6])
+      logger.info "capped counter: #{value}"
+    end
+
+    summary = client.apply(key, "test_udf", "bins_summary")
+    logger.info "summary: #{summary.inspect}"
+
+    client.remove(key)
+  end
+end
+
+main
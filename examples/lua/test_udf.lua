@@ -10,7 +10,49 @@ function sum_number(stream)
         return stream : map(get_number) : reduce(add)
 end
 
+function sum_number_greater(stream, min)
+        local function greater(rec)
+                return rec['number'] > min
+        end
+        return stream : filter(greater) : map(get_number) : reduce(add)
+end
+
+local function stats_aggregate(stats, number)
+        stats['count'] = (stats['count'] or 0) + 1
+        stats['sum'] = (stats['sum'] or 0) + number
+        return stats
+end
+
+local function stats_merge(a, b)
+        return map.merge(a, b, add)
+end
+
+function number_stats(stream)
+        return stream : map(get_number) : aggregate(map(), stats_aggregate) : reduce(stats_merge)
+end
+
 function add_testbin_to_number(rec)
         rec['number'] = rec['number'] + rec['testbin'];
         aerospike:update(rec)
 end
+
+function increment_capped(rec, bin, delta, cap)
+        local value = (rec[bin] or 0) + delta
+        if value > cap then
+                return rec[bin]
+        end
+        rec[bin] = value
+        if aerospike:exists(rec) then
+                aerospike:update(rec)
+        else
+                aerospike:create(rec)
+        end
+        return value
+end
+
+function bins_summary(rec)
+        local summary = map()
+        summary['number'] = rec['number']
+        summary['ttl'] = record.ttl(rec)
+        return summary
+end
@@ -25,6 +25,12 @@ def main
 
     record = client.operate(key, bins)
     logger.info "With read: #{record.inspect}"
+
+    views = client.increment(key, {'incr' => 1})
+    logger.info "Incremented value: #{views}"
+
+    counters = client.increment(key, {'incr' => 2**40, 'score' => 0.5})
+    logger.info "Incremented values: #{counters.inspect}"
   end
 end
 
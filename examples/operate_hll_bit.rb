@@ -0,0 +1,41 @@
+require_relative './common/common'
+
+def main
+  Common::Common.run_example do |client, namespace, set, logger|
+    today = AerospikeNative::Key.new(namespace, set, "visitors_today")
+    yesterday = AerospikeNative::Key.new(namespace, set, "visitors_yesterday")
+
+    client.operate(today, [AerospikeNative::Operation.hll_add('visitors', (1..1000).map { |i| "user#{i}" })])
+    client.operate(yesterday, [AerospikeNative::Operation.hll_add('visitors', (500..2000).map { |i| "user#{i}" })])
+
+    record = client.operate(today, [AerospikeNative::Operation.hll_get_count('visitors')])
+    logger.info "Unique visitors today: #{record.bins['visitors']}"
+
+    hll = client.get(yesterday).bins['visitors']
+    record = client.operate(today, [AerospikeNative::Operation.hll_union_count('visitors', [hll])])
+    logger.info "Unique visitors for two days: #{record.bins['visitors']}"
+    record = client.operate(today, [AerospikeNative::Operation.hll_intersect_count('visitors', [hll])])
+    logger.info "Returned visitors: #{record.bins['visitors']}"
+
+    flags = AerospikeNative::Key.new(namespace, set, "feature_flags")
+    ops = []
+    ops << AerospikeNative::Operation.bit_resize('flags', 4)
+    ops << AerospikeNative::Operation.bit_set('flags', 0, 8, "\xA0".b)
+    ops << AerospikeNative::Operation.bit_or('flags', 8, 8, "\x01".b)
+    client.operate(flags, ops)
+
+    ops = []
+    ops << AerospikeNative::Operation.bit_get('flags', 0, 16)
+    record = client.operate(flags, ops)
+    logger.info "Flags: #{record.bins['flags'].unpack('B*').first}"
+
+    record = client.operate(flags, [AerospikeNative::Operation.bit_count('flags', 0, 32)])
+    logger.info "Enabled flags: #{record.bins['flags']}"
+    record = client.operate(flags, [AerospikeNative::Operation.bit_lscan('flags', 0, 32, true)])
+    logger.info "First enabled flag: #{record.bins['flags']}"
+
+    [today, yesterday, flags].each { |key| client.remove(key) }
+  end
+end
+
+main
@@ -0,0 +1,40 @@
+require_relative './common/common'
+
+def main
+  Common::Common.run_example do |client, namespace, set, logger|
+    key = AerospikeNative::Key.new(namespace, set, "operate_list_test")
+    # list operations need native list bin, put stores arrays as msgpack bytes by default
+    client.operate(key, [1, 2, 3].map { |item| AerospikeNative::Operation.list_append('timeline', item) })
+
+    ops = []
+    ops << AerospikeNative::Operation.list_append('timeline', 4)
+    ops << AerospikeNative::Operation.list_insert('timeline', 0, 0)
+    record = client.operate(key, ops)
+    logger.info "List size after append and insert: #{record.bins['timeline']}"
+
+    ops = []
+    ops << AerospikeNative::Operation.list_trim('timeline', -3, 3)
+    ops << AerospikeNative::Operation.list_get_range('timeline', 0)
+    record = client.operate(key, ops)
+    logger.info "Last 3 items: #{record.bins['timeline'].inspect}"
+
+    record = client.operate(key, [AerospikeNative::Operation.list_pop('timeline', 0)])
+    logger.info "Popped item: #{record.bins['timeline'].inspect}"
+
+    record = client.operate(key, [AerospikeNative::Operation.list_size('timeline')])
+    logger.info "List size: #{record.bins['timeline']}"
+
+    if defined?(AerospikeNative::LIST_SORT_DEFAULT)
+      ops = []
+      ops << AerospikeNative::Operation.list_append_unique('timeline', 1)
+      ops << AerospikeNative::Operation.list_sort('timeline', AerospikeNative::LIST_SORT_DROP_DUPLICATES)
+      ops << AerospikeNative::Operation.read('timeline')
+      record = client.operate(key, ops)
+      logger.info "Sorted list: #{record.bins['timeline'].inspect}"
+    end
+
+    client.remove(key)
+  end
+end
+
+main
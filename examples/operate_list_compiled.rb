@@ -0,0 +1,25 @@
+require_relative './common/common'
+
+def main
+  Common::Common.run_example do |client, namespace, set, logger|
+    counters = AerospikeNative::OperationList.new([
+      AerospikeNative::Operation.increment('views', 1),
+      AerospikeNative::Operation.increment('clicks', 0),
+      AerospikeNative::Operation.write('last_page', ''),
+      AerospikeNative::Operation.read('views')
+    ])
+    logger.info "Compiled #{counters.size} operations with #{counters.slots} slots"
+
+    key = AerospikeNative::Key.new(namespace, set, "operate_compiled_test")
+    100.times do |i|
+      client.operate(key, counters, [1, i % 10 == 0 ? 1 : 0, "page#{i}"])
+    end
+
+    record = client.operate(key, counters, nil)
+    logger.info "Counters after compiled values call: #{record.bins.inspect}"
+
+    client.remove(key)
+  end
+end
+
+main
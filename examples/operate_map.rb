@@ -0,0 +1,32 @@
+require_relative './common/common'
+
+def main
+  Common::Common.run_example do |client, namespace, set, logger|
+    key = AerospikeNative::Key.new(namespace, set, "operate_map_test")
+
+    ops = []
+    ops << AerospikeNative::Operation.map_put_items('scores', {'alice' => 10, 'bob' => 25, 'carol' => 7})
+    ops << AerospikeNative::Operation.map_put('scores', 'dave', 18)
+    record = client.operate(key, ops)
+    logger.info "Map size: #{record.bins['scores']}"
+
+    record = client.operate(key, [AerospikeNative::Operation.map_increment('scores', 'carol', 30)])
+    logger.info "Carol score: #{record.bins['scores']}"
+
+    record = client.operate(key, [AerospikeNative::Operation.map_get_by_rank_range('scores', -2, 2)])
+    logger.info "Top 2: #{record.bins['scores'].inspect}"
+
+    record = client.operate(key, [AerospikeNative::Operation.map_get_by_key_range('scores', 'a', 'c', AerospikeNative::MAP_RETURN_KEY)])
+    logger.info "Keys from a to c: #{record.bins['scores'].inspect}"
+
+    ops = []
+    ops << AerospikeNative::Operation.map_remove_by_rank('scores', 0, AerospikeNative::MAP_RETURN_KEY)
+    ops << AerospikeNative::Operation.map_remove_by_key('scores', 'bob')
+    record = client.operate(key, ops)
+    logger.info "Operations result: #{record.bins.inspect}"
+
+    client.remove(key)
+  end
+end
+
+main
@@ -0,0 +1,34 @@
+require_relative './common/common'
+
+def main
+  Common::Common.run_example do |client, namespace, set, logger|
+    index_name = "number_#{set}_idx"
+    client.create_index(namespace, set, 'number', index_name)
+
+    20.times do |i|
+      client.put(AerospikeNative::Key.new(namespace, set, i), {'number' => i, 'key' => 'number', 'testbin' => i})
+    end
+
+    client.udf.put("./examples/lua/test_udf.lua")
+    client.udf.wait("test_udf.lua", 1000)
+
+    logger.info "performing background query..."
+    job = client.query(namespace, set).where(number: [5, 10]).execute_background("test_udf", "add_testbin_to_number")
+    logger.info "job info: #{job.info}"
+    job.wait(10_000)
+    logger.info "job done: #{job.done?}, info: #{job.info}"
+
+    records = client.query(namespace, set).where(number: [10, 20]).exec
+    logger.info records.map(&:bins).inspect
+
+    logger.info "performing background scan..."
+    job = client.scan(namespace, set).execute_background("test_udf", "add_testbin_to_number")
+    job.wait
+    logger.info "scan job info: #{job.info}"
+
+    client.udf.remove("test_udf.lua")
+    client.drop_index(namespace, index_name)
+  end
+end
+
+main
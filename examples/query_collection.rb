@@ -0,0 +1,27 @@
+require_relative './common/common'
+
+def main
+  Common::Common.run_example do |client, namespace, set, logger|
+    # collection indexes cover only native lists and maps
+    native_client = AerospikeNative::Client.new([{host: '127.0.0.1', port: 3010}], {'native_collections' => true})
+
+    native_client.create_index(namespace, set, 'tags', 'tags_list_idx', {'type' => AerospikeNative::INDEX_STRING, 'collection' => AerospikeNative::INDEX_TYPE_LIST})
+    native_client.create_index(namespace, set, 'scores', 'scores_values_idx', {'type' => AerospikeNative::INDEX_NUMERIC, 'collection' => AerospikeNative::INDEX_TYPE_MAPVALUES})
+
+    10.times do |i|
+      tags = i.even? ? ['even', "tag#{i}"] : ['odd', "tag#{i}"]
+      native_client.put(AerospikeNative::Key.new(namespace, set, i), {'number' => i, 'tags' => tags, 'scores' => {'math' => i * 10, 'art' => 100 - i}})
+    end
+
+    records = native_client.query(namespace, set).where('tags' => [:list, 'even']).exec
+    logger.info "records tagged even: #{records.map { |record| record.bins['number'] }.inspect}"
+
+    records = native_client.query(namespace, set).where('scores' => [:mapvalues, 40, 60]).exec
+    logger.info "records with score in 40..60: #{records.map { |record| record.bins['number'] }.inspect}"
+
+    native_client.drop_index(namespace, 'tags_list_idx')
+    native_client.drop_index(namespace, 'scores_values_idx')
+  end
+end
+
+main
@@ -0,0 +1,23 @@
+require_relative './common/common'
+
+def main
+  Common::Common.run_example do |client, namespace, set, logger|
+    client.create_index(namespace, set, 'location', 'location_geo_idx', {'type' => AerospikeNative::INDEX_GEO2DSPHERE})
+
+    10.times do |i|
+      location = AerospikeNative::GeoJSON.point(-122.0 + i * 0.01, 37.5 + i * 0.01)
+      client.put(AerospikeNative::Key.new(namespace, set, i), {'name' => "place#{i}", 'location' => location})
+    end
+
+    records = client.query(namespace, set).within_radius('location', -122.0, 37.5, 3000).exec
+    logger.info "places within 3km: #{records.map { |record| record.bins['name'] }.inspect}"
+
+    region = AerospikeNative::GeoJSON.polygon([[-122.1, 37.4], [-121.9, 37.4], [-121.9, 37.55], [-122.1, 37.55]])
+    records = client.query(namespace, set).within_region('location', region).exec
+    logger.info "places within region: #{records.map { |record| record.bins['name'] }.inspect}"
+
+    client.drop_index(namespace, 'location_geo_idx')
+  end
+end
+
+main
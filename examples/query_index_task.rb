@@ -0,0 +1,23 @@
+require_relative './common/common'
+
+def main
+  Common::Common.run_example do |client, namespace, set, logger|
+    1000.times do |i|
+      client.put(AerospikeNative::Key.new(namespace, set, i), {'number' => i})
+    end
+
+    task = client.create_index(namespace, set, 'number', 'number_idx', {'type' => AerospikeNative::INDEX_NUMERIC, 'wait' => false})
+    until task.done?
+      logger.info "index build progress: #{task.progress}%"
+      task.wait(100)
+    end
+    logger.info "index #{task.index_name} is ready"
+
+    records = client.query(namespace, set).where('number' => [10, 20]).exec
+    logger.info "records: #{records.map { |record| record.bins['number'] }.inspect}"
+
+    client.drop_index(namespace, 'number_idx')
+  end
+end
+
+main
@@ -21,6 +21,15 @@ def main
     logger.info "ruby sum #{ruby_sum}"
     logger.info "aerospike sum #{sum}"
 
+    logger.info "perform a aggregate query with arguments"
+    sum = client.query(namespace, set).aggregate("test_udf", "sum_number_greater", [10]).first
+    logger.info "ruby sum of numbers greater than 10 #{(11...20).reduce(:+)}"
+    logger.info "aerospike sum of numbers greater than 10 #{sum}"
+
+    logger.info "perform a aggregate query with complex result"
+    stats = client.query(namespace, set).aggregate("test_udf", "number_stats").first
+    logger.info "aerospike stats #{stats.inspect}"
+
     logger.info "removing user script..."
     client.udf.remove("test_udf.lua")
     logger.info "Found user scripts: #{client.udf.list}"
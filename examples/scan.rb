@@ -11,6 +11,17 @@ def main
 
     records = client.scan(namespace, set).select(:number, :testbin).exec
     logger.info "scan records with specified bins: #{records.inspect}"
+
+    records = client.scan(namespace, set).limit(5).exec
+    logger.info "scan first 5 records: #{records.inspect}"
+
+    record = client.scan(namespace, set).first
+    logger.info "scan first record: #{record.inspect}"
+
+    client.scan(namespace, set).exec do |record|
+      logger.info "scan until number bin is greater than 10: #{record.inspect}"
+      break if record.bins['number'] > 10
+    end
   end
 end
 
@@ -0,0 +1,25 @@
+require_relative './common/common'
+
+def main
+  Common::Common.run_example do |client, namespace, set, logger|
+    100.times do |i|
+      client.put(AerospikeNative::Key.new(namespace, set, i), {'number' => i, 'latency' => rand(500), 'user' => "user#{i % 30}"})
+    end
+
+    result = client.scan(namespace, set).aggregate(
+      count: true,
+      sum: 'number',
+      min: ['number', 'latency'],
+      max: ['number', 'latency'],
+      histogram: ['latency', [50, 100, 250]],
+      distinct: 'user'
+    )
+    logger.info "aggregated: #{result.inspect}"
+
+    exp = AerospikeNative::Exp
+    result = client.scan(namespace, set).filter(exp.ge(exp.bin(:latency), 250)).aggregate(count: true, sum: 'latency')
+    logger.info "aggregated slow requests: #{result.inspect}"
+  end
+end
+
+main
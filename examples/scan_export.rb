@@ -0,0 +1,28 @@
+require_relative './common/common'
+require 'json'
+require 'tmpdir'
+
+def main
+  Common::Common.run_example do |client, namespace, set, logger|
+    100.times do |i|
+      client.put(AerospikeNative::Key.new(namespace, set, i), {'number' => i, 'info' => {'user' => "user#{i}", 'tags' => ['a', 'b']}})
+    end
+
+    Dir.mktmpdir do |dir|
+      path = File.join(dir, 'records.ndjson')
+      records = client.scan(namespace, set).export(path, format: :ndjson)
+      logger.info "exported #{records} records into #{path}"
+      logger.info "first line: #{JSON.parse(File.open(path, &:readline)).inspect}"
+
+      path = File.join(dir, 'records.msgpack')
+      scan = client.scan(namespace, set)
+      records = scan.filter(AerospikeNative::Exp.ge(AerospikeNative::Exp.bin(:number), 50)).export(path)
+      logger.info "exported #{records} records (#{File.size(path)} bytes) into #{path}, progress: #{scan.progress.inspect}"
+
+      records = client.scan(namespace, set).export(path + '.gz', compress: true)
+      logger.info "exported #{records} records (#{File.size(path + '.gz')} bytes) into #{path}.gz"
+    end
+  end
+end
+
+main
@@ -0,0 +1,20 @@
+require_relative './common/common'
+
+def main
+  Common::Common.run_example do |client, namespace, set, logger|
+    20.times do |i|
+      client.put(AerospikeNative::Key.new(namespace, set, i), {'number' => i, 'key' => 'number', 'testbin' => i.to_s})
+    end
+
+    exp = AerospikeNative::Exp
+    filter = exp.gt(exp.bin(:number), 5) & exp.lt(exp.bin(:number), 10) | exp.eq(exp.bin(:testbin), '15')
+
+    records = client.scan(namespace, set).filter(filter).exec
+    logger.info "scan records matched by filter: #{records.map(&:bins).inspect}"
+
+    records = client.query(namespace, set).filter(filter.not).exec
+    logger.info "query records not matched by filter: #{records.map(&:bins).inspect}"
+  end
+end
+
+main
@@ -0,0 +1,33 @@
+require_relative './common/common'
+
+def main
+  Common::Common.run_example do |client, namespace, set, logger|
+    100.times do |i|
+      client.put(AerospikeNative::Key.new(namespace, set, i), {'number' => i, 'key' => 'number', 'testbin' => i.to_s})
+    end
+
+    workers = 4
+    logger.info "partition slicing: #{AerospikeNative::Scan.partition_slicing}"
+    readers = AerospikeNative::Scan.partition_slices(workers).map do |partition_begin, partition_count|
+      reader, writer = IO.pipe
+      fork do
+        reader.close
+        worker_client = AerospikeNative::Client.new([{host: '127.0.0.1', port: 3010}])
+        scan = worker_client.scan(namespace, set).set_partitions(partition_begin, partition_count)
+        scan.exec { |record| record.bins['number'] }
+        Marshal.dump(scan.progress, writer)
+        writer.close
+        exit!(0)
+      end
+      writer.close
+      reader
+    end
+
+    progress = readers.map { |reader| Marshal.load(reader) }
+    Process.waitall
+    logger.info "workers progress: #{progress.inspect}"
+    logger.info "merged progress: #{AerospikeNative::Scan.merge_progress(progress).inspect}"
+  end
+end
+
+main
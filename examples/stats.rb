@@ -0,0 +1,28 @@
+require_relative './common/common'
+
+def main
+  Common::Common.run_example do |client, namespace, set, logger|
+    client.reset_stats
+
+    100.times do |i|
+      key = AerospikeNative::Key.new(namespace, set, i)
+      client.put(key, {'value' => i, 'payload' => 'x' * 100})
+      client.get(key)
+    end
+    keys = 10.times.map { |i| AerospikeNative::Key.new(namespace, set, i) }
+    client.batch.get(keys)
+    client.scan(namespace, set).exec
+
+    stats = client.stats
+    %w(get put batch scan).each do |command|
+      network = stats[command]['network']
+      conversion = stats[command]['conversion']
+      total = stats[command]['total']
+      logger.info "#{command}: #{stats[command]['count']} commands, total p50 #{total['p50']} us, p99 #{total['p99']} us, network p50 #{network['p50']} us, p99 #{network['p99']} us, conversion p50 #{conversion['p50']} us"
+    end
+
+    logger.info "Prometheus metrics:\n#{client.stats(:prometheus)}"
+  end
+end
+
+main
@@ -0,0 +1,20 @@
+require_relative './common/common'
+
+def main
+  Common::Common.run_example do |client, namespace, set, logger|
+    uploaded = client.udf.put_all("./examples/lua")
+    logger.info "Uploaded modules: #{uploaded.inspect}"
+
+    uploaded = client.udf.put_all("./examples/lua")
+    logger.info "Uploaded modules on second deploy: #{uploaded.inspect}"
+
+    body = "function hello(rec)\n  return 'hello'\nend\n"
+    logger.info "Body module uploaded: #{client.udf.put('hello_udf.lua', body)}"
+    logger.info "Body module uploaded again: #{client.udf.put('hello_udf.lua', body)}"
+    client.udf.wait('hello_udf.lua', 100)
+
+    client.udf.remove('hello_udf.lua')
+  end
+end
+
+main
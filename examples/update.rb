@@ -0,0 +1,26 @@
+require_relative './common/common'
+
+def main
+  Common::Common.run_example do |client, namespace, set, logger|
+    key = AerospikeNative::Key.new(namespace, set, "update_test")
+
+    threads = 4.times.map do
+      Thread.new do
+        25.times do
+          client.update(key, {'max_attempts' => 20, 'backoff' => 2}) do |record|
+            balance = record ? record.bins['balance'] : 0
+            {'balance' => balance + 1}
+          end
+        end
+      end
+    end
+    threads.each(&:join)
+
+    logger.info "Balance: #{client.get(key).bins['balance']}"
+    logger.info "Update stats: #{client.update_stats.inspect}"
+
+    client.remove(key)
+  end
+end
+
+main
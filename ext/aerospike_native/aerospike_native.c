@@ -2,12 +2,18 @@
 #include "client.h"
 #include "key.h"
 #include "operation.h"
+#include "operation_list.h"
 #include "record.h"
 #include "policy.h"
 #include "query.h"
 #include "batch.h"
 #include "scan.h"
 #include "udf.h"
+#include "expression.h"
+#include "job.h"
+#include "index_task.h"
+#include "geo.h"
+#include "events.h"
 
 VALUE AerospikeNativeClass;
 VALUE MsgPackClass;
@@ -19,15 +25,43 @@ void Init_aerospike_native()
     define_exception();
     define_logger();
     define_udf();
+    define_expression();
     define_query();
     define_scan();
+    define_job();
+    define_index_task();
     define_batch();
     define_native_key();
+    define_geo();
     define_record();
     define_operation();
+    define_operation_list();
     define_policy();
     define_client();
+    define_events();
 
     rb_define_const(AerospikeNativeClass, "INDEX_NUMERIC", INT2FIX(INDEX_NUMERIC));
     rb_define_const(AerospikeNativeClass, "INDEX_STRING", INT2FIX(INDEX_STRING));
+#ifdef HAVE_AEROSPIKE_AS_GEOJSON_H
+    rb_define_const(AerospikeNativeClass, "INDEX_GEO2DSPHERE", INT2FIX(INDEX_GEO2DSPHERE));
+#endif
+#ifdef HAVE_AEROSPIKE_INDEX_CREATE_COMPLEX
+    rb_define_const(AerospikeNativeClass, "INDEX_TYPE_DEFAULT", INT2FIX(INDEX_TYPE_DEFAULT));
+    rb_define_const(AerospikeNativeClass, "INDEX_TYPE_LIST", INT2FIX(INDEX_TYPE_LIST));
+    rb_define_const(AerospikeNativeClass, "INDEX_TYPE_MAPKEYS", INT2FIX(INDEX_TYPE_MAPKEYS));
+    rb_define_const(AerospikeNativeClass, "INDEX_TYPE_MAPVALUES", INT2FIX(INDEX_TYPE_MAPVALUES));
+#endif
+#ifdef HAVE_AEROSPIKE_AS_CDT_CTX_H
+    rb_define_const(AerospikeNativeClass, "LIST_SORT_DEFAULT", INT2FIX(LIST_SORT_DEFAULT));
+    rb_define_const(AerospikeNativeClass, "LIST_SORT_DROP_DUPLICATES", INT2FIX(LIST_SORT_DROP_DUPLICATES));
+    rb_define_const(AerospikeNativeClass, "MAP_RETURN_NONE", INT2FIX(MAP_RETURN_NONE));
+    rb_define_const(AerospikeNativeClass, "MAP_RETURN_INDEX", INT2FIX(MAP_RETURN_INDEX));
+    rb_define_const(AerospikeNativeClass, "MAP_RETURN_REVERSE_INDEX", INT2FIX(MAP_RETURN_REVERSE_INDEX));
+    rb_define_const(AerospikeNativeClass, "MAP_RETURN_RANK", INT2FIX(MAP_RETURN_RANK));
+    rb_define_const(AerospikeNativeClass, "MAP_RETURN_REVERSE_RANK", INT2FIX(MAP_RETURN_REVERSE_RANK));
+    rb_define_const(AerospikeNativeClass, "MAP_RETURN_COUNT", INT2FIX(MAP_RETURN_COUNT));
+    rb_define_const(AerospikeNativeClass, "MAP_RETURN_KEY", INT2FIX(MAP_RETURN_KEY));
+    rb_define_const(AerospikeNativeClass, "MAP_RETURN_VALUE", INT2FIX(MAP_RETURN_VALUE));
+    rb_define_const(AerospikeNativeClass, "MAP_RETURN_KEY_VALUE", INT2FIX(MAP_RETURN_KEY_VALUE));
+#endif
 }
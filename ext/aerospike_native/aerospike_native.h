@@ -10,8 +10,20 @@ RUBY_EXTERN VALUE MsgPackClass;
 
 enum IndexType {
     INDEX_STRING = AS_INDEX_STRING,
-    INDEX_NUMERIC = AS_INDEX_NUMERIC
+    INDEX_NUMERIC = AS_INDEX_NUMERIC,
+#ifdef HAVE_AEROSPIKE_AS_GEOJSON_H
+    INDEX_GEO2DSPHERE = AS_INDEX_GEO2DSPHERE,
+#endif
 };
 
+#ifdef HAVE_AEROSPIKE_INDEX_CREATE_COMPLEX
+enum IndexCollectionType {
+    INDEX_TYPE_DEFAULT = AS_INDEX_TYPE_DEFAULT,
+    INDEX_TYPE_LIST = AS_INDEX_TYPE_LIST,
+    INDEX_TYPE_MAPKEYS = AS_INDEX_TYPE_MAPKEYS,
+    INDEX_TYPE_MAPVALUES = AS_INDEX_TYPE_MAPVALUES
+};
+#endif
+
 #endif // AEROSPIKE_NATIVE_H
 
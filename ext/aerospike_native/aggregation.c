@@ -0,0 +1,524 @@
+#include "aggregation.h"
+#include <math.h>
+
+static uint64_t aggregation_generation = 0;
+static __thread uint64_t aggregation_tls_generation = 0;
+static __thread aggregation_slot* aggregation_tls_slot = NULL;
+
+static const char* aggregation_names[] = {"count", "sum", "min", "max", "histogram", "distinct"};
+
+static void aggregation_push_kernel(VALUE vKernels, int type, VALUE vBinName, VALUE vBounds)
+{
+    VALUE vKernel;
+
+    if (TYPE(vBinName) != T_NIL) {
+        GET_STRING(vBinName);
+        vBinName = rb_str_new_frozen(vBinName);
+    }
+
+    if (TYPE(vBounds) != T_NIL) {
+        VALUE vBuffer;
+        double* bounds;
+        long n, idx;
+
+        Check_Type(vBounds, T_ARRAY);
+        idx = RARRAY_LEN(vBounds);
+        if (idx == 0) {
+            rb_raise(rb_eArgError, "histogram expects non empty buckets bounds");
+        }
+
+        vBuffer = rb_str_new(NULL, sizeof(double) * idx);
+        bounds = (double*) RSTRING_PTR(vBuffer);
+        for(n = 0; n < idx; n++) {
+            bounds[n] = NUM2DBL(rb_ary_entry(vBounds, n));
+            if (n > 0 && bounds[n] <= bounds[n - 1]) {
+                rb_raise(rb_eArgError, "histogram buckets bounds should be sorted ascending");
+            }
+        }
+        vBounds = vBuffer;
+    }
+
+    vKernel = rb_ary_new3(3, INT2FIX(type), vBinName, vBounds);
+    rb_ary_push(vKernels, vKernel);
+}
+
+static int aggregation_options_foreach(VALUE vKey, VALUE vValue, VALUE vKernels)
+{
+    int type;
+    long n;
+
+    GET_STRING(vKey);
+    for(type = AGGREGATION_COUNT; type <= AGGREGATION_DISTINCT; type++) {
+        if (strcmp(StringValueCStr(vKey), aggregation_names[type]) == 0) {
+            break;
+        }
+    }
+
+    switch(type) {
+    case AGGREGATION_COUNT:
+        if (vValue == Qtrue) {
+            aggregation_push_kernel(vKernels, type, Qnil, Qnil);
+            break;
+        }
+    case AGGREGATION_SUM:
+    case AGGREGATION_MIN:
+    case AGGREGATION_MAX:
+    case AGGREGATION_DISTINCT:
+        if (TYPE(vValue) == T_ARRAY) {
+            for(n = 0; n < RARRAY_LEN(vValue); n++) {
+                aggregation_push_kernel(vKernels, type, rb_ary_entry(vValue, n), Qnil);
+            }
+        } else {
+            aggregation_push_kernel(vKernels, type, vValue, Qnil);
+        }
+        break;
+    case AGGREGATION_HISTOGRAM:
+        Check_Type(vValue, T_ARRAY);
+        if (RARRAY_LEN(vValue) != 2) {
+            rb_raise(rb_eArgError, "wrong histogram options (expected [bin_name, buckets_bounds])");
+        }
+        aggregation_push_kernel(vKernels, type, rb_ary_entry(vValue, 0), rb_ary_entry(vValue, 1));
+        break;
+    default:
+        rb_raise(rb_eArgError, "Incorrect aggregation \"%s\"", StringValueCStr(vKey));
+    }
+
+    return ST_CONTINUE;
+}
+
+/*
+ * parse aggregation options, kernels reference ruby strings kept in state->vKernels
+ */
+void aggregation_init(aggregation_state* state, VALUE vOptions, query_data* data)
+{
+    VALUE vKernels, vBuffer;
+    int n;
+
+    Check_Type(vOptions, T_HASH);
+    vKernels = rb_ary_new();
+    rb_hash_foreach(vOptions, aggregation_options_foreach, vKernels);
+    if (RARRAY_LEN(vKernels) == 0) {
+        rb_raise(rb_eArgError, "no aggregations specified");
+    }
+
+    state->kernels_size = RARRAY_LEN(vKernels);
+    vBuffer = rb_str_new(NULL, sizeof(aggregation_kernel) * state->kernels_size);
+    rb_ary_push(vKernels, vBuffer);
+    state->vKernels = vKernels;
+    state->kernels = (aggregation_kernel*) RSTRING_PTR(vBuffer);
+
+    for(n = 0; n < state->kernels_size; n++) {
+        VALUE vKernel = rb_ary_entry(vKernels, n);
+        VALUE vBinName = rb_ary_entry(vKernel, 1);
+        VALUE vBounds = rb_ary_entry(vKernel, 2);
+        aggregation_kernel* kernel = &state->kernels[n];
+
+        kernel->type = FIX2INT(rb_ary_entry(vKernel, 0));
+        kernel->bin_name = TYPE(vBinName) == T_NIL ? NULL : StringValueCStr(vBinName);
+        kernel->bounds_size = 0;
+        kernel->bounds = NULL;
+        if (TYPE(vBounds) != T_NIL) {
+            kernel->bounds_size = RSTRING_LEN(vBounds) / sizeof(double);
+            kernel->bounds = (const double*) RSTRING_PTR(vBounds);
+        }
+    }
+
+    state->data = data;
+    state->generation = __sync_add_and_fetch(&aggregation_generation, 1);
+    state->slots_size = 0;
+    state->cancelled = false;
+    state->out_of_memory = false;
+    memset(state->slots, 0, sizeof(state->slots));
+    pthread_mutex_init(&state->lock, NULL);
+}
+
+static void aggregation_accs_destroy(aggregation_state* state, aggregation_acc* accs)
+{
+    int n;
+
+    if (accs == NULL) {
+        return;
+    }
+
+    for(n = 0; n < state->kernels_size; n++) {
+        free(accs[n].buckets);
+        free(accs[n].registers);
+    }
+    free(accs);
+}
+
+static aggregation_acc* aggregation_accs_new(aggregation_state* state)
+{
+    aggregation_acc* accs = calloc(state->kernels_size, sizeof(aggregation_acc));
+    int n;
+
+    if (accs == NULL) {
+        return NULL;
+    }
+
+    for(n = 0; n < state->kernels_size; n++) {
+        aggregation_kernel* kernel = &state->kernels[n];
+        accs[n].int_min = INT64_MAX;
+        accs[n].int_max = INT64_MIN;
+        accs[n].double_min = INFINITY;
+        accs[n].double_max = -INFINITY;
+        if (kernel->type == AGGREGATION_HISTOGRAM) {
+            accs[n].buckets = calloc(kernel->bounds_size + 1, sizeof(uint64_t));
+            if (accs[n].buckets == NULL) {
+                aggregation_accs_destroy(state, accs);
+                return NULL;
+            }
+        }
+        if (kernel->type == AGGREGATION_DISTINCT) {
+            accs[n].registers = calloc(AGGREGATION_HLL_REGISTERS, sizeof(uint8_t));
+            if (accs[n].registers == NULL) {
+                aggregation_accs_destroy(state, accs);
+                return NULL;
+            }
+        }
+    }
+
+    return accs;
+}
+
+/*
+ * every scan thread gets own accumulators, so callbacks don't contend,
+ * threads above AGGREGATION_MAX_SLOTS share the last slot under state->lock
+ */
+static aggregation_slot* aggregation_slot_get(aggregation_state* state, bool* shared)
+{
+    aggregation_slot* slot;
+
+    *shared = false;
+    if (aggregation_tls_generation == state->generation) {
+        return aggregation_tls_slot;
+    }
+
+    pthread_mutex_lock(&state->lock);
+    if (state->slots_size < AGGREGATION_MAX_SLOTS) {
+        slot = &state->slots[state->slots_size++];
+        slot->accs = aggregation_accs_new(state);
+        aggregation_tls_slot = slot;
+        aggregation_tls_generation = state->generation;
+        pthread_mutex_unlock(&state->lock);
+        return slot;
+    }
+
+    // keep lock for the shared slot update
+    slot = &state->slots[AGGREGATION_MAX_SLOTS];
+    if (slot->accs == NULL) {
+        slot->accs = aggregation_accs_new(state);
+    }
+    *shared = true;
+    return slot;
+}
+
+static inline uint64_t aggregation_mix(uint64_t hash)
+{
+    hash ^= hash >> 30;
+    hash *= 0xbf58476d1ce4e5b9ULL;
+    hash ^= hash >> 27;
+    hash *= 0x94d049bb133111ebULL;
+    hash ^= hash >> 31;
+    return hash;
+}
+
+static inline uint64_t aggregation_hash_string(const char* value)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+
+    while (*value) {
+        hash ^= (uint8_t) *value++;
+        hash *= 0x100000001b3ULL;
+    }
+    return aggregation_mix(hash);
+}
+
+static inline void aggregation_hll_add(uint8_t* registers, uint64_t hash)
+{
+    uint32_t idx = hash >> (64 - AGGREGATION_HLL_BITS);
+    uint64_t rest = (hash << AGGREGATION_HLL_BITS) | (1ULL << (AGGREGATION_HLL_BITS - 1));
+    uint8_t rank = __builtin_clzll(rest) + 1;
+
+    if (registers[idx] < rank) {
+        registers[idx] = rank;
+    }
+}
+
+static inline int aggregation_histogram_bucket(const double* bounds, int bounds_size, double value)
+{
+    int n, bucket = 0;
+
+    // branchless count of passed bounds, vectorized by compiler
+    for(n = 0; n < bounds_size; n++) {
+        bucket += (value >= bounds[n]);
+    }
+    return bucket;
+}
+
+static void aggregation_kernel_update(const aggregation_kernel* kernel, aggregation_acc* acc, const as_record* record)
+{
+    as_bin_value* bin_value;
+    int64_t int_value = 0;
+    double double_value = 0;
+    bool is_integer;
+
+    if (kernel->bin_name == NULL) {
+        acc->count++;
+        return;
+    }
+
+    bin_value = as_record_get(record, kernel->bin_name);
+    if (bin_value == NULL) {
+        return;
+    }
+
+    switch(as_val_type(bin_value)) {
+    case AS_INTEGER:
+        is_integer = true;
+        int_value = as_integer_get(&bin_value->integer);
+        double_value = (double) int_value;
+        break;
+    case AS_DOUBLE:
+        is_integer = false;
+        double_value = as_double_get(&bin_value->dbl);
+        break;
+    case AS_STRING:
+        if (kernel->type == AGGREGATION_COUNT) {
+            acc->count++;
+        } else if (kernel->type == AGGREGATION_DISTINCT) {
+            acc->count++;
+            aggregation_hll_add(acc->registers, aggregation_hash_string(as_string_get(&bin_value->string)));
+        }
+        return;
+    default:
+        return;
+    }
+
+    acc->count++;
+    switch(kernel->type) {
+    case AGGREGATION_SUM:
+    case AGGREGATION_MIN:
+    case AGGREGATION_MAX:
+        if (is_integer) {
+            acc->int_count++;
+            acc->int_sum += int_value;
+            if (int_value < acc->int_min) acc->int_min = int_value;
+            if (int_value > acc->int_max) acc->int_max = int_value;
+        } else {
+            acc->double_count++;
+            acc->double_sum += double_value;
+            if (double_value < acc->double_min) acc->double_min = double_value;
+            if (double_value > acc->double_max) acc->double_max = double_value;
+        }
+        break;
+    case AGGREGATION_HISTOGRAM:
+        acc->buckets[aggregation_histogram_bucket(kernel->bounds, kernel->bounds_size, double_value)]++;
+        break;
+    case AGGREGATION_DISTINCT: {
+        uint64_t bits;
+        if (is_integer) {
+            bits = (uint64_t) int_value;
+        } else {
+            memcpy(&bits, &double_value, sizeof(bits));
+        }
+        aggregation_hll_add(acc->registers, aggregation_mix(bits));
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+/*
+ * scan callback, runs without GVL and doesn't create ruby objects
+ */
+bool aggregation_callback(const as_val* value, void* udata)
+{
+    aggregation_state* state = (aggregation_state*) udata;
+    aggregation_slot* slot;
+    as_record* record;
+    bool shared;
+    int n;
+
+    if (value == NULL) {
+        // scan is complete
+        return true;
+    }
+
+    if (state->cancelled || state->out_of_memory) {
+        return false;
+    }
+
+    if (as_val_type(value) != AS_REC || (record = as_record_fromval(value)) == NULL) {
+        return true;
+    }
+
+    query_throttle(state->data, __sync_add_and_fetch(&state->data->records_scanned, 1));
+    if (!query_record_match(state->data, record)) {
+        return true;
+    }
+    if (!query_record_accept(state->data)) {
+        return false;
+    }
+
+    slot = aggregation_slot_get(state, &shared);
+    if (slot->accs == NULL) {
+        // records of this thread can't be counted, so scan is aborted and error is raised after it
+        if (shared) {
+            pthread_mutex_unlock(&state->lock);
+        }
+        state->out_of_memory = true;
+        return false;
+    }
+    for(n = 0; n < state->kernels_size; n++) {
+        aggregation_kernel_update(&state->kernels[n], &slot->accs[n], record);
+    }
+    if (shared) {
+        pthread_mutex_unlock(&state->lock);
+    }
+
+    return query_record_continue(state->data);
+}
+
+static void aggregation_merge(const aggregation_kernel* kernel, aggregation_acc* dst, const aggregation_acc* src)
+{
+    int n;
+
+    dst->count += src->count;
+    dst->int_count += src->int_count;
+    dst->double_count += src->double_count;
+    dst->int_sum += src->int_sum;
+    dst->double_sum += src->double_sum;
+    if (src->int_min < dst->int_min) dst->int_min = src->int_min;
+    if (src->int_max > dst->int_max) dst->int_max = src->int_max;
+    if (src->double_min < dst->double_min) dst->double_min = src->double_min;
+    if (src->double_max > dst->double_max) dst->double_max = src->double_max;
+
+    if (kernel->type == AGGREGATION_HISTOGRAM) {
+        for(n = 0; n <= kernel->bounds_size; n++) {
+            dst->buckets[n] += src->buckets[n];
+        }
+    }
+
+    if (kernel->type == AGGREGATION_DISTINCT) {
+        for(n = 0; n < AGGREGATION_HLL_REGISTERS; n++) {
+            dst->registers[n] = dst->registers[n] > src->registers[n] ? dst->registers[n] : src->registers[n];
+        }
+    }
+}
+
+static double aggregation_hll_estimate(const uint8_t* registers)
+{
+    double m = AGGREGATION_HLL_REGISTERS, sum = 0, estimate;
+    int n, zeros = 0;
+
+    for(n = 0; n < AGGREGATION_HLL_REGISTERS; n++) {
+        sum += ldexp(1.0, -registers[n]);
+        zeros += (registers[n] == 0);
+    }
+
+    estimate = (0.7213 / (1 + 1.079 / m)) * m * m / sum;
+    if (estimate <= 2.5 * m && zeros > 0) {
+        // linear counting for small cardinalities
+        estimate = m * log(m / zeros);
+    }
+
+    return estimate;
+}
+
+static VALUE aggregation_kernel_result(const aggregation_kernel* kernel, const aggregation_acc* acc)
+{
+    long n;
+
+    switch(kernel->type) {
+    case AGGREGATION_COUNT:
+        return ULL2NUM(acc->count);
+    case AGGREGATION_SUM:
+        if (acc->double_count > 0) {
+            return rb_float_new(acc->double_sum + (double) acc->int_sum);
+        }
+        return LL2NUM(acc->int_sum);
+    case AGGREGATION_MIN:
+        if (acc->double_count > 0 && (acc->int_count == 0 || acc->double_min < (double) acc->int_min)) {
+            return rb_float_new(acc->double_min);
+        }
+        return acc->int_count > 0 ? LL2NUM(acc->int_min) : Qnil;
+    case AGGREGATION_MAX:
+        if (acc->double_count > 0 && (acc->int_count == 0 || acc->double_max > (double) acc->int_max)) {
+            return rb_float_new(acc->double_max);
+        }
+        return acc->int_count > 0 ? LL2NUM(acc->int_max) : Qnil;
+    case AGGREGATION_HISTOGRAM: {
+        VALUE vBuckets = rb_ary_new_capa(kernel->bounds_size + 1);
+        for(n = 0; n <= kernel->bounds_size; n++) {
+            rb_ary_push(vBuckets, ULL2NUM(acc->buckets[n]));
+        }
+        return vBuckets;
+    }
+    case AGGREGATION_DISTINCT:
+        return ULL2NUM((uint64_t) llround(aggregation_hll_estimate(acc->registers)));
+    }
+
+    return Qnil;
+}
+
+/*
+ * merge accumulators of all threads and build result hash:
+ * {"count" => n, "sum" => {bin_name => value}, "histogram" => {bin_name => [counts]}, ...}
+ */
+VALUE aggregation_result(aggregation_state* state)
+{
+    VALUE vResult;
+    aggregation_acc* total;
+    int n, k;
+
+    total = aggregation_accs_new(state);
+    if (total == NULL) {
+        aggregation_destroy(state);
+        rb_raise(rb_eNoMemError, "failed to allocate aggregation result");
+    }
+
+    for(n = 0; n <= AGGREGATION_MAX_SLOTS; n++) {
+        if (state->slots[n].accs == NULL) {
+            continue;
+        }
+        for(k = 0; k < state->kernels_size; k++) {
+            aggregation_merge(&state->kernels[k], &total[k], &state->slots[n].accs[k]);
+        }
+    }
+
+    vResult = rb_hash_new();
+    for(k = 0; k < state->kernels_size; k++) {
+        aggregation_kernel* kernel = &state->kernels[k];
+        VALUE vName = rb_str_new2(aggregation_names[kernel->type]);
+        VALUE vValue = aggregation_kernel_result(kernel, &total[k]);
+
+        if (kernel->bin_name == NULL) {
+            rb_hash_aset(vResult, vName, vValue);
+        } else {
+            VALUE vBins = rb_hash_aref(vResult, vName);
+            if (TYPE(vBins) != T_HASH) {
+                vBins = rb_hash_new();
+                rb_hash_aset(vResult, vName, vBins);
+            }
+            rb_hash_aset(vBins, rb_str_new2(kernel->bin_name), vValue);
+        }
+    }
+
+    aggregation_accs_destroy(state, total);
+    aggregation_destroy(state);
+
+    return vResult;
+}
+
+void aggregation_destroy(aggregation_state* state)
+{
+    int n;
+
+    for(n = 0; n <= AGGREGATION_MAX_SLOTS; n++) {
+        aggregation_accs_destroy(state, state->slots[n].accs);
+        state->slots[n].accs = NULL;
+    }
+    pthread_mutex_destroy(&state->lock);
+}
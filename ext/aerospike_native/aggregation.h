@@ -0,0 +1,64 @@
+#ifndef AGGREGATION_H
+#define AGGREGATION_H
+
+#include "aerospike_native.h"
+#include "query.h"
+#include <pthread.h>
+
+#define AGGREGATION_MAX_SLOTS 128
+#define AGGREGATION_HLL_BITS 12
+#define AGGREGATION_HLL_REGISTERS (1 << AGGREGATION_HLL_BITS)
+
+enum AggregationType {
+    AGGREGATION_COUNT,
+    AGGREGATION_SUM,
+    AGGREGATION_MIN,
+    AGGREGATION_MAX,
+    AGGREGATION_HISTOGRAM,
+    AGGREGATION_DISTINCT
+};
+
+typedef struct aggregation_kernel_s {
+    int type;
+    const char* bin_name;
+    int bounds_size;
+    const double* bounds;
+} aggregation_kernel;
+
+typedef struct aggregation_acc_s {
+    uint64_t count;
+    uint64_t int_count;
+    uint64_t double_count;
+    int64_t int_sum;
+    double double_sum;
+    int64_t int_min;
+    int64_t int_max;
+    double double_min;
+    double double_max;
+    uint64_t* buckets;
+    uint8_t* registers;
+} aggregation_acc;
+
+typedef struct aggregation_slot_s {
+    aggregation_acc* accs;
+} aggregation_slot;
+
+typedef struct aggregation_state_s {
+    VALUE vKernels;
+    int kernels_size;
+    aggregation_kernel* kernels;
+    query_data* data;
+    uint64_t generation;
+    pthread_mutex_t lock;
+    int slots_size;
+    aggregation_slot slots[AGGREGATION_MAX_SLOTS + 1];
+    volatile bool cancelled;
+    volatile bool out_of_memory;
+} aggregation_state;
+
+void aggregation_init(aggregation_state* state, VALUE vOptions, query_data* data);
+bool aggregation_callback(const as_val* value, void* udata);
+VALUE aggregation_result(aggregation_state* state);
+void aggregation_destroy(aggregation_state* state);
+
+#endif // AGGREGATION_H
@@ -1,6 +1,8 @@
 #include "batch.h"
 #include "client.h"
 #include "record.h"
+#include "stats.h"
+#include "probes.h"
 #include <aerospike/aerospike_batch.h>
 
 VALUE BatchClass;
@@ -14,7 +16,9 @@ VALUE batch_initialize(VALUE vSelf, VALUE vClient)
 
 bool batch_read_callback(const as_batch_read* results, uint32_t n, void* udata)
 {
+    batch_data* data = (batch_data*) udata;
     uint32_t i = 0;
+    uint64_t started_at;
     char sMsg[1000];
 
     for(i = 0; i < n; i++) {
@@ -22,7 +26,9 @@ bool batch_read_callback(const as_batch_read* results, uint32_t n, void* udata)
 
         switch(results[i].result) {
         case AEROSPIKE_OK: {
+            started_at = stats_now();
             vRecord = rb_record_from_c(&results[i].record, results[i].key);
+            data->conversion_ns += stats_now() - started_at;
             break;
         }
         case AEROSPIKE_ERR_RECORD_NOT_FOUND:
@@ -35,10 +41,11 @@ bool batch_read_callback(const as_batch_read* results, uint32_t n, void* udata)
         }
 
         if ( rb_block_given_p() ) {
+            started_at = stats_now();
             rb_yield(vRecord);
+            data->block_ns += stats_now() - started_at;
         } else {
-            VALUE *vArray = (VALUE*) udata;
-            rb_ary_push(*vArray, vRecord);
+            rb_ary_push(data->vArray, vRecord);
         }
     }
 
@@ -57,13 +64,16 @@ bool batch_read_callback(const as_batch_read* results, uint32_t n, void* udata)
  */
 VALUE batch_get(int argc, VALUE* vArgs, VALUE vSelf)
 {
-    VALUE vKeys, vClient, vArray, vBins;
+    VALUE vKeys, vClient, vBins;
 
     as_batch batch;
     as_policy_batch policy;
     as_key* key;
     aerospike* ptr;
     as_error err;
+    as_status status;
+    batch_data data;
+    stats_timer timer;
 
     uint32_t n = 0, idx = 0, bins_idx = 0;
 
@@ -100,6 +110,9 @@ VALUE batch_get(int argc, VALUE* vArgs, VALUE vSelf)
         }
     }
 
+    vClient = rb_iv_get(vSelf, "@client");
+    stats_timer_start(&timer, vClient, STATS_COMMAND_BATCH);
+
     idx = RARRAY_LEN(vKeys);
     as_batch_inita(&batch, idx);
 
@@ -107,12 +120,18 @@ VALUE batch_get(int argc, VALUE* vArgs, VALUE vSelf)
         VALUE vKey = rb_ary_entry(vKeys, n);
         Data_Get_Struct(vKey, as_key, key);
         as_key_init_value(as_batch_keyat(&batch, n), key->ns, key->set, key->valuep);
+        if (n == 0) {
+            stats_timer_namespace(&timer, key->ns, key->set);
+        }
     }
+    stats_timer_records(&timer, idx);
 
-    vClient = rb_iv_get(vSelf, "@client");
     Data_Get_Struct(vClient, aerospike, ptr);
 
-    vArray = rb_ary_new();
+    data.vArray = rb_ary_new();
+    data.conversion_ns = 0;
+    data.block_ns = 0;
+    PROBE_BATCH_BEGIN(timer.id, timer.ns, idx);
     if (bins_idx > 0) {
         char* sBins[bins_idx];
         for(n = 0; n < bins_idx; n++) {
@@ -120,23 +139,27 @@ VALUE batch_get(int argc, VALUE* vArgs, VALUE vSelf)
             GET_STRING(vEl);
             sBins[n] = StringValueCStr(vEl);
         }
-        if (aerospike_batch_get_bins(ptr, &err, &policy, &batch, sBins, bins_idx, batch_read_callback, &vArray) != AEROSPIKE_OK) {
-            as_batch_destroy(&batch);
-            raise_aerospike_exception(err.code, err.message);
-        }
+        stats_timer_begin_network(&timer);
+        status = aerospike_batch_get_bins(ptr, &err, &policy, &batch, sBins, bins_idx, batch_read_callback, &data);
     } else {
-        if (aerospike_batch_get(ptr, &err, &policy, &batch, batch_read_callback, &vArray) != AEROSPIKE_OK) {
-            as_batch_destroy(&batch);
-            raise_aerospike_exception(err.code, err.message);
-        }
+        stats_timer_begin_network(&timer);
+        status = aerospike_batch_get(ptr, &err, &policy, &batch, batch_read_callback, &data);
     }
+    stats_timer_end_network(&timer);
+    PROBE_BATCH_END(timer.id, timer.ns, idx, status);
+    stats_timer_exclude(&timer, data.conversion_ns, data.block_ns);
 
     as_batch_destroy(&batch);
+    stats_timer_finish(&timer, status);
+    if (status != AEROSPIKE_OK) {
+        raise_aerospike_exception(err.code, err.message);
+    }
+
     if ( rb_block_given_p() ) {
         return Qnil;
     }
 
-    return vArray;
+    return data.vArray;
 }
 
 // TODO: implement batch read to customize bins for each key
@@ -153,13 +176,16 @@ VALUE batch_get(int argc, VALUE* vArgs, VALUE vSelf)
  */
 VALUE batch_exists(int argc, VALUE* vArgs, VALUE vSelf)
 {
-    VALUE vKeys, vClient, vArray;
+    VALUE vKeys, vClient;
 
     as_batch batch;
     as_policy_batch policy;
     as_key* key;
     aerospike* ptr;
     as_error err;
+    as_status status;
+    batch_data data;
+    stats_timer timer;
 
     uint32_t n = 0, idx = 0;
 
@@ -175,6 +201,9 @@ VALUE batch_exists(int argc, VALUE* vArgs, VALUE vSelf)
         SET_BATCH_POLICY(policy, vArgs[1]);
     }
 
+    vClient = rb_iv_get(vSelf, "@client");
+    stats_timer_start(&timer, vClient, STATS_COMMAND_BATCH);
+
     idx = RARRAY_LEN(vKeys);
     as_batch_inita(&batch, idx);
 
@@ -182,23 +211,34 @@ VALUE batch_exists(int argc, VALUE* vArgs, VALUE vSelf)
         VALUE vKey = rb_ary_entry(vKeys, n);
         Data_Get_Struct(vKey, as_key, key);
         as_key_init_value(as_batch_keyat(&batch, n), key->ns, key->set, key->valuep);
+        if (n == 0) {
+            stats_timer_namespace(&timer, key->ns, key->set);
+        }
     }
+    stats_timer_records(&timer, idx);
 
-    vClient = rb_iv_get(vSelf, "@client");
     Data_Get_Struct(vClient, aerospike, ptr);
 
-    vArray = rb_ary_new();
-    if (aerospike_batch_exists(ptr, &err, &policy, &batch, batch_read_callback, &vArray) != AEROSPIKE_OK) {
-        as_batch_destroy(&batch);
+    data.vArray = rb_ary_new();
+    data.conversion_ns = 0;
+    data.block_ns = 0;
+    PROBE_BATCH_BEGIN(timer.id, timer.ns, idx);
+    stats_timer_begin_network(&timer);
+    status = aerospike_batch_exists(ptr, &err, &policy, &batch, batch_read_callback, &data);
+    stats_timer_end_network(&timer);
+    PROBE_BATCH_END(timer.id, timer.ns, idx, status);
+    stats_timer_exclude(&timer, data.conversion_ns, data.block_ns);
+    as_batch_destroy(&batch);
+    stats_timer_finish(&timer, status);
+    if (status != AEROSPIKE_OK) {
         raise_aerospike_exception(err.code, err.message);
     }
-    as_batch_destroy(&batch);
 
     if ( rb_block_given_p() ) {
         return Qnil;
     }
 
-    return vArray;
+    return data.vArray;
 }
 
 void define_batch()
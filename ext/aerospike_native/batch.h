@@ -3,6 +3,12 @@
 
 #include "aerospike_native.h"
 
+typedef struct batch_data_s {
+    VALUE vArray;
+    uint64_t conversion_ns;
+    uint64_t block_ns;
+} batch_data;
+
 RUBY_EXTERN VALUE BatchClass;
 void define_batch();
 
@@ -1,16 +1,25 @@
 #include "client.h"
 #include "operation.h"
+#include "operation_list.h"
 #include "key.h"
 #include "record.h"
 #include "query.h"
 #include "batch.h"
 #include "scan.h"
 #include "udf.h"
+#include "import.h"
+#include "geo.h"
+#include "index_task.h"
+#include "info.h"
+#include "stats.h"
 #include <aerospike/as_key.h>
 #include <aerospike/as_operations.h>
 #include <aerospike/aerospike_key.h>
 #include <aerospike/aerospike_index.h>
 #include <aerospike/aerospike_query.h>
+#include <aerospike/aerospike_info.h>
+#include <pthread.h>
+#include <ruby/thread.h>
 
 VALUE ClientClass;
 VALUE LoggerInstance;
@@ -43,12 +52,69 @@ static VALUE client_allocate(VALUE klass)
     return obj;
 }
 
+static bool client_uint_option(VALUE vSettings, const char* name, uint32_t* value)
+{
+    VALUE vValue = rb_hash_option(vSettings, name);
+
+    if (TYPE(vValue) == T_NIL) {
+        return false;
+    }
+    *value = NUM2UINT(vValue);
+
+    return true;
+}
+
+static bool client_warmup_callback(const as_error* err, const as_node* node, const char* req, char* res, void* udata)
+{
+    return true;
+}
+
+static void* client_warmup_worker(void* ptr)
+{
+    aerospike* as = (aerospike*) ptr;
+    as_error err;
+    as_policy_info policy;
+
+    as_policy_info_init(&policy);
+    aerospike_info_foreach(as, &err, &policy, "build", client_warmup_callback, NULL);
+
+    return NULL;
+}
+
+/*
+ * open connections to every node by concurrent info requests, connections are returned to node pools
+ */
+static void* client_warmup_without_gvl(void* ptr)
+{
+    client_warmup* warmup = (client_warmup*) ptr;
+    pthread_t* threads = (pthread_t*) calloc(warmup->connections, sizeof(pthread_t));
+    uint32_t n, count = 0;
+
+    for(n = 0; n < warmup->connections; n++) {
+        if (pthread_create(&threads[count], NULL, client_warmup_worker, warmup->as) == 0) {
+            count++;
+        }
+    }
+    for(n = 0; n < count; n++) {
+        pthread_join(threads[n], NULL);
+    }
+    free(threads);
+
+    return NULL;
+}
+
 /*
  * call-seq:
  *   new() -> AerospikeNative::Client
  *   new(hosts) -> AerospikeNative::Client
+ *   new(hosts, settings) -> AerospikeNative::Client
  *
- * initialize new client, use host' => ..., 'port' => ... for each hosts element
+ * initialize new client, use host' => ..., 'port' => ... for each hosts element.
+ * Settings are 'lua' => \{'system_path' => ..., 'user_path' => ...\} and cluster tuning: 'max_connections_per_node',
+ * 'connect_timeout' (ms), 'tender_interval' (ms), 'max_socket_idle' (seconds), 'thread_pool_size'
+ * and 'min_connections_per_node' to open connections to every node before first command.
+ * 'native_collections' => true stores Array and Hash bin values as native lists and maps (required by collection indexes)
+ * instead of msgpack bytes, readers of existing msgpack bins should be updated before it is enabled
  */
 VALUE client_initialize(int argc, VALUE* argv, VALUE self)
 {
@@ -57,6 +123,7 @@ VALUE client_initialize(int argc, VALUE* argv, VALUE self)
     as_config config;
     as_error err;
     long idx = 0, n = 0;
+    uint32_t value = 0, min_connections = 0;
 
     if (argc > 2) {  // there should only be 0, 1 or 2 arguments
         rb_raise(rb_eArgError, "wrong number of arguments (%d for 0..2)", argc);
@@ -97,6 +164,8 @@ VALUE client_initialize(int argc, VALUE* argv, VALUE self)
     }
 
     Data_Get_Struct(self, aerospike, ptr);
+    rb_iv_set(self, "@stats", rb_stats_new());
+    rb_iv_set(self, "@native_collections", Qfalse);
 
     as_config_init(&config);
     if (TYPE(vSettings) != T_NIL) {
@@ -121,6 +190,30 @@ VALUE client_initialize(int argc, VALUE* argv, VALUE self)
                 strcpy(config.lua.user_path, StringValueCStr(vUserPath));
             }
         }
+
+        if (RTEST(rb_hash_option(vSettings, "native_collections"))) {
+            rb_iv_set(self, "@native_collections", Qtrue);
+        }
+
+        client_uint_option(vSettings, "max_connections_per_node", &config.max_conns_per_node);
+        client_uint_option(vSettings, "connect_timeout", &config.conn_timeout_ms);
+        client_uint_option(vSettings, "tender_interval", &config.tender_interval);
+        client_uint_option(vSettings, "thread_pool_size", &config.thread_pool_size);
+        if (client_uint_option(vSettings, "max_socket_idle", &value)) {
+#ifdef HAVE_AS_CONFIG_MAX_SOCKET_IDLE
+            config.max_socket_idle = value;
+#else
+            rb_raise(rb_eNotImpError, "max_socket_idle is not supported by aerospike client library");
+#endif
+        }
+        if (client_uint_option(vSettings, "min_connections_per_node", &min_connections)) {
+            if (min_connections > config.max_conns_per_node) {
+                rb_raise(rb_eArgError, "min_connections_per_node is greater than max_connections_per_node");
+            }
+#ifdef HAVE_AS_CONFIG_MIN_CONNS_PER_NODE
+            config.min_conns_per_node = min_connections;
+#endif
+        }
     }
 
     if (TYPE(ary) == T_ARRAY) {
@@ -149,9 +242,95 @@ VALUE client_initialize(int argc, VALUE* argv, VALUE self)
     if ( aerospike_connect(ptr, &err) != AEROSPIKE_OK ) {
         raise_aerospike_exception(err.code, err.message);
     }
+
+#ifndef HAVE_AS_CONFIG_MIN_CONNS_PER_NODE
+    if (min_connections > 0) {
+        client_warmup warmup;
+        warmup.as = ptr;
+        warmup.connections = min_connections;
+        rb_thread_call_without_gvl(client_warmup_without_gvl, &warmup, NULL, NULL);
+    }
+#endif
+
     return self;
 }
 
+/*
+ * fill initialized record with bins hash values
+ */
+static void client_bin_msgpack(as_record* record, VALUE bin_name, VALUE bin_value)
+{
+    VALUE vBytes = rb_funcall(bin_value, rb_intern("to_msgpack"), 0);
+    long size = RSTRING_LEN(vBytes);
+    uint8_t* bytes = malloc(size);
+
+    memcpy(bytes, RSTRING_PTR(vBytes), size);
+    as_record_set_rawp(record, StringValueCStr(bin_name), bytes, (uint32_t) size, true);
+}
+
+/*
+ * check client setting 'native_collections'
+ */
+bool client_native_collections(VALUE vClient)
+{
+    return RTEST(rb_iv_get(vClient, "@native_collections"));
+}
+
+static void client_bins_to_record(VALUE vSelf, VALUE vBins, as_record* record)
+{
+    bool native_collections = client_native_collections(vSelf);
+    VALUE vHashKeys = rb_hash_keys(vBins);
+    long n, idx = RARRAY_LEN(vHashKeys);
+
+    for(n = 0; n < idx; n++) {
+        VALUE bin_name = rb_ary_entry(vHashKeys, n);
+        VALUE bin_value = rb_hash_aref(vBins, bin_name);
+
+        Check_Type(bin_name, T_STRING);
+
+        if (is_aerospike_geojson(bin_value)) {
+#ifdef HAVE_AEROSPIKE_AS_GEOJSON_H
+            VALUE vGeo = rb_iv_get(bin_value, "@value");
+            as_record_set_geojson_strp(record, StringValueCStr(bin_name), strdup(StringValueCStr(vGeo)), true);
+            continue;
+#else
+            as_record_destroy(record);
+            rb_raise(rb_eNotImpError, "geojson bins are not supported by aerospike client library");
+#endif
+        }
+
+        switch( TYPE(bin_value) ) {
+        case T_NIL:
+            as_record_set_nil(record, StringValueCStr(bin_name));
+            break;
+        case T_STRING:
+            as_record_set_str(record, StringValueCStr(bin_name), StringValueCStr(bin_value));
+            break;
+        case T_FIXNUM:
+            as_record_set_int64(record, StringValueCStr(bin_name), NUM2LONG(bin_value));
+            break;
+        case T_ARRAY:
+            if (native_collections) {
+                // stored as native list to be indexable by collection indexes
+                as_record_set_list(record, StringValueCStr(bin_name), rb_array_to_as_list(bin_value));
+            } else {
+                client_bin_msgpack(record, bin_name, bin_value);
+            }
+            break;
+        case T_HASH:
+            if (native_collections) {
+                as_record_set_map(record, StringValueCStr(bin_name), (as_map*) rb_value_to_as_val(bin_value));
+            } else {
+                client_bin_msgpack(record, bin_name, bin_value);
+            }
+            break;
+        default:
+            client_bin_msgpack(record, bin_name, bin_value);
+            break;
+        }
+    }
+}
+
 /*
  * call-seq:
  *   put(key, bins) -> true or false
@@ -163,15 +342,15 @@ VALUE client_put(int argc, VALUE* vArgs, VALUE vSelf)
 {
     VALUE vKey;
     VALUE vBins;
-    VALUE vHashKeys;
 
     aerospike *ptr;
     as_key* key;
     as_error err;
     as_record record;
     as_policy_write policy;
+    stats_timer timer;
 
-    int idx = 0, n = 0;
+    int idx = 0;
 
     if (argc > 3 || argc < 2) {  // there should only be 2 or 3 arguments
         rb_raise(rb_eArgError, "wrong number of arguments (%d for 2..3)", argc);
@@ -194,47 +373,26 @@ VALUE client_put(int argc, VALUE* vArgs, VALUE vSelf)
         return Qfalse;
     }
 
+    stats_timer_start(&timer, vSelf, STATS_COMMAND_PUT);
     Data_Get_Struct(vSelf, aerospike, ptr);
     as_record_inita(&record, idx);
-    vHashKeys = rb_hash_keys(vBins);
-
-    for(n = 0; n < idx; n++) {
-        VALUE bin_name = rb_ary_entry(vHashKeys, n);
-        VALUE bin_value = rb_hash_aref(vBins, bin_name);
-
-        Check_Type(bin_name, T_STRING);
-
-        switch( TYPE(bin_value) ) {
-        case T_NIL:
-            as_record_set_nil(&record, StringValueCStr(bin_name));
-            break;
-        case T_STRING:
-            as_record_set_str(&record, StringValueCStr(bin_name), StringValueCStr(bin_value));
-            break;
-        case T_FIXNUM:
-            as_record_set_int64(&record, StringValueCStr(bin_name), NUM2LONG(bin_value));
-            break;
-//        case T_ARRAY:
-//        case T_HASH:
-//            rb_raise(rb_eTypeError, "wrong argument type for bin value (hashes and arrays not supported yet)");
-//            break;
-        default: {
-            VALUE vBytes = rb_funcall(bin_value, rb_intern("to_msgpack"), 0);
-            int strSize = RSTRING_LEN(vBytes);
-            as_record_set_raw(&record, StringValueCStr(bin_name), StringValuePtr(vBytes), strSize);
-            break;
-        }
-        }
-     }
+    client_bins_to_record(vSelf, vBins, &record);
+    stats_timer_sent(&timer, &record);
 
     Data_Get_Struct(vKey, as_key, key);
+    stats_timer_key(&timer, key);
 
+    stats_timer_begin_network(&timer);
     if (aerospike_key_put(ptr, &err, &policy, key, &record) != AEROSPIKE_OK) {
+        stats_timer_end_network(&timer);
         as_record_destroy(&record);
+        stats_timer_finish(&timer, err.code);
         raise_aerospike_exception(err.code, err.message);
     }
+    stats_timer_end_network(&timer);
 
     as_record_destroy(&record);
+    stats_timer_finish(&timer, AEROSPIKE_OK);
     return Qtrue;
 }
 
@@ -247,13 +405,14 @@ VALUE client_put(int argc, VALUE* vArgs, VALUE vSelf)
  */
 VALUE client_get(int argc, VALUE* vArgs, VALUE vSelf)
 {
-    VALUE vKey;
+    VALUE vKey, vRecord;
 
     aerospike *ptr;
     as_key* key;
     as_error err;
     as_record* record = NULL;
     as_policy_read policy;
+    stats_timer timer;
 
     if (argc > 2 || argc < 1) {  // there should only be 1 or 2 arguments
         rb_raise(rb_eArgError, "wrong number of arguments (%d for 1..2)", argc);
@@ -268,28 +427,45 @@ VALUE client_get(int argc, VALUE* vArgs, VALUE vSelf)
         SET_READ_POLICY(policy, vArgs[1]);
     }
 
+    stats_timer_start(&timer, vSelf, STATS_COMMAND_GET);
     Data_Get_Struct(vSelf, aerospike, ptr);
     Data_Get_Struct(vKey, as_key, key);
+    stats_timer_key(&timer, key);
 
+    stats_timer_begin_network(&timer);
     if (aerospike_key_get(ptr, &err, &policy, key, &record) != AEROSPIKE_OK) {
+        stats_timer_end_network(&timer);
         as_record_destroy(record);
+        stats_timer_finish(&timer, err.code);
         raise_aerospike_exception(err.code, err.message);
     }
+    stats_timer_end_network(&timer);
+    stats_timer_received(&timer, record);
 
-    return rb_record_from_c(record, key);
+    vRecord = rb_record_from_c(record, key);
+    stats_timer_finish(&timer, AEROSPIKE_OK);
+
+    return vRecord;
 }
 
 /*
  * call-seq:
  *   operate(key, operations) -> true, false or AerospikeNative::Record
  *   operate(key, operations, policy_settings) -> true, false or AerospikeNative::Record
+ *   operate(key, operation_list, values) -> true or AerospikeNative::Record
+ *   operate(key, operation_list, values, policy_settings) -> true or AerospikeNative::Record
  *
  * perform multiple operations in one transaction, operations are array of AerospikeNative::Operation
+ * or precompiled AerospikeNative::OperationList with values for its slots (nil to use compiled values).
+ * Results of list, map, HLL and bitwise operations are returned as bins of AerospikeNative::Record
  */
 VALUE client_operate(int argc, VALUE* vArgs, VALUE vSelf)
 {
     VALUE vKey;
     VALUE vOperations;
+    VALUE vValues = Qnil, vPolicy = Qnil;
+    VALUE vRawBins = Qnil;
+    VALUE vRecord;
     long idx = 0, n = 0;
     bool isset_read = false;
 
@@ -299,115 +475,429 @@ VALUE client_operate(int argc, VALUE* vArgs, VALUE vSelf)
     as_error err;
     as_policy_operate policy;
     as_record* record = NULL;
+    stats_timer timer;
 
-    if (argc > 3 || argc < 2) {  // there should only be 2 or 3 arguments
-        rb_raise(rb_eArgError, "wrong number of arguments (%d for 2..3)", argc);
+    if (argc > 4 || argc < 2) {  // there should only be 2..4 arguments
+        rb_raise(rb_eArgError, "wrong number of arguments (%d for 2..4)", argc);
     }
 
     vKey = vArgs[0];
     check_aerospike_key(vKey);
 
     vOperations = vArgs[1];
-    Check_Type(vOperations, T_ARRAY);
-    as_policy_operate_init(&policy);
+    if (is_operation_list(vOperations)) {
+        if (argc > 2) {
+            vValues = vArgs[2];
+        }
+        if (argc > 3) {
+            vPolicy = vArgs[3];
+        }
+        idx = operation_list_size(vOperations);
+    } else {
+        Check_Type(vOperations, T_ARRAY);
+        if (argc > 3) {
+            rb_raise(rb_eArgError, "wrong number of arguments (%d for 2..3)", argc);
+        }
+        if (argc > 2) {
+            vPolicy = vArgs[2];
+        }
+        idx = RARRAY_LEN(vOperations);
+    }
 
-    if (argc == 3 && TYPE(vArgs[2]) != T_NIL) {
-        SET_OPERATE_POLICY(policy, vArgs[2]);
+    as_policy_operate_init(&policy);
+    if (TYPE(vPolicy) != T_NIL) {
+        SET_OPERATE_POLICY(policy, vPolicy);
     }
 
-    idx = RARRAY_LEN(vOperations);
     if (idx == 0) {
         return Qfalse;
     }
 
+    stats_timer_start(&timer, vSelf, STATS_COMMAND_OPERATE);
     Data_Get_Struct(vSelf, aerospike, ptr);
     as_operations_inita(&ops, idx);
 
-   for(n = 0; n < idx; n++) {
-        VALUE operation = rb_ary_entry(vOperations, n);
-        int op_type = NUM2INT( rb_iv_get(operation, "@op_type") );
-        VALUE bin_name = rb_iv_get(operation, "@bin_name");
-        VALUE bin_value = rb_iv_get(operation, "@bin_value");
-
-        switch( op_type ) {
-        case OPERATION_WRITE:
-            switch( TYPE(bin_value) ) {
-            case T_NIL: {
-                as_record rec;
-                as_record_inita(&rec, 1);
-                as_record_set_nil(&rec, StringValueCStr( bin_name ));
-                ops.binops.entries[ops.binops.size].op = AS_OPERATOR_WRITE;
-                ops.binops.entries[ops.binops.size].bin = rec.bins.entries[0];
-                ops.binops.size++;
-                break;
-            }
-            case T_STRING:
-                as_operations_add_write_str(&ops, StringValueCStr( bin_name ), StringValueCStr( bin_value ));
-                break;
-            case T_FIXNUM:
-                as_operations_add_write_int64(&ops, StringValueCStr( bin_name ), NUM2LONG( bin_value ));
-                break;
-//            case T_ARRAY:
-//            case T_HASH:
-//                rb_raise(rb_eTypeError, "wrong argument type for bin value (hashes and arrays not supported yet)");
-//                break;
-            default: {
-                VALUE vBytes = rb_funcall(bin_value, rb_intern("to_msgpack"), 0);
-                int strSize = RSTRING_LEN(vBytes);
-                as_operations_add_write_raw(&ops, StringValueCStr(bin_name), StringValuePtr(vBytes), strSize);
-                break;
-            }
-            }
+    if (is_operation_list(vOperations)) {
+        isset_read = operation_list_add(vOperations, vValues, &ops, &vRawBins);
+    } else {
+        for(n = 0; n < idx; n++) {
+            VALUE operation = rb_ary_entry(vOperations, n);
+            int op_type = NUM2INT( rb_iv_get(operation, "@op_type") );
+            VALUE bin_name = rb_iv_get(operation, "@bin_name");
+            VALUE bin_value = rb_iv_get(operation, "@bin_value");
 
-            break;
-        case OPERATION_READ:
-            isset_read = true;
-            as_operations_add_read(&ops, StringValueCStr( bin_name ));
-            break;
-        case OPERATION_INCREMENT:
-            as_operations_add_incr(&ops, StringValueCStr( bin_name ), NUM2INT( bin_value ));
-            break;
-        case OPERATION_APPEND:
-            Check_Type(bin_value, T_STRING);
-            as_operations_add_append_str(&ops, StringValueCStr( bin_name ), StringValueCStr( bin_value ));
-            break;
-        case OPERATION_PREPEND:
-            Check_Type(bin_value, T_STRING);
-            as_operations_add_prepend_str(&ops, StringValueCStr( bin_name ), StringValueCStr( bin_value ));
-            break;
-        case OPERATION_TOUCH:
-            isset_read = true;
-            as_operations_add_touch(&ops);
-            break;
-        default:
-            rb_raise(rb_eArgError, "Incorrect operation type");
-            break;
+            if (operation_add(&ops, op_type, bin_name, bin_value, &vRawBins)) {
+                isset_read = true;
+            }
         }
     }
 
     Data_Get_Struct(vKey, as_key, key);
+    stats_timer_key(&timer, key);
 
+    stats_timer_begin_network(&timer);
     if (isset_read) {
         if (aerospike_key_operate(ptr, &err, &policy, key, &ops, &record) != AEROSPIKE_OK) {
+            stats_timer_end_network(&timer);
             as_operations_destroy(&ops);
             as_record_destroy(record);
+            stats_timer_finish(&timer, err.code);
             raise_aerospike_exception(err.code, err.message);
         }
+        stats_timer_end_network(&timer);
+        stats_timer_received(&timer, record);
 
         as_operations_destroy(&ops);
 
-        return rb_record_from_c(record, key);
+        vRecord = rb_record_from_c_raw_bins(record, key, vRawBins);
+        stats_timer_finish(&timer, AEROSPIKE_OK);
+        return vRecord;
     } else {
         if (aerospike_key_operate(ptr, &err, &policy, key, &ops, NULL) != AEROSPIKE_OK) {
+            stats_timer_end_network(&timer);
             as_operations_destroy(&ops);
+            stats_timer_finish(&timer, err.code);
             raise_aerospike_exception(err.code, err.message);
         }
+        stats_timer_end_network(&timer);
 
         as_operations_destroy(&ops);
+        stats_timer_finish(&timer, AEROSPIKE_OK);
         return Qtrue;
     }
 }
 
+static int client_increment_foreach(VALUE vBinName, VALUE vDelta, VALUE vOps)
+{
+    as_operations* ops = (as_operations*) vOps;
+
+    if (TYPE(vBinName) == T_SYMBOL) {
+        vBinName = rb_sym_to_s(vBinName);
+    }
+    Check_Type(vBinName, T_STRING);
+
+    operation_add_incr(ops, StringValueCStr(vBinName), vDelta);
+    as_operations_add_read(ops, StringValueCStr(vBinName));
+
+    return ST_CONTINUE;
+}
+
+/*
+ * call-seq:
+ *   increment(key, bins) -> Integer, Float or Hash
+ *   increment(key, bins, policy_settings) -> Integer, Float or Hash
+ *
+ * increment bins by 64-bit integer or float deltas (bins is hash of bin name => delta) and read new values in one transaction,
+ * returns new value when one bin is incremented and hash of bin name => new value otherwise
+ */
+VALUE client_increment(int argc, VALUE* vArgs, VALUE vSelf)
+{
+    VALUE vKey, vBins, vResult;
+    long n, size;
+
+    aerospike *ptr;
+    as_operations ops;
+    as_key* key;
+    as_error err;
+    as_policy_operate policy;
+    as_record* record = NULL;
+    stats_timer timer;
+
+    if (argc > 3 || argc < 2) {  // there should only be 2 or 3 arguments
+        rb_raise(rb_eArgError, "wrong number of arguments (%d for 2..3)", argc);
+    }
+
+    vKey = vArgs[0];
+    check_aerospike_key(vKey);
+
+    vBins = vArgs[1];
+    Check_Type(vBins, T_HASH);
+    size = RHASH_SIZE(vBins);
+    if (size == 0) {
+        rb_raise(rb_eArgError, "No bins to increment");
+    }
+
+    as_policy_operate_init(&policy);
+    if (argc == 3 && TYPE(vArgs[2]) != T_NIL) {
+        SET_OPERATE_POLICY(policy, vArgs[2]);
+    }
+
+    stats_timer_start(&timer, vSelf, STATS_COMMAND_OPERATE);
+    Data_Get_Struct(vSelf, aerospike, ptr);
+    Data_Get_Struct(vKey, as_key, key);
+    stats_timer_key(&timer, key);
+
+    as_operations_inita(&ops, size * 2);
+    rb_hash_foreach(vBins, client_increment_foreach, (VALUE) &ops);
+
+    stats_timer_begin_network(&timer);
+    if (aerospike_key_operate(ptr, &err, &policy, key, &ops, &record) != AEROSPIKE_OK) {
+        stats_timer_end_network(&timer);
+        as_operations_destroy(&ops);
+        as_record_destroy(record);
+        stats_timer_finish(&timer, err.code);
+        raise_aerospike_exception(err.code, err.message);
+    }
+    stats_timer_end_network(&timer);
+    stats_timer_received(&timer, record);
+    as_operations_destroy(&ops);
+
+    if (size == 1 && record->bins.size == 1) {
+        vResult = rb_value_from_as_val((as_val*) record->bins.entries[0].valuep);
+    } else {
+        vResult = rb_hash_new();
+        for(n = 0; n < record->bins.size; n++) {
+            as_bin* bin = &record->bins.entries[n];
+            rb_hash_aset(vResult, rb_str_new2(bin->name), rb_value_from_as_val((as_val*) bin->valuep));
+        }
+    }
+    as_record_destroy(record);
+    stats_timer_finish(&timer, AEROSPIKE_OK);
+
+    return vResult;
+}
+
+static void client_update_stats_add(VALUE vSelf, const char* name, long value)
+{
+    VALUE vStats = rb_iv_get(vSelf, "@update_stats");
+    VALUE vName = rb_str_new2(name);
+
+    if (TYPE(vStats) != T_HASH) {
+        vStats = rb_hash_new();
+        rb_hash_aset(vStats, rb_str_new2("updates"), INT2FIX(0));
+        rb_hash_aset(vStats, rb_str_new2("conflicts"), INT2FIX(0));
+        rb_hash_aset(vStats, rb_str_new2("exhausted"), INT2FIX(0));
+        rb_iv_set(vSelf, "@update_stats", vStats);
+    }
+
+    rb_hash_aset(vStats, vName, LONG2NUM(NUM2LONG(rb_hash_aref(vStats, vName)) + value));
+}
+
+/*
+ * call-seq:
+ *   update(key) { |record| new_bins } -> true or false
+ *   update(key, options) { |record| new_bins } -> true or false
+ *   update(key, options, policy_settings) { |record| new_bins } -> true or false
+ *
+ * optimistic read-modify-write: read record (nil if it doesn't exist), yield it and write returned bins only if record generation
+ * is unchanged (or record is still absent). On generation conflict block is retried after jittered exponential backoff.
+ * Options are \{'max_attempts' => 10, 'backoff' => 5, 'max_backoff' => 1000\} (backoff in ms), returns false when block returns nil.
+ * Counters are available by update_stats
+ */
+VALUE client_update(int argc, VALUE* vArgs, VALUE vSelf)
+{
+    VALUE vKey, vOption;
+    long max_attempts = 10, backoff = 5, max_backoff = 1000, attempt;
+
+    aerospike *ptr;
+    as_key* key;
+    as_error err;
+    as_policy_write policy;
+    as_policy_read read_policy;
+    as_policy_exists exists_policy;
+
+    if (argc > 3 || argc < 1) {  // there should only be 1..3 arguments
+        rb_raise(rb_eArgError, "wrong number of arguments (%d for 1..3)", argc);
+    }
+    rb_need_block();
+
+    vKey = vArgs[0];
+    check_aerospike_key(vKey);
+
+    if (argc > 1 && TYPE(vArgs[1]) != T_NIL) {
+        Check_Type(vArgs[1], T_HASH);
+        vOption = rb_hash_option(vArgs[1], "max_attempts");
+        if (TYPE(vOption) != T_NIL) {
+            max_attempts = NUM2LONG(vOption);
+        }
+        vOption = rb_hash_option(vArgs[1], "backoff");
+        if (TYPE(vOption) != T_NIL) {
+            backoff = NUM2LONG(vOption);
+        }
+        vOption = rb_hash_option(vArgs[1], "max_backoff");
+        if (TYPE(vOption) != T_NIL) {
+            max_backoff = NUM2LONG(vOption);
+        }
+        if (max_attempts < 1 || backoff < 0 || max_backoff < backoff) {
+            rb_raise(rb_eArgError, "Incorrect update options");
+        }
+    }
+
+    as_policy_write_init(&policy);
+    if (argc == 3 && TYPE(vArgs[2]) != T_NIL) {
+        SET_WRITE_POLICY(policy, vArgs[2]);
+    }
+    as_policy_read_init(&read_policy);
+    read_policy.timeout = policy.timeout;
+    exists_policy = policy.exists;
+
+    Data_Get_Struct(vSelf, aerospike, ptr);
+    Data_Get_Struct(vKey, as_key, key);
+
+    for(attempt = 1; ; attempt++) {
+        VALUE vRecord = Qnil, vBins;
+        as_record* current = NULL;
+        as_record record;
+        as_status status;
+        uint16_t gen = 0;
+        bool exists = true;
+        struct timeval delay;
+        long delay_ms;
+
+        status = aerospike_key_get(ptr, &err, &read_policy, key, &current);
+        if (status == AEROSPIKE_ERR_RECORD_NOT_FOUND) {
+            as_record_destroy(current);
+            exists = false;
+        } else if (status != AEROSPIKE_OK) {
+            as_record_destroy(current);
+            raise_aerospike_exception(err.code, err.message);
+        } else {
+            gen = current->gen;
+            vRecord = rb_record_from_c(current, key);
+        }
+
+        vBins = rb_yield(vRecord);
+        if (!RTEST(vBins)) {
+            return Qfalse;
+        }
+        Check_Type(vBins, T_HASH);
+        if (RHASH_SIZE(vBins) == 0) {
+            return Qfalse;
+        }
+
+        as_record_init(&record, RHASH_SIZE(vBins));
+        client_bins_to_record(vSelf, vBins, &record);
+        if (exists) {
+            policy.gen = AS_POLICY_GEN_EQ;
+            policy.exists = exists_policy;
+            record.gen = gen;
+        } else {
+            policy.gen = AS_POLICY_GEN_IGNORE;
+            policy.exists = AS_POLICY_EXISTS_CREATE;
+        }
+
+        status = aerospike_key_put(ptr, &err, &policy, key, &record);
+        as_record_destroy(&record);
+
+        if (status == AEROSPIKE_OK) {
+            client_update_stats_add(vSelf, "updates", 1);
+            return Qtrue;
+        }
+        if (status != AEROSPIKE_ERR_RECORD_GENERATION && status != AEROSPIKE_ERR_RECORD_EXISTS && status != AEROSPIKE_ERR_RECORD_BUSY) {
+            raise_aerospike_exception(err.code, err.message);
+        }
+
+        client_update_stats_add(vSelf, "conflicts", 1);
+        if (attempt >= max_attempts) {
+            client_update_stats_add(vSelf, "exhausted", 1);
+            raise_aerospike_exception(err.code, err.message);
+        }
+
+        // full jitter: sleep random time up to exponentially growing cap, GVL is released while sleeping
+        delay_ms = backoff << (attempt - 1 < 16 ? attempt - 1 : 16);
+        if (delay_ms > max_backoff || delay_ms < 0) {
+            delay_ms = max_backoff;
+        }
+        delay_ms = (long) (rb_genrand_real() * delay_ms);
+        delay.tv_sec = delay_ms / 1000;
+        delay.tv_usec = (delay_ms % 1000) * 1000;
+        rb_thread_wait_for(delay);
+    }
+
+    return Qfalse;
+}
+
+/*
+ * call-seq:
+ *   update_stats -> Hash
+ *
+ * counters of update command: successful updates, generation conflicts and updates which exhausted all attempts
+ */
+VALUE client_update_stats(VALUE vSelf)
+{
+    VALUE vStats = rb_iv_get(vSelf, "@update_stats");
+
+    if (TYPE(vStats) != T_HASH) {
+        client_update_stats_add(vSelf, "updates", 0);
+        vStats = rb_iv_get(vSelf, "@update_stats");
+    }
+
+    return rb_hash_dup(vStats);
+}
+
+/*
+ * call-seq:
+ *   apply(key, module, function) -> Object
+ *   apply(key, module, function, args) -> Object
+ *   apply(key, module, function, args, policy_settings) -> Object
+ *
+ * apply record udf function to specified key, args are array of function arguments, returns function result
+ */
+VALUE client_apply(int argc, VALUE* vArgs, VALUE vSelf)
+{
+    VALUE vKey, vModule, vFunction, vResult;
+
+    aerospike *ptr;
+    as_key* key;
+    as_error err;
+    as_policy_apply policy;
+    as_list* arglist = NULL;
+    as_val* result = NULL;
+    stats_timer timer;
+
+    if (argc > 5 || argc < 3) {  // there should only be 3..5 arguments
+        rb_raise(rb_eArgError, "wrong number of arguments (%d for 3..5)", argc);
+    }
+
+    vKey = vArgs[0];
+    check_aerospike_key(vKey);
+
+    vModule = vArgs[1];
+    GET_STRING(vModule);
+    vFunction = vArgs[2];
+    GET_STRING(vFunction);
+
+    if (argc > 3 && TYPE(vArgs[3]) != T_NIL) {
+        Check_Type(vArgs[3], T_ARRAY);
+    }
+
+    as_policy_apply_init(&policy);
+    if (argc == 5 && TYPE(vArgs[4]) != T_NIL) {
+        SET_APPLY_POLICY(policy, vArgs[4]);
+    }
+
+    stats_timer_start(&timer, vSelf, STATS_COMMAND_APPLY);
+    if (argc > 3 && TYPE(vArgs[3]) != T_NIL) {
+        arglist = rb_array_to_as_list(vArgs[3]);
+    }
+
+    Data_Get_Struct(vSelf, aerospike, ptr);
+    Data_Get_Struct(vKey, as_key, key);
+    stats_timer_key(&timer, key);
+
+    stats_timer_begin_network(&timer);
+    if (aerospike_key_apply(ptr, &err, &policy, key, StringValueCStr(vModule), StringValueCStr(vFunction), arglist, &result) != AEROSPIKE_OK) {
+        stats_timer_end_network(&timer);
+        if (arglist != NULL) {
+            as_list_destroy(arglist);
+        }
+        stats_timer_finish(&timer, err.code);
+        raise_aerospike_exception(err.code, err.message);
+    }
+    stats_timer_end_network(&timer);
+    if (arglist != NULL) {
+        as_list_destroy(arglist);
+    }
+
+    vResult = rb_value_from_as_val(result);
+    if (result != NULL) {
+        as_val_destroy(result);
+    }
+    stats_timer_finish(&timer, AEROSPIKE_OK);
+
+    return vResult;
+}
+
 /*
  * call-seq:
  *   remove(key) -> true or false
@@ -423,6 +913,7 @@ VALUE client_remove(int argc, VALUE* vArgs, VALUE vSelf)
     as_key* key;
     as_error err;
     as_policy_remove policy;
+    stats_timer timer;
 
     if (argc > 2 || argc < 1) {  // there should only be 1 or 2 arguments
         rb_raise(rb_eArgError, "wrong number of arguments (%d for 1..2)", argc);
@@ -435,12 +926,19 @@ VALUE client_remove(int argc, VALUE* vArgs, VALUE vSelf)
         SET_REMOVE_POLICY(policy, vArgs[2]);
     }
 
+    stats_timer_start(&timer, vSelf, STATS_COMMAND_REMOVE);
     Data_Get_Struct(vSelf, aerospike, ptr);
     Data_Get_Struct(vKey, as_key, key);
+    stats_timer_key(&timer, key);
 
+    stats_timer_begin_network(&timer);
     if (aerospike_key_remove(ptr, &err, &policy, key) != AEROSPIKE_OK) {
+        stats_timer_end_network(&timer);
+        stats_timer_finish(&timer, err.code);
         raise_aerospike_exception(err.code, err.message);
     }
+    stats_timer_end_network(&timer);
+    stats_timer_finish(&timer, AEROSPIKE_OK);
 
     return Qtrue;
 }
@@ -462,6 +960,7 @@ VALUE client_exists(int argc, VALUE* vArgs, VALUE vSelf)
     as_policy_read policy;
     as_record* record = NULL;
     as_status status;
+    stats_timer timer;
 
     if (argc > 2 || argc < 1) {  // there should only be 1 or 2 arguments
         rb_raise(rb_eArgError, "wrong number of arguments (%d for 1..2)", argc);
@@ -474,15 +973,21 @@ VALUE client_exists(int argc, VALUE* vArgs, VALUE vSelf)
         SET_READ_POLICY(policy, vArgs[1]);
     }
 
+    stats_timer_start(&timer, vSelf, STATS_COMMAND_GET);
     Data_Get_Struct(vSelf, aerospike, ptr);
     Data_Get_Struct(vKey, as_key, key);
+    stats_timer_key(&timer, key);
 
+    stats_timer_begin_network(&timer);
     status = aerospike_key_exists(ptr, &err, &policy, key, &record);
+    stats_timer_end_network(&timer);
     if (status != AEROSPIKE_OK && status != AEROSPIKE_ERR_RECORD_NOT_FOUND) {
         as_record_destroy(record);
+        stats_timer_finish(&timer, err.code);
         raise_aerospike_exception(err.code, err.message);
     }
     as_record_destroy(record);
+    stats_timer_finish(&timer, AEROSPIKE_OK);
 
     if (status == AEROSPIKE_ERR_RECORD_NOT_FOUND) {
         return Qfalse;
@@ -502,12 +1007,14 @@ VALUE client_select(int argc, VALUE* vArgs, VALUE vSelf)
 {
     VALUE vKey;
     VALUE vArray;
+    VALUE vRecord;
 
     aerospike *ptr;
     as_key* key;
     as_error err;
     as_policy_read policy;
     as_record* record = NULL;
+    stats_timer timer;
     long n = 0, idx = 0;
 
     if (argc > 3 || argc < 2) {  // there should only be 2 or 3 arguments
@@ -528,8 +1035,10 @@ VALUE client_select(int argc, VALUE* vArgs, VALUE vSelf)
         SET_READ_POLICY(policy, vArgs[2]);
     }
 
+    stats_timer_start(&timer, vSelf, STATS_COMMAND_GET);
     Data_Get_Struct(vSelf, aerospike, ptr);
     Data_Get_Struct(vKey, as_key, key);
+    stats_timer_key(&timer, key);
     const char* bins[idx];
 
     for(n = 0; n < idx; n++) {
@@ -542,26 +1051,36 @@ VALUE client_select(int argc, VALUE* vArgs, VALUE vSelf)
         strcpy(bins[n], name);
     }
 
+    stats_timer_begin_network(&timer);
     if (aerospike_key_select(ptr, &err, &policy, key, bins, &record) != AEROSPIKE_OK) {
+        stats_timer_end_network(&timer);
         for(n = 0; n < idx; n++) {
             free(bins[n]);
         }
         as_record_destroy(record);
+        stats_timer_finish(&timer, err.code);
         raise_aerospike_exception(err.code, err.message);
     }
+    stats_timer_end_network(&timer);
+    stats_timer_received(&timer, record);
     for(n = 0; n < idx; n++) {
         free(bins[n]);
     }
 
-    return rb_record_from_c(record, key);
+    vRecord = rb_record_from_c(record, key);
+    stats_timer_finish(&timer, AEROSPIKE_OK);
+
+    return vRecord;
 }
 
 /*
  * call-seq:
  *   create_index(namespace, set, bin_name, index_name) -> true or false
- *   create_index(namespace, set, bin_name, index_name, policy_settings) -> true or false
+ *   create_index(namespace, set, bin_name, index_name, policy_settings) -> true, false or AerospikeNative::IndexTask
  *
- * Create new index, use \{'type' => AerospikeNative::INDEX_NUMERIC or AerospikeNative::INDEX_STRING\} as policy_settings to define index type
+ * Create new index, use \{'type' => AerospikeNative::INDEX_NUMERIC, AerospikeNative::INDEX_STRING or AerospikeNative::INDEX_GEO2DSPHERE\} as policy_settings to define index type
+ * and \{'collection' => AerospikeNative::INDEX_TYPE_LIST, AerospikeNative::INDEX_TYPE_MAPKEYS or AerospikeNative::INDEX_TYPE_MAPVALUES\} to index collection elements.
+ * With \{'wait' => false\} index task is returned right after the index is registered instead of waiting for the build
  */
 VALUE client_create_index(int argc, VALUE* vArgs, VALUE vSelf)
 {
@@ -570,8 +1089,12 @@ VALUE client_create_index(int argc, VALUE* vArgs, VALUE vSelf)
     aerospike *ptr;
     as_error err;
     as_policy_info policy;
+#ifdef HAVE_AEROSPIKE_INDEX_CREATE_COMPLEX
     as_index_task task;
-    bool is_integer = true;
+    int collection = 0;
+#endif
+    int type = INDEX_NUMERIC;
+    bool wait = true;
 
     if (argc > 5 || argc < 4) {  // there should only be 4 or 5 arguments
         rb_raise(rb_eArgError, "wrong number of arguments (%d for 4..5)", argc);
@@ -589,45 +1112,74 @@ VALUE client_create_index(int argc, VALUE* vArgs, VALUE vSelf)
     vIndexName = vArgs[3];
     Check_Type(vIndexName, T_STRING);
 
+    as_policy_info_init(&policy);
     if (argc == 5 && TYPE(vArgs[4]) != T_NIL) {
-        VALUE vType = Qnil;
+        VALUE vType = Qnil, vCollection = Qnil;
         SET_INFO_POLICY(policy, vArgs[4]);
         vType = rb_hash_aref(vArgs[4], rb_str_new2("type"));
         if (TYPE(vType) == T_FIXNUM) {
             switch(FIX2INT(vType)) {
             case INDEX_NUMERIC:
-                is_integer = true;
-                break;
             case INDEX_STRING:
-                is_integer = false;
+#ifdef HAVE_AEROSPIKE_AS_GEOJSON_H
+            case INDEX_GEO2DSPHERE:
+#endif
+                type = FIX2INT(vType);
                 break;
             default:
                 rb_raise(rb_eArgError, "Incorrect index type");
             }
         }
+
+        wait = rb_hash_option(vArgs[4], "wait") != Qfalse;
+
+        vCollection = rb_hash_aref(vArgs[4], rb_str_new2("collection"));
+        if (TYPE(vCollection) == T_FIXNUM) {
+#ifdef HAVE_AEROSPIKE_INDEX_CREATE_COMPLEX
+            switch(FIX2INT(vCollection)) {
+            case INDEX_TYPE_DEFAULT:
+            case INDEX_TYPE_LIST:
+            case INDEX_TYPE_MAPKEYS:
+            case INDEX_TYPE_MAPVALUES:
+                collection = FIX2INT(vCollection);
+                break;
+            default:
+                rb_raise(rb_eArgError, "Incorrect index collection type");
+            }
+#else
+            rb_raise(rb_eNotImpError, "collection indexes are not supported by aerospike client library");
+#endif
+        }
     }
 
     Data_Get_Struct(vSelf, aerospike, ptr);
 
-    if (is_integer) {
+#ifdef HAVE_AEROSPIKE_INDEX_CREATE_COMPLEX
+    if (aerospike_index_create_complex(ptr, &err, &task, &policy, StringValueCStr(vNamespace), StringValueCStr(vSet), StringValueCStr(vBinName), StringValueCStr(vIndexName), collection, type) != AEROSPIKE_OK) {
+        raise_aerospike_exception(err.code, err.message);
+    }
+#else
+    switch(type) {
+    case INDEX_NUMERIC:
         if (aerospike_index_integer_create(ptr, &err, &policy, StringValueCStr(vNamespace), StringValueCStr(vSet), StringValueCStr(vBinName), StringValueCStr(vIndexName)) != AEROSPIKE_OK) {
             raise_aerospike_exception(err.code, err.message);
         }
-    } else {
+        break;
+    case INDEX_STRING:
         if (aerospike_index_string_create(ptr, &err, &policy, StringValueCStr(vNamespace), StringValueCStr(vSet), StringValueCStr(vBinName), StringValueCStr(vIndexName)) != AEROSPIKE_OK) {
             raise_aerospike_exception(err.code, err.message);
         }
+        break;
+    default:
+        rb_raise(rb_eNotImpError, "index type is not supported by aerospike client library");
     }
+#endif
 
-    task.as = ptr;
-    strcpy(task.ns, StringValueCStr(vNamespace));
-    strcpy(task.name, StringValueCStr(vIndexName));
-    task.done = false;
-    if (aerospike_index_create_wait(&err, &task, 1000) != AEROSPIKE_OK) {
-        raise_aerospike_exception(err.code, err.message);
+    if (!wait) {
+        return rb_index_task_new(vSelf, vNamespace, vIndexName);
     }
 
-    return (task.done ? Qtrue : Qfalse);
+    return index_task_wait(0, NULL, rb_index_task_new(vSelf, vNamespace, vIndexName));
 }
 
 /*
@@ -767,6 +1319,10 @@ void define_client()
     rb_define_alloc_func(ClientClass, client_allocate);
     rb_define_method(ClientClass, "initialize", client_initialize, -1);
     rb_define_method(ClientClass, "operate", client_operate, -1);
+    rb_define_method(ClientClass, "increment", client_increment, -1);
+    rb_define_method(ClientClass, "update", client_update, -1);
+    rb_define_method(ClientClass, "update_stats", client_update_stats, 0);
+    rb_define_method(ClientClass, "apply", client_apply, -1);
     rb_define_method(ClientClass, "put", client_put, -1);
     rb_define_method(ClientClass, "get", client_get, -1);
     rb_define_method(ClientClass, "remove", client_remove, -1);
@@ -778,7 +1334,13 @@ void define_client()
     rb_define_method(ClientClass, "batch", client_batch, 0);
     rb_define_method(ClientClass, "scan", client_scan, 2);
     rb_define_method(ClientClass, "scan_info", client_scan_info, -1);
+    rb_define_method(ClientClass, "import", client_import, -1);
     rb_define_method(ClientClass, "udf", client_udf, 0);
+    rb_define_method(ClientClass, "nodes", client_nodes, -1);
+    rb_define_method(ClientClass, "info", client_info, -1);
+    rb_define_method(ClientClass, "namespace_stats", client_namespace_stats, -1);
+    rb_define_method(ClientClass, "stats", client_stats_report, -1);
+    rb_define_method(ClientClass, "reset_stats", client_reset_stats, 0);
 
     LoggerInstance = rb_class_new_instance(0, NULL, LoggerClass);
     rb_cv_set(ClientClass, "@@logger", LoggerInstance);
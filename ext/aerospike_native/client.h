@@ -3,9 +3,15 @@
 
 #include "aerospike_native.h"
 
+typedef struct client_warmup_s {
+    aerospike* as;
+    uint32_t connections;
+} client_warmup;
+
 RUBY_EXTERN VALUE ClientClass;
 RUBY_EXTERN VALUE LoggerInstance;
 void define_client();
 void check_aerospike_client(VALUE vClient);
+bool client_native_collections(VALUE vClient);
 
 #endif // CLIENT_H
@@ -15,3 +15,19 @@ VALUE rb_hash_keys(VALUE hash)
 
     return ary;
 }
+
+VALUE rb_hash_option(VALUE hash, const char* name)
+{
+    VALUE value;
+
+    if (TYPE(hash) != T_HASH) {
+        return Qnil;
+    }
+
+    value = rb_hash_aref(hash, rb_str_new2(name));
+    if (TYPE(value) == T_NIL) {
+        value = rb_hash_aref(hash, ID2SYM(rb_intern(name)));
+    }
+
+    return value;
+}
@@ -6,6 +6,7 @@
 #include "logger.h"
 
 VALUE rb_hash_keys(VALUE hash);
+VALUE rb_hash_option(VALUE hash, const char* name);
 
 #define GET_STRING(vString)                                                \
     switch(TYPE(vString)) {                                                \
@@ -168,6 +169,12 @@ VALUE rb_hash_keys(VALUE hash);
         policy.generation = FIX2UINT(vGeneration);                         \
     }
 
+#define SET_APPLY_POLICY(policy, vSettings)                                \
+    VALUE vKey, vCommitLevel;                                              \
+    SET_POLICY(policy, vSettings);                                         \
+    SET_KEY_POLICY(policy, vSettings);                                     \
+    SET_COMMIT_LEVEL_POLICY(policy, vSettings);
+
 #define SET_INFO_POLICY(policy, vSettings)                                 \
     VALUE vSendAsIs, vCheckBounds;                                         \
     SET_POLICY(policy, vSettings);                                         \
@@ -0,0 +1,348 @@
+#include "events.h"
+#include "client.h"
+#include "stats.h"
+#include <errno.h>
+#include <ruby/thread.h>
+#include <time.h>
+
+volatile bool events_enabled = false;
+
+static VALUE events_subscribers = Qnil;
+static VALUE events_thread = Qnil;
+static double events_sample_rate = 1.0;
+static volatile uint32_t events_sample_threshold = UINT32_MAX;
+static uint32_t events_counter = 0;
+
+static pthread_mutex_t events_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t events_ready = PTHREAD_COND_INITIALIZER;
+static command_event events_buffer[EVENTS_BUFFER_SIZE];
+static uint32_t events_size = 0;
+static uint64_t events_dropped = 0;
+static bool events_interrupted = false;
+
+/*
+ * decide whether command should be reported, doesn't touch anything but a flag when nobody is subscribed
+ */
+bool events_sample()
+{
+    uint32_t hash;
+
+    if (!events_enabled) {
+        return false;
+    }
+    if (events_sample_threshold == UINT32_MAX) {
+        return true;
+    }
+
+    // multiplicative hash of the commands counter spreads sampled commands evenly
+    hash = __sync_add_and_fetch(&events_counter, 1) * 2654435761u;
+    return hash < events_sample_threshold;
+}
+
+/*
+ * buffer event for delivery thread, event is dropped when buffer is full
+ */
+void events_push(const command_event* event)
+{
+    pthread_mutex_lock(&events_lock);
+    if (events_size < EVENTS_BUFFER_SIZE) {
+        events_buffer[events_size++] = *event;
+        if (events_size >= EVENTS_BATCH_SIZE) {
+            pthread_cond_signal(&events_ready);
+        }
+    } else {
+        events_dropped++;
+    }
+    pthread_mutex_unlock(&events_lock);
+}
+
+static uint64_t events_val_size(const as_val* value);
+
+static bool events_list_size_callback(as_val* value, void* udata)
+{
+    *(uint64_t*) udata += events_val_size(value);
+    return true;
+}
+
+static bool events_map_size_callback(const as_val* key, const as_val* value, void* udata)
+{
+    *(uint64_t*) udata += events_val_size(key) + events_val_size(value);
+    return true;
+}
+
+/*
+ * approximate payload size of the value, wire overhead is not counted
+ */
+static uint64_t events_val_size(const as_val* value)
+{
+    uint64_t size = 0;
+
+    if (value == NULL) {
+        return 0;
+    }
+
+    switch(as_val_type(value)) {
+    case AS_BOOLEAN:
+        return 1;
+    case AS_INTEGER:
+    case AS_DOUBLE:
+        return 8;
+    case AS_STRING:
+        return as_string_len((as_string*) value);
+    case AS_BYTES:
+        return as_bytes_size((as_bytes*) value);
+#ifdef HAVE_AEROSPIKE_AS_GEOJSON_H
+    case AS_GEOJSON:
+        return strlen(as_geojson_get((as_geojson*) value));
+#endif
+    case AS_LIST:
+        as_list_foreach((as_list*) value, events_list_size_callback, &size);
+        return size;
+    case AS_MAP:
+        as_map_foreach((as_map*) value, events_map_size_callback, &size);
+        return size;
+    default:
+        return 0;
+    }
+}
+
+uint64_t events_record_size(const as_record* record)
+{
+    uint64_t size = 0;
+    uint16_t n;
+
+    if (record == NULL) {
+        return 0;
+    }
+
+    for(n = 0; n < record->bins.size; n++) {
+        size += strlen(record->bins.entries[n].name) + events_val_size((as_val*) record->bins.entries[n].valuep);
+    }
+
+    return size;
+}
+
+static VALUE events_event_hash(const command_event* event)
+{
+    VALUE vEvent = rb_hash_new();
+
+    rb_hash_aset(vEvent, rb_str_new2("command"), rb_str_new2(stats_command_name(event->command)));
+    rb_hash_aset(vEvent, rb_str_new2("namespace"), event->ns[0] == '\0' ? Qnil : rb_str_new2(event->ns));
+    rb_hash_aset(vEvent, rb_str_new2("set"), event->set[0] == '\0' ? Qnil : rb_str_new2(event->set));
+    rb_hash_aset(vEvent, rb_str_new2("digest"), event->has_digest ? rb_str_new((const char*) event->digest, AS_DIGEST_VALUE_SIZE) : Qnil);
+    rb_hash_aset(vEvent, rb_str_new2("bytes_sent"), ULL2NUM(event->bytes_sent));
+    rb_hash_aset(vEvent, rb_str_new2("bytes_received"), ULL2NUM(event->bytes_received));
+    rb_hash_aset(vEvent, rb_str_new2("records"), ULL2NUM(event->records));
+    rb_hash_aset(vEvent, rb_str_new2("result"), INT2FIX(event->status));
+    rb_hash_aset(vEvent, rb_str_new2("duration"), rb_float_new((event->network + event->conversion) / 1000.0));
+    rb_hash_aset(vEvent, rb_str_new2("network"), rb_float_new(event->network / 1000.0));
+    rb_hash_aset(vEvent, rb_str_new2("conversion"), rb_float_new(event->conversion / 1000.0));
+
+    return vEvent;
+}
+
+static VALUE events_call_subscriber(VALUE vArgs)
+{
+    VALUE vSubscriber = rb_ary_entry(vArgs, 0);
+    VALUE vEvents = rb_ary_entry(vArgs, 1);
+    long n;
+
+    for(n = 0; n < RARRAY_LEN(vEvents); n++) {
+        rb_funcall(vSubscriber, rb_intern("call"), 1, rb_ary_entry(vEvents, n));
+    }
+
+    return Qnil;
+}
+
+/*
+ * take buffered events and pass them to subscribers, must be called with GVL
+ */
+static void events_deliver()
+{
+    VALUE vEvents, vSubscribers;
+    command_event* events;
+    uint32_t size, n;
+    uint64_t dropped;
+    char sMsg[256];
+    long idx;
+    int state = 0;
+
+    pthread_mutex_lock(&events_lock);
+    size = events_size;
+    dropped = events_dropped;
+    events = size == 0 ? NULL : (command_event*) malloc(size * sizeof(command_event));
+    if (events != NULL) {
+        memcpy(events, events_buffer, size * sizeof(command_event));
+    }
+    events_size = 0;
+    events_dropped = 0;
+    pthread_mutex_unlock(&events_lock);
+
+    if (dropped > 0) {
+        snprintf(sMsg, sizeof(sMsg), "Aerospike instrumentation events dropped %llu", (unsigned long long) dropped);
+        rb_funcall(LoggerInstance, rb_intern("warn"), 1, rb_str_new2(sMsg));
+    }
+    if (events == NULL) {
+        return;
+    }
+
+    vEvents = rb_ary_new2(size);
+    for(n = 0; n < size; n++) {
+        rb_ary_push(vEvents, events_event_hash(&events[n]));
+    }
+    free(events);
+
+    vSubscribers = rb_ary_dup(events_subscribers);
+    for(idx = 0; idx < RARRAY_LEN(vSubscribers); idx++) {
+        // exception of one subscriber shouldn't stop delivery thread and other subscribers
+        rb_protect(events_call_subscriber, rb_assoc_new(rb_ary_entry(vSubscribers, idx), vEvents), &state);
+        if (state != 0) {
+            rb_set_errinfo(Qnil);
+            rb_funcall(LoggerInstance, rb_intern("error"), 1, rb_str_new2("Aerospike instrumentation subscriber raised exception"));
+        }
+    }
+}
+
+static void* events_wait_without_gvl(void* ptr)
+{
+    struct timespec deadline;
+
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_nsec += EVENTS_FLUSH_INTERVAL_MS * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    pthread_mutex_lock(&events_lock);
+    while (events_size < EVENTS_BATCH_SIZE && !events_interrupted) {
+        if (pthread_cond_timedwait(&events_ready, &events_lock, &deadline) == ETIMEDOUT) {
+            break;
+        }
+    }
+    events_interrupted = false;
+    pthread_mutex_unlock(&events_lock);
+
+    return NULL;
+}
+
+static void events_wait_interrupt(void* ptr)
+{
+    pthread_mutex_lock(&events_lock);
+    events_interrupted = true;
+    pthread_cond_broadcast(&events_ready);
+    pthread_mutex_unlock(&events_lock);
+}
+
+/*
+ * ruby thread which waits for a batch of events or flush interval without GVL and delivers them
+ */
+static VALUE events_thread_loop(void* ptr)
+{
+    while (true) {
+        rb_thread_call_without_gvl(events_wait_without_gvl, NULL, events_wait_interrupt, NULL);
+        events_deliver();
+    }
+
+    return Qnil;
+}
+
+/*
+ * call-seq:
+ *   subscribe { |event| ... } -> Proc
+ *
+ * subscribe to commands instrumentation, event is Hash with 'command', 'namespace', 'set', 'digest',
+ * 'bytes_sent', 'bytes_received', 'records', 'result' (status code) and 'duration', 'network', 'conversion'
+ * in microseconds. Events of sampled commands are buffered natively and passed to subscribers in batches
+ * from background ruby thread, returned Proc is a handle for unsubscribe
+ */
+VALUE events_subscribe(VALUE vSelf)
+{
+    VALUE vSubscriber;
+
+    if (!rb_block_given_p()) {
+        rb_raise(rb_eArgError, "Subscriber block is required");
+    }
+
+    vSubscriber = rb_block_proc();
+    rb_ary_push(events_subscribers, vSubscriber);
+
+    // thread doesn't survive fork, so it is started again in the child process
+    if (TYPE(events_thread) == T_NIL || !RTEST(rb_funcall(events_thread, rb_intern("alive?"), 0))) {
+        events_thread = rb_thread_create(events_thread_loop, NULL);
+    }
+    events_enabled = true;
+
+    return vSubscriber;
+}
+
+/*
+ * call-seq:
+ *   unsubscribe(subscriber) -> true or false
+ *
+ * remove subscriber, events are not collected when nobody is subscribed
+ */
+VALUE events_unsubscribe(VALUE vSelf, VALUE vSubscriber)
+{
+    VALUE vDeleted = rb_ary_delete(events_subscribers, vSubscriber);
+
+    events_enabled = RARRAY_LEN(events_subscribers) > 0;
+
+    return TYPE(vDeleted) == T_NIL ? Qfalse : Qtrue;
+}
+
+/*
+ * call-seq:
+ *   flush_events -> nil
+ *
+ * deliver buffered events to subscribers in the current thread
+ */
+VALUE events_flush(VALUE vSelf)
+{
+    events_deliver();
+    return Qnil;
+}
+
+/*
+ * call-seq:
+ *   event_sample_rate -> Float
+ *
+ * fraction of commands which are reported to subscribers
+ */
+VALUE events_get_sample_rate(VALUE vSelf)
+{
+    return rb_float_new(events_sample_rate);
+}
+
+/*
+ * call-seq:
+ *   event_sample_rate = rate -> rate
+ *
+ * set fraction of commands which are reported to subscribers, from 0.0 to 1.0
+ */
+VALUE events_set_sample_rate(VALUE vSelf, VALUE vRate)
+{
+    double rate = NUM2DBL(vRate);
+
+    if (rate < 0.0 || rate > 1.0) {
+        rb_raise(rb_eArgError, "Incorrect sample rate (expected 0.0..1.0)");
+    }
+
+    events_sample_rate = rate;
+    events_sample_threshold = rate >= 1.0 ? UINT32_MAX : (uint32_t) (rate * UINT32_MAX);
+
+    return vRate;
+}
+
+void define_events()
+{
+    events_subscribers = rb_ary_new();
+    rb_global_variable(&events_subscribers);
+    rb_global_variable(&events_thread);
+
+    rb_define_singleton_method(AerospikeNativeClass, "subscribe", events_subscribe, 0);
+    rb_define_singleton_method(AerospikeNativeClass, "unsubscribe", events_unsubscribe, 1);
+    rb_define_singleton_method(AerospikeNativeClass, "flush_events", events_flush, 0);
+    rb_define_singleton_method(AerospikeNativeClass, "event_sample_rate", events_get_sample_rate, 0);
+    rb_define_singleton_method(AerospikeNativeClass, "event_sample_rate=", events_set_sample_rate, 1);
+}
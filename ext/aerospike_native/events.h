@@ -0,0 +1,34 @@
+#ifndef EVENTS_H
+#define EVENTS_H
+
+#include "aerospike_native.h"
+#include <pthread.h>
+#include <aerospike/as_key.h>
+#include <aerospike/as_record.h>
+
+#define EVENTS_BUFFER_SIZE 4096
+#define EVENTS_BATCH_SIZE 256
+#define EVENTS_FLUSH_INTERVAL_MS 100
+
+typedef struct command_event_s {
+    int command;
+    int status;
+    char ns[AS_NAMESPACE_MAX_SIZE];
+    char set[AS_SET_MAX_SIZE];
+    uint8_t digest[AS_DIGEST_VALUE_SIZE];
+    bool has_digest;
+    uint64_t bytes_sent;
+    uint64_t bytes_received;
+    uint64_t records;
+    uint64_t network;
+    uint64_t conversion;
+} command_event;
+
+RUBY_EXTERN volatile bool events_enabled;
+
+void define_events();
+bool events_sample();
+void events_push(const command_event* event);
+uint64_t events_record_size(const as_record* record);
+
+#endif // EVENTS_H
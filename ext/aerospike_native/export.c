@@ -0,0 +1,742 @@
+#include "export.h"
+#include "import.h"
+#include <math.h>
+#include <aerospike/as_arraylist.h>
+#include <aerospike/as_hashmap.h>
+#include <aerospike/as_boolean.h>
+#include <aerospike/as_double.h>
+#ifdef HAVE_AEROSPIKE_AS_GEOJSON_H
+#include <aerospike/as_geojson.h>
+#endif
+
+void export_buffer_init(export_buffer* buffer)
+{
+    buffer->data = NULL;
+    buffer->size = 0;
+    buffer->capacity = 0;
+    buffer->failed = false;
+}
+
+void export_buffer_destroy(export_buffer* buffer)
+{
+    free(buffer->data);
+    export_buffer_init(buffer);
+}
+
+/*
+ * append bytes, buffer is marked as failed and ignores appends when it can't grow
+ */
+void export_buffer_append(export_buffer* buffer, const void* ptr, size_t size)
+{
+    if (buffer->failed) {
+        return;
+    }
+
+    if (buffer->size + size > buffer->capacity) {
+        size_t capacity = buffer->capacity == 0 ? 256 : buffer->capacity;
+        uint8_t* data;
+        while (buffer->size + size > capacity) {
+            capacity *= 2;
+        }
+        data = realloc(buffer->data, capacity);
+        if (data == NULL) {
+            buffer->failed = true;
+            return;
+        }
+        buffer->data = data;
+        buffer->capacity = capacity;
+    }
+
+    memcpy(buffer->data + buffer->size, ptr, size);
+    buffer->size += size;
+}
+
+static inline void export_buffer_byte(export_buffer* buffer, uint8_t value)
+{
+    export_buffer_append(buffer, &value, 1);
+}
+
+static inline void export_buffer_be(export_buffer* buffer, uint8_t prefix, uint64_t value, int size)
+{
+    uint8_t bytes[9];
+    int n;
+
+    bytes[0] = prefix;
+    for(n = 0; n < size; n++) {
+        bytes[size - n] = (uint8_t)(value >> (8 * n));
+    }
+    export_buffer_append(buffer, bytes, size + 1);
+}
+
+static inline void export_buffer_cstr(export_buffer* buffer, const char* value)
+{
+    export_buffer_append(buffer, value, strlen(value));
+}
+
+void export_msgpack_nil(export_buffer* buffer)
+{
+    export_buffer_byte(buffer, 0xc0);
+}
+
+void export_msgpack_bool(export_buffer* buffer, bool value)
+{
+    export_buffer_byte(buffer, value ? 0xc3 : 0xc2);
+}
+
+void export_msgpack_int(export_buffer* buffer, int64_t value)
+{
+    if (value >= 0) {
+        if (value < 128) {
+            export_buffer_byte(buffer, (uint8_t) value);
+        } else if (value <= UINT8_MAX) {
+            export_buffer_be(buffer, 0xcc, value, 1);
+        } else if (value <= UINT16_MAX) {
+            export_buffer_be(buffer, 0xcd, value, 2);
+        } else if (value <= UINT32_MAX) {
+            export_buffer_be(buffer, 0xce, value, 4);
+        } else {
+            export_buffer_be(buffer, 0xcf, value, 8);
+        }
+    } else {
+        if (value >= -32) {
+            export_buffer_byte(buffer, (uint8_t)(int8_t) value);
+        } else if (value >= INT8_MIN) {
+            export_buffer_be(buffer, 0xd0, (uint64_t) value, 1);
+        } else if (value >= INT16_MIN) {
+            export_buffer_be(buffer, 0xd1, (uint64_t) value, 2);
+        } else if (value >= INT32_MIN) {
+            export_buffer_be(buffer, 0xd2, (uint64_t) value, 4);
+        } else {
+            export_buffer_be(buffer, 0xd3, (uint64_t) value, 8);
+        }
+    }
+}
+
+void export_msgpack_double(export_buffer* buffer, double value)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    export_buffer_be(buffer, 0xcb, bits, 8);
+}
+
+void export_msgpack_str(export_buffer* buffer, const char* value, size_t size)
+{
+    if (size < 32) {
+        export_buffer_byte(buffer, 0xa0 | (uint8_t) size);
+    } else if (size <= UINT8_MAX) {
+        export_buffer_be(buffer, 0xd9, size, 1);
+    } else if (size <= UINT16_MAX) {
+        export_buffer_be(buffer, 0xda, size, 2);
+    } else {
+        export_buffer_be(buffer, 0xdb, size, 4);
+    }
+    export_buffer_append(buffer, value, size);
+}
+
+void export_msgpack_bin(export_buffer* buffer, const uint8_t* value, size_t size)
+{
+    if (size <= UINT8_MAX) {
+        export_buffer_be(buffer, 0xc4, size, 1);
+    } else if (size <= UINT16_MAX) {
+        export_buffer_be(buffer, 0xc5, size, 2);
+    } else {
+        export_buffer_be(buffer, 0xc6, size, 4);
+    }
+    export_buffer_append(buffer, value, size);
+}
+
+void export_msgpack_array(export_buffer* buffer, uint32_t size)
+{
+    if (size < 16) {
+        export_buffer_byte(buffer, 0x90 | (uint8_t) size);
+    } else if (size <= UINT16_MAX) {
+        export_buffer_be(buffer, 0xdc, size, 2);
+    } else {
+        export_buffer_be(buffer, 0xdd, size, 4);
+    }
+}
+
+void export_msgpack_map(export_buffer* buffer, uint32_t size)
+{
+    if (size < 16) {
+        export_buffer_byte(buffer, 0x80 | (uint8_t) size);
+    } else if (size <= UINT16_MAX) {
+        export_buffer_be(buffer, 0xde, size, 2);
+    } else {
+        export_buffer_be(buffer, 0xdf, size, 4);
+    }
+}
+
+static void export_json_str(export_buffer* buffer, const char* value, size_t size)
+{
+    static const char hex[] = "0123456789abcdef";
+    size_t n, begin = 0;
+
+    export_buffer_byte(buffer, '"');
+    for(n = 0; n < size; n++) {
+        uint8_t c = (uint8_t) value[n];
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+
+        export_buffer_append(buffer, value + begin, n - begin);
+        begin = n + 1;
+        switch(c) {
+        case '"':
+            export_buffer_cstr(buffer, "\\\"");
+            break;
+        case '\\':
+            export_buffer_cstr(buffer, "\\\\");
+            break;
+        case '\n':
+            export_buffer_cstr(buffer, "\\n");
+            break;
+        case '\r':
+            export_buffer_cstr(buffer, "\\r");
+            break;
+        case '\t':
+            export_buffer_cstr(buffer, "\\t");
+            break;
+        default: {
+            char escaped[7] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xf], '\0'};
+            export_buffer_cstr(buffer, escaped);
+        }
+        }
+    }
+    export_buffer_append(buffer, value + begin, size - begin);
+    export_buffer_byte(buffer, '"');
+}
+
+static void export_json_hex(export_buffer* buffer, const uint8_t* value, size_t size)
+{
+    static const char hex[] = "0123456789abcdef";
+    size_t n;
+
+    export_buffer_byte(buffer, '"');
+    for(n = 0; n < size; n++) {
+        char pair[2] = {hex[value[n] >> 4], hex[value[n] & 0xf]};
+        export_buffer_append(buffer, pair, 2);
+    }
+    export_buffer_byte(buffer, '"');
+}
+
+static void export_json_int(export_buffer* buffer, int64_t value)
+{
+    char str[24];
+    snprintf(str, sizeof(str), "%lld", (long long) value);
+    export_buffer_cstr(buffer, str);
+}
+
+static void export_json_double(export_buffer* buffer, double value)
+{
+    char str[32];
+
+    if (!isfinite(value)) {
+        export_buffer_cstr(buffer, "null");
+        return;
+    }
+    snprintf(str, sizeof(str), "%.17g", value);
+    export_buffer_cstr(buffer, str);
+}
+
+static inline uint64_t export_read_be(const uint8_t* p, int size)
+{
+    uint64_t value = 0;
+    int n;
+
+    for(n = 0; n < size; n++) {
+        value = (value << 8) | p[n];
+    }
+    return value;
+}
+
+/*
+ * transcode one msgpack value (bins of non-native types are stored as msgpack bytes) to json,
+ * returns false on malformed or truncated input
+ */
+static bool export_json_from_msgpack(export_buffer* buffer, const uint8_t** pp, const uint8_t* end)
+{
+    const uint8_t* p = *pp;
+    uint8_t type;
+    uint64_t size = 0;
+    int header = 0;
+    bool is_map = false;
+
+    if (p >= end) {
+        return false;
+    }
+
+    type = *p++;
+    if (type <= 0x7f) {
+        export_json_int(buffer, type);
+    } else if (type >= 0xe0) {
+        export_json_int(buffer, (int8_t) type);
+    } else if ((type & 0xe0) == 0xa0 || type == 0xd9 || type == 0xda || type == 0xdb
+            || type == 0xc4 || type == 0xc5 || type == 0xc6) {
+        bool is_str = (type & 0xe0) == 0xa0 || type >= 0xd9;
+        if ((type & 0xe0) == 0xa0) {
+            size = type & 0x1f;
+        } else {
+            header = (type == 0xd9 || type == 0xc4) ? 1 : (type == 0xda || type == 0xc5) ? 2 : 4;
+            if (p + header > end) {
+                return false;
+            }
+            size = export_read_be(p, header);
+            p += header;
+        }
+        if (p + size > end) {
+            return false;
+        }
+        if (is_str) {
+            export_json_str(buffer, (const char*) p, size);
+        } else {
+            export_json_hex(buffer, p, size);
+        }
+        p += size;
+    } else if ((type & 0xf0) == 0x90 || (type & 0xf0) == 0x80 || (type >= 0xdc && type <= 0xdf)) {
+        uint64_t n;
+        is_map = (type & 0xf0) == 0x80 || type == 0xde || type == 0xdf;
+        if (type < 0xa0) {
+            size = type & 0x0f;
+        } else {
+            header = (type == 0xdc || type == 0xde) ? 2 : 4;
+            if (p + header > end) {
+                return false;
+            }
+            size = export_read_be(p, header);
+            p += header;
+        }
+
+        export_buffer_byte(buffer, is_map ? '{' : '[');
+        for(n = 0; n < size; n++) {
+            if (n > 0) {
+                export_buffer_byte(buffer, ',');
+            }
+            if (is_map) {
+                // json keys are strings only
+                if (p < end && ((*p & 0xe0) == 0xa0 || (*p >= 0xd9 && *p <= 0xdb))) {
+                    if (!export_json_from_msgpack(buffer, &p, end)) {
+                        return false;
+                    }
+                } else {
+                    export_buffer t;
+                    export_buffer_init(&t);
+                    if (!export_json_from_msgpack(&t, &p, end)) {
+                        export_buffer_destroy(&t);
+                        return false;
+                    }
+                    export_json_str(buffer, (const char*) t.data, t.size);
+                    export_buffer_destroy(&t);
+                }
+                export_buffer_byte(buffer, ':');
+            }
+            if (!export_json_from_msgpack(buffer, &p, end)) {
+                return false;
+            }
+        }
+        export_buffer_byte(buffer, is_map ? '}' : ']');
+    } else {
+        switch(type) {
+        case 0xc0:
+            export_buffer_cstr(buffer, "null");
+            break;
+        case 0xc2:
+            export_buffer_cstr(buffer, "false");
+            break;
+        case 0xc3:
+            export_buffer_cstr(buffer, "true");
+            break;
+        case 0xcc: case 0xcd: case 0xce: case 0xcf:
+            header = 1 << (type - 0xcc);
+            if (p + header > end) {
+                return false;
+            }
+            if (header == 8) {
+                char str[24];
+                snprintf(str, sizeof(str), "%llu", (unsigned long long) export_read_be(p, 8));
+                export_buffer_cstr(buffer, str);
+            } else {
+                export_json_int(buffer, (int64_t) export_read_be(p, header));
+            }
+            p += header;
+            break;
+        case 0xd0: case 0xd1: case 0xd2: case 0xd3: {
+            uint64_t value;
+            header = 1 << (type - 0xd0);
+            if (p + header > end) {
+                return false;
+            }
+            value = export_read_be(p, header);
+            // sign extend
+            if (header < 8 && (value >> (header * 8 - 1)) & 1) {
+                value |= ~0ULL << (header * 8);
+            }
+            export_json_int(buffer, (int64_t) value);
+            p += header;
+            break;
+        }
+        case 0xca: {
+            uint32_t bits;
+            float value;
+            if (p + 4 > end) {
+                return false;
+            }
+            bits = (uint32_t) export_read_be(p, 4);
+            memcpy(&value, &bits, sizeof(value));
+            export_json_double(buffer, value);
+            p += 4;
+            break;
+        }
+        case 0xcb: {
+            uint64_t bits;
+            double value;
+            if (p + 8 > end) {
+                return false;
+            }
+            bits = export_read_be(p, 8);
+            memcpy(&value, &bits, sizeof(value));
+            export_json_double(buffer, value);
+            p += 8;
+            break;
+        }
+        default:
+            return false;
+        }
+    }
+
+    *pp = p;
+    return true;
+}
+
+typedef struct export_map_context_s {
+    export_buffer* buffer;
+    int format;
+    bool first;
+} export_map_context;
+
+static void export_value(export_buffer* buffer, int format, const as_val* value);
+
+static bool export_map_foreach(const as_val* key, const as_val* value, void* udata)
+{
+    export_map_context* context = (export_map_context*) udata;
+
+    if (context->format == EXPORT_FORMAT_NDJSON) {
+        if (!context->first) {
+            export_buffer_byte(context->buffer, ',');
+        }
+        if (as_val_type(key) == AS_STRING) {
+            export_value(context->buffer, context->format, key);
+        } else {
+            export_buffer t;
+            export_buffer_init(&t);
+            export_value(&t, context->format, key);
+            export_json_str(context->buffer, (const char*) t.data, t.size);
+            export_buffer_destroy(&t);
+        }
+        export_buffer_byte(context->buffer, ':');
+    } else {
+        export_value(context->buffer, context->format, key);
+    }
+    export_value(context->buffer, context->format, value);
+    context->first = false;
+
+    return true;
+}
+
+static void export_value(export_buffer* buffer, int format, const as_val* value)
+{
+    bool json = format == EXPORT_FORMAT_NDJSON;
+
+    if (value == NULL) {
+        json ? export_buffer_cstr(buffer, "null") : export_msgpack_nil(buffer);
+        return;
+    }
+
+    switch(as_val_type(value)) {
+    case AS_BOOLEAN: {
+        bool b = as_boolean_get(as_boolean_fromval(value));
+        json ? export_buffer_cstr(buffer, b ? "true" : "false") : export_msgpack_bool(buffer, b);
+        break;
+    }
+    case AS_INTEGER: {
+        int64_t i = as_integer_get(as_integer_fromval(value));
+        json ? export_json_int(buffer, i) : export_msgpack_int(buffer, i);
+        break;
+    }
+    case AS_DOUBLE: {
+        double d = as_double_get(as_double_fromval(value));
+        json ? export_json_double(buffer, d) : export_msgpack_double(buffer, d);
+        break;
+    }
+    case AS_STRING: {
+        const char* str = as_string_get(as_string_fromval(value));
+        json ? export_json_str(buffer, str, strlen(str)) : export_msgpack_str(buffer, str, strlen(str));
+        break;
+    }
+#ifdef HAVE_AEROSPIKE_AS_GEOJSON_H
+    case AS_GEOJSON: {
+        const char* str = as_geojson_get(as_geojson_fromval(value));
+        json ? export_buffer_append(buffer, str, strlen(str)) : export_msgpack_str(buffer, str, strlen(str));
+        break;
+    }
+#endif
+    case AS_BYTES: {
+        // non-native ruby objects are stored as msgpack blobs, hll, bitmaps and foreign blobs are written as binary
+        as_bytes* bytes = as_bytes_fromval(value);
+        const uint8_t* p = as_bytes_get(bytes);
+        const uint8_t* end = p + as_bytes_size(bytes);
+        bool blob = as_bytes_get_type(bytes) == AS_BYTES_BLOB;
+        if (json) {
+            export_buffer t;
+            export_buffer_init(&t);
+            if (blob && export_json_from_msgpack(&t, &p, end) && p == end) {
+                export_buffer_append(buffer, t.data, t.size);
+            } else {
+                export_json_hex(buffer, as_bytes_get(bytes), as_bytes_size(bytes));
+            }
+            export_buffer_destroy(&t);
+        } else if (blob && p < end && import_msgpack_skip(p, end) == end - p) {
+            export_buffer_append(buffer, p, end - p);
+        } else {
+            export_msgpack_bin(buffer, p, end - p);
+        }
+        break;
+    }
+    case AS_LIST: {
+        as_list* list = as_list_fromval(value);
+        uint32_t n, size = as_list_size(list);
+        if (json) {
+            export_buffer_byte(buffer, '[');
+        } else {
+            export_msgpack_array(buffer, size);
+        }
+        for(n = 0; n < size; n++) {
+            if (json && n > 0) {
+                export_buffer_byte(buffer, ',');
+            }
+            export_value(buffer, format, as_list_get(list, n));
+        }
+        if (json) {
+            export_buffer_byte(buffer, ']');
+        }
+        break;
+    }
+    case AS_MAP: {
+        as_map* map = as_map_fromval(value);
+        export_map_context context = {buffer, format, true};
+        if (json) {
+            export_buffer_byte(buffer, '{');
+        } else {
+            export_msgpack_map(buffer, as_map_size(map));
+        }
+        as_map_foreach(map, export_map_foreach, &context);
+        if (json) {
+            export_buffer_byte(buffer, '}');
+        }
+        break;
+    }
+    default:
+        json ? export_buffer_cstr(buffer, "null") : export_msgpack_nil(buffer);
+        break;
+    }
+}
+
+static void export_key(export_buffer* buffer, const char* key, int format, bool first)
+{
+    if (format == EXPORT_FORMAT_NDJSON) {
+        if (!first) {
+            export_buffer_byte(buffer, ',');
+        }
+        export_json_str(buffer, key, strlen(key));
+        export_buffer_byte(buffer, ':');
+    } else {
+        export_msgpack_str(buffer, key, strlen(key));
+    }
+}
+
+/*
+ * record layout: {"ns", "set", "digest", "key", "gen", "ttl", "bins" => {name => value}},
+ * msgpack map or json object on separate line
+ */
+static void export_record(export_buffer* buffer, int format, const as_record* record)
+{
+    bool json = format == EXPORT_FORMAT_NDJSON;
+    uint16_t n;
+
+    if (json) {
+        export_buffer_byte(buffer, '{');
+    } else {
+        export_msgpack_map(buffer, 7);
+    }
+
+    export_key(buffer, "ns", format, true);
+    json ? export_json_str(buffer, record->key.ns, strlen(record->key.ns)) : export_msgpack_str(buffer, record->key.ns, strlen(record->key.ns));
+    export_key(buffer, "set", format, false);
+    json ? export_json_str(buffer, record->key.set, strlen(record->key.set)) : export_msgpack_str(buffer, record->key.set, strlen(record->key.set));
+    export_key(buffer, "digest", format, false);
+    json ? export_json_hex(buffer, record->key.digest.value, AS_DIGEST_VALUE_SIZE) : export_msgpack_bin(buffer, record->key.digest.value, AS_DIGEST_VALUE_SIZE);
+    export_key(buffer, "key", format, false);
+    export_value(buffer, format, (as_val*) record->key.valuep);
+    export_key(buffer, "gen", format, false);
+    json ? export_json_int(buffer, record->gen) : export_msgpack_int(buffer, record->gen);
+    export_key(buffer, "ttl", format, false);
+    json ? export_json_int(buffer, record->ttl) : export_msgpack_int(buffer, record->ttl);
+
+    export_key(buffer, "bins", format, false);
+    if (json) {
+        export_buffer_byte(buffer, '{');
+    } else {
+        export_msgpack_map(buffer, record->bins.size);
+    }
+    for(n = 0; n < record->bins.size; n++) {
+        as_bin* bin = &record->bins.entries[n];
+        export_key(buffer, bin->name, format, n == 0);
+        export_value(buffer, format, (as_val*) bin->valuep);
+    }
+
+    if (json) {
+        export_buffer_cstr(buffer, "}}\n");
+    }
+}
+
+static bool export_writer_flush(export_writer* writer)
+{
+    size_t written;
+
+    if (writer->buffer.size == 0 || writer->failed) {
+        return !writer->failed;
+    }
+
+#ifdef HAVE_ZLIB_H
+    if (writer->gz_file != NULL) {
+        written = gzwrite(writer->gz_file, writer->buffer.data, writer->buffer.size) > 0 ? writer->buffer.size : 0;
+    } else
+#endif
+    {
+        written = fwrite(writer->buffer.data, 1, writer->buffer.size, writer->file);
+    }
+
+    if (written != writer->buffer.size) {
+        writer->failed = true;
+        writer->error = errno ? errno : EIO;
+        return false;
+    }
+
+    writer->buffer.size = 0;
+    return true;
+}
+
+/*
+ * returns 0 on success or errno
+ */
+int export_writer_open(export_writer* writer, const char* path, int format, bool compress, query_data* data)
+{
+    writer->format = format;
+    writer->file = NULL;
+#ifdef HAVE_ZLIB_H
+    writer->gz_file = NULL;
+#endif
+    writer->data = data;
+    writer->records = 0;
+    writer->cancelled = false;
+    writer->failed = false;
+    writer->error = 0;
+    export_buffer_init(&writer->buffer);
+
+    if (compress) {
+#ifdef HAVE_ZLIB_H
+        writer->gz_file = gzopen(path, "wb");
+        if (writer->gz_file == NULL) {
+            return errno ? errno : EIO;
+        }
+#else
+        return ENOTSUP;
+#endif
+    } else {
+        writer->file = fopen(path, "wb");
+        if (writer->file == NULL) {
+            return errno;
+        }
+    }
+
+    pthread_mutex_init(&writer->lock, NULL);
+    return 0;
+}
+
+/*
+ * flush buffer and close file, returns 0 on success or errno of first failure
+ */
+int export_writer_close(export_writer* writer)
+{
+    export_writer_flush(writer);
+
+#ifdef HAVE_ZLIB_H
+    if (writer->gz_file != NULL) {
+        if (gzclose(writer->gz_file) != Z_OK && !writer->failed) {
+            writer->failed = true;
+            writer->error = EIO;
+        }
+    }
+#endif
+    if (writer->file != NULL) {
+        if (fclose(writer->file) != 0 && !writer->failed) {
+            writer->failed = true;
+            writer->error = errno;
+        }
+    }
+
+    export_buffer_destroy(&writer->buffer);
+    pthread_mutex_destroy(&writer->lock);
+
+    return writer->failed ? writer->error : 0;
+}
+
+/*
+ * scan callback, runs without GVL and encodes as_record directly into file buffer
+ */
+bool export_callback(const as_val* value, void* udata)
+{
+    export_writer* writer = (export_writer*) udata;
+    as_record* record;
+    bool result = true;
+
+    if (value == NULL) {
+        // scan is complete
+        return true;
+    }
+
+    if (writer->cancelled || writer->failed) {
+        return false;
+    }
+
+    if (as_val_type(value) != AS_REC || (record = as_record_fromval(value)) == NULL) {
+        return true;
+    }
+
+    query_throttle(writer->data, __sync_add_and_fetch(&writer->data->records_scanned, 1));
+    if (!query_record_match(writer->data, record)) {
+        return true;
+    }
+    if (!query_record_accept(writer->data)) {
+        return false;
+    }
+
+    pthread_mutex_lock(&writer->lock);
+    export_record(&writer->buffer, writer->format, record);
+    if (writer->buffer.failed) {
+        // partially encoded record can't be written, so scan is aborted
+        if (!writer->failed) {
+            writer->failed = true;
+            writer->error = ENOMEM;
+        }
+        result = false;
+    } else {
+        writer->records++;
+        if (writer->buffer.size >= EXPORT_BUFFER_SIZE) {
+            result = export_writer_flush(writer);
+        }
+    }
+    pthread_mutex_unlock(&writer->lock);
+
+    return result && query_record_continue(writer->data);
+}
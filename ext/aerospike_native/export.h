@@ -0,0 +1,58 @@
+#ifndef EXPORT_H
+#define EXPORT_H
+
+#include "aerospike_native.h"
+#include "query.h"
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#ifdef HAVE_ZLIB_H
+#include <zlib.h>
+#endif
+
+#define EXPORT_BUFFER_SIZE (1024 * 1024)
+
+enum ExportFormat {
+    EXPORT_FORMAT_MSGPACK,
+    EXPORT_FORMAT_NDJSON
+};
+
+typedef struct export_buffer_s {
+    uint8_t* data;
+    size_t size;
+    size_t capacity;
+    bool failed;
+} export_buffer;
+
+typedef struct export_writer_s {
+    int format;
+    FILE* file;
+#ifdef HAVE_ZLIB_H
+    gzFile gz_file;
+#endif
+    export_buffer buffer;
+    query_data* data;
+    uint64_t records;
+    pthread_mutex_t lock;
+    volatile bool cancelled;
+    bool failed;
+    int error;
+} export_writer;
+
+void export_buffer_init(export_buffer* buffer);
+void export_buffer_destroy(export_buffer* buffer);
+void export_buffer_append(export_buffer* buffer, const void* ptr, size_t size);
+void export_msgpack_nil(export_buffer* buffer);
+void export_msgpack_bool(export_buffer* buffer, bool value);
+void export_msgpack_int(export_buffer* buffer, int64_t value);
+void export_msgpack_double(export_buffer* buffer, double value);
+void export_msgpack_str(export_buffer* buffer, const char* value, size_t size);
+void export_msgpack_bin(export_buffer* buffer, const uint8_t* value, size_t size);
+void export_msgpack_array(export_buffer* buffer, uint32_t size);
+void export_msgpack_map(export_buffer* buffer, uint32_t size);
+
+int export_writer_open(export_writer* writer, const char* path, int format, bool compress, query_data* data);
+int export_writer_close(export_writer* writer);
+bool export_callback(const as_val* value, void* udata);
+
+#endif // EXPORT_H
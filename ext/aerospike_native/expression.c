@@ -0,0 +1,397 @@
+#include "expression.h"
+
+VALUE ExpressionClass;
+
+/*
+ * call-seq:
+ *   new(exp_type, args) -> AerospikeNative::Exp
+ *
+ * initialize new filter expression node, prefer Exp.bin, Exp.eq, Exp.gt etc.
+ */
+VALUE expression_initialize(VALUE vSelf, VALUE vExpType, VALUE vArgs)
+{
+    Check_Type(vExpType, T_FIXNUM);
+    Check_Type(vArgs, T_ARRAY);
+
+    rb_iv_set(vSelf, "@exp_type", vExpType);
+    rb_iv_set(vSelf, "@args", rb_ary_freeze(vArgs));
+
+    return vSelf;
+}
+
+void check_aerospike_expression(VALUE vExp)
+{
+    char sName[] = "AerospikeNative::Exp";
+
+    if (strcmp(sName, rb_obj_classname(vExp)) != 0) {
+        rb_raise(rb_eArgError, "Incorrect type (expected %s)", sName);
+    }
+}
+
+static VALUE expression_new(int exp_type, VALUE vArgs)
+{
+    VALUE vParams[2];
+
+    vParams[0] = INT2FIX(exp_type);
+    vParams[1] = vArgs;
+    return rb_class_new_instance(2, vParams, ExpressionClass);
+}
+
+static VALUE expression_operand(VALUE vOperand)
+{
+    switch(TYPE(vOperand)) {
+    case T_FIXNUM:
+        return expression_new(EXPRESSION_VALUE, rb_ary_new3(1, vOperand));
+    case T_SYMBOL:
+    case T_STRING:
+        GET_STRING(vOperand);
+        return expression_new(EXPRESSION_VALUE, rb_ary_new3(1, rb_str_new_frozen(vOperand)));
+    default:
+        check_aerospike_expression(vOperand);
+        return vOperand;
+    }
+}
+
+static VALUE expression_compare(int exp_type, VALUE vLeft, VALUE vRight)
+{
+    return expression_new(exp_type, rb_ary_new3(2, expression_operand(vLeft), expression_operand(vRight)));
+}
+
+static VALUE expression_logical(int exp_type, int argc, VALUE* vArgs)
+{
+    VALUE vExps;
+    int n;
+
+    if (argc < 1) {
+        rb_raise(rb_eArgError, "wrong number of arguments (%d for 1..n)", argc);
+    }
+
+    vExps = rb_ary_new_capa(argc);
+    for(n = 0; n < argc; n++) {
+        check_aerospike_expression(vArgs[n]);
+        rb_ary_push(vExps, vArgs[n]);
+    }
+
+    return expression_new(exp_type, vExps);
+}
+
+/*
+ * call-seq:
+ *   bin(bin_name) -> AerospikeNative::Exp
+ *
+ * bin value of the scanned record
+ */
+VALUE expression_bin(VALUE vSelf, VALUE vBinName)
+{
+    GET_STRING(vBinName);
+    if (RSTRING_LEN(vBinName) >= AS_BIN_NAME_MAX_SIZE) {
+        rb_raise(rb_eArgError, "bin name is too long (max %d)", AS_BIN_NAME_MAX_LEN);
+    }
+    return expression_new(EXPRESSION_BIN, rb_ary_new3(1, rb_str_new_frozen(vBinName)));
+}
+
+/*
+ * call-seq:
+ *   eq(left, right) -> AerospikeNative::Exp
+ *   ne(left, right) -> AerospikeNative::Exp
+ *   gt(left, right) -> AerospikeNative::Exp
+ *   ge(left, right) -> AerospikeNative::Exp
+ *   lt(left, right) -> AerospikeNative::Exp
+ *   le(left, right) -> AerospikeNative::Exp
+ *
+ * compare bin with Fixnum or String (eq and ne only), comparisons are evaluated by server
+ */
+VALUE expression_eq(VALUE vSelf, VALUE vLeft, VALUE vRight)
+{
+    return expression_compare(EXPRESSION_EQ, vLeft, vRight);
+}
+
+VALUE expression_ne(VALUE vSelf, VALUE vLeft, VALUE vRight)
+{
+    return expression_compare(EXPRESSION_NE, vLeft, vRight);
+}
+
+VALUE expression_gt(VALUE vSelf, VALUE vLeft, VALUE vRight)
+{
+    return expression_compare(EXPRESSION_GT, vLeft, vRight);
+}
+
+VALUE expression_ge(VALUE vSelf, VALUE vLeft, VALUE vRight)
+{
+    return expression_compare(EXPRESSION_GE, vLeft, vRight);
+}
+
+VALUE expression_lt(VALUE vSelf, VALUE vLeft, VALUE vRight)
+{
+    return expression_compare(EXPRESSION_LT, vLeft, vRight);
+}
+
+VALUE expression_le(VALUE vSelf, VALUE vLeft, VALUE vRight)
+{
+    return expression_compare(EXPRESSION_LE, vLeft, vRight);
+}
+
+/*
+ * call-seq:
+ *   and(exp1, exp2, ...) -> AerospikeNative::Exp
+ *   or(exp1, exp2, ...) -> AerospikeNative::Exp
+ *   not(exp) -> AerospikeNative::Exp
+ *
+ * logical operations
+ */
+VALUE expression_and(int argc, VALUE* vArgs, VALUE vSelf)
+{
+    return expression_logical(EXPRESSION_AND, argc, vArgs);
+}
+
+VALUE expression_or(int argc, VALUE* vArgs, VALUE vSelf)
+{
+    return expression_logical(EXPRESSION_OR, argc, vArgs);
+}
+
+VALUE expression_not(VALUE vSelf, VALUE vExp)
+{
+    return expression_logical(EXPRESSION_NOT, 1, &vExp);
+}
+
+/*
+ * call-seq:
+ *   exp & other -> AerospikeNative::Exp
+ *   exp | other -> AerospikeNative::Exp
+ *   exp.not -> AerospikeNative::Exp
+ */
+VALUE expression_op_and(VALUE vSelf, VALUE vOther)
+{
+    VALUE vArgs[2] = {vSelf, vOther};
+    return expression_logical(EXPRESSION_AND, 2, vArgs);
+}
+
+VALUE expression_op_or(VALUE vSelf, VALUE vOther)
+{
+    VALUE vArgs[2] = {vSelf, vOther};
+    return expression_logical(EXPRESSION_OR, 2, vArgs);
+}
+
+VALUE expression_op_not(VALUE vSelf)
+{
+    return expression_logical(EXPRESSION_NOT, 1, &vSelf);
+}
+
+static bool expression_is_leaf(int exp_type)
+{
+    return exp_type == EXPRESSION_BIN || exp_type == EXPRESSION_VALUE;
+}
+
+/*
+ * server predicate compares bin with Fixnum (all operations) or String (eq and ne),
+ * returns bin and value operands and comparison type with swapped direction for value on the left
+ */
+static int expression_comparison(int exp_type, VALUE vArgs, VALUE* vBin, VALUE* vValue)
+{
+    VALUE vLeft = rb_ary_entry(vArgs, 0), vRight = rb_ary_entry(vArgs, 1);
+    int left_type = FIX2INT(rb_iv_get(vLeft, "@exp_type"));
+    int right_type = FIX2INT(rb_iv_get(vRight, "@exp_type"));
+
+    if (left_type == EXPRESSION_BIN && right_type == EXPRESSION_VALUE) {
+        *vBin = rb_ary_entry(rb_iv_get(vLeft, "@args"), 0);
+        *vValue = rb_ary_entry(rb_iv_get(vRight, "@args"), 0);
+    } else if (left_type == EXPRESSION_VALUE && right_type == EXPRESSION_BIN) {
+        *vBin = rb_ary_entry(rb_iv_get(vRight, "@args"), 0);
+        *vValue = rb_ary_entry(rb_iv_get(vLeft, "@args"), 0);
+        switch(exp_type) {
+        case EXPRESSION_GT:
+            exp_type = EXPRESSION_LT;
+            break;
+        case EXPRESSION_GE:
+            exp_type = EXPRESSION_LE;
+            break;
+        case EXPRESSION_LT:
+            exp_type = EXPRESSION_GT;
+            break;
+        case EXPRESSION_LE:
+            exp_type = EXPRESSION_GE;
+            break;
+        }
+    } else {
+        rb_raise(rb_eArgError, "Incorrect expression (comparison expects bin and value operands)");
+    }
+
+    switch(TYPE(*vValue)) {
+    case T_FIXNUM:
+        break;
+    case T_STRING:
+        if (exp_type != EXPRESSION_EQ && exp_type != EXPRESSION_NE) {
+            rb_raise(rb_eArgError, "Incorrect expression (strings can only be compared with eq and ne)");
+        }
+        break;
+    default:
+        rb_raise(rb_eArgError, "Incorrect expression (bins can only be compared with Fixnum or String)");
+    }
+
+    return exp_type;
+}
+
+#ifdef HAVE_AEROSPIKE_AS_PREDEXP_H
+static as_predexp_base* expression_predexp_comparison(int exp_type, bool is_string)
+{
+    switch(exp_type) {
+    case EXPRESSION_EQ:
+        return is_string ? as_predexp_string_equal() : as_predexp_integer_equal();
+    case EXPRESSION_NE:
+        return is_string ? as_predexp_string_unequal() : as_predexp_integer_unequal();
+    case EXPRESSION_GT:
+        return as_predexp_integer_greater();
+    case EXPRESSION_GE:
+        return as_predexp_integer_greatereq();
+    case EXPRESSION_LT:
+        return as_predexp_integer_less();
+    default:
+        return as_predexp_integer_lesseq();
+    }
+}
+#endif
+
+/*
+ * walk expression tree in postfix order, every node is one predicate expression.
+ * predexps is NULL when the tree is only checked
+ */
+static void expression_predexp_node(VALUE vExp, void* predexps, int* size)
+{
+    VALUE vArgs, vBin, vValue;
+    int n, idx, exp_type;
+
+    check_aerospike_expression(vExp);
+    vArgs = rb_iv_get(vExp, "@args");
+    idx = RARRAY_LEN(vArgs);
+    exp_type = FIX2INT(rb_iv_get(vExp, "@exp_type"));
+
+    switch(exp_type) {
+    case EXPRESSION_EQ:
+    case EXPRESSION_NE:
+    case EXPRESSION_GT:
+    case EXPRESSION_GE:
+    case EXPRESSION_LT:
+    case EXPRESSION_LE:
+        if (idx != 2) {
+            rb_raise(rb_eArgError, "Incorrect expression (comparison expects 2 operands)");
+        }
+        exp_type = expression_comparison(exp_type, vArgs, &vBin, &vValue);
+#ifdef HAVE_AEROSPIKE_AS_PREDEXP_H
+        if (predexps != NULL) {
+            as_predexp_base** entries = (as_predexp_base**) predexps;
+            bool is_string = TYPE(vValue) == T_STRING;
+
+            // bin name and value are copied by predicate expressions
+            entries[*size] = is_string ? as_predexp_string_bin(StringValueCStr(vBin)) : as_predexp_integer_bin(StringValueCStr(vBin));
+            entries[*size + 1] = is_string ? as_predexp_string_value(StringValueCStr(vValue)) : as_predexp_integer_value(FIX2LONG(vValue));
+            entries[*size + 2] = expression_predexp_comparison(exp_type, is_string);
+        }
+#endif
+        *size += 3;
+        return;
+    case EXPRESSION_AND:
+    case EXPRESSION_OR:
+        if (idx < 1 || idx > UINT16_MAX) {
+            rb_raise(rb_eArgError, "Incorrect expression (wrong number of logical operands)");
+        }
+        break;
+    case EXPRESSION_NOT:
+        if (idx != 1) {
+            rb_raise(rb_eArgError, "Incorrect expression (not expects 1 operand)");
+        }
+        break;
+    case EXPRESSION_BIN:
+    case EXPRESSION_VALUE:
+        rb_raise(rb_eArgError, "Incorrect expression (bin or value should be compared)");
+    default:
+        rb_raise(rb_eArgError, "Incorrect expression type");
+    }
+
+    for(n = 0; n < idx; n++) {
+        VALUE vOperand = rb_ary_entry(vArgs, n);
+        check_aerospike_expression(vOperand);
+        if (expression_is_leaf(FIX2INT(rb_iv_get(vOperand, "@exp_type")))) {
+            rb_raise(rb_eArgError, "Incorrect expression (logical operation expects conditions)");
+        }
+        expression_predexp_node(vOperand, predexps, size);
+    }
+
+#ifdef HAVE_AEROSPIKE_AS_PREDEXP_H
+    if (predexps != NULL) {
+        as_predexp_base** entries = (as_predexp_base**) predexps;
+        switch(exp_type) {
+        case EXPRESSION_AND:
+            entries[*size] = as_predexp_and((uint16_t) idx);
+            break;
+        case EXPRESSION_OR:
+            entries[*size] = as_predexp_or((uint16_t) idx);
+            break;
+        default:
+            entries[*size] = as_predexp_not();
+            break;
+        }
+    }
+#endif
+    *size += 1;
+}
+
+/*
+ * check that expression can be evaluated by server and return number of its predicate expressions,
+ * raises ArgumentError otherwise
+ */
+int expression_predexp_size(VALUE vExp)
+{
+    int size = 0;
+
+    expression_predexp_node(vExp, NULL, &size);
+    if (size > UINT16_MAX) {
+        rb_raise(rb_eArgError, "Incorrect expression (too many conditions)");
+    }
+
+    return size;
+}
+
+#ifdef HAVE_AEROSPIKE_AS_PREDEXP_H
+/*
+ * build predicate expressions of checked expression, predexps should have expression_predexp_size(vExp) entries
+ */
+void expression_predexp(VALUE vExp, as_predexp_base** predexps)
+{
+    int size = 0;
+
+    expression_predexp_node(vExp, predexps, &size);
+}
+#endif
+
+void define_expression()
+{
+    ExpressionClass = rb_define_class_under(AerospikeNativeClass, "Exp", rb_cObject);
+    rb_define_method(ExpressionClass, "initialize", expression_initialize, 2);
+    rb_define_method(ExpressionClass, "&", expression_op_and, 1);
+    rb_define_method(ExpressionClass, "|", expression_op_or, 1);
+    rb_define_method(ExpressionClass, "not", expression_op_not, 0);
+    rb_define_singleton_method(ExpressionClass, "bin", expression_bin, 1);
+    rb_define_singleton_method(ExpressionClass, "eq", expression_eq, 2);
+    rb_define_singleton_method(ExpressionClass, "ne", expression_ne, 2);
+    rb_define_singleton_method(ExpressionClass, "gt", expression_gt, 2);
+    rb_define_singleton_method(ExpressionClass, "ge", expression_ge, 2);
+    rb_define_singleton_method(ExpressionClass, "lt", expression_lt, 2);
+    rb_define_singleton_method(ExpressionClass, "le", expression_le, 2);
+    rb_define_singleton_method(ExpressionClass, "and", expression_and, -1);
+    rb_define_singleton_method(ExpressionClass, "or", expression_or, -1);
+    rb_define_singleton_method(ExpressionClass, "not", expression_not, 1);
+    rb_define_attr(ExpressionClass, "exp_type", 1, 0);
+    rb_define_attr(ExpressionClass, "args", 1, 0);
+
+    rb_define_const(ExpressionClass, "BIN", INT2FIX(EXPRESSION_BIN));
+    rb_define_const(ExpressionClass, "VALUE", INT2FIX(EXPRESSION_VALUE));
+    rb_define_const(ExpressionClass, "EQ", INT2FIX(EXPRESSION_EQ));
+    rb_define_const(ExpressionClass, "NE", INT2FIX(EXPRESSION_NE));
+    rb_define_const(ExpressionClass, "GT", INT2FIX(EXPRESSION_GT));
+    rb_define_const(ExpressionClass, "GE", INT2FIX(EXPRESSION_GE));
+    rb_define_const(ExpressionClass, "LT", INT2FIX(EXPRESSION_LT));
+    rb_define_const(ExpressionClass, "LE", INT2FIX(EXPRESSION_LE));
+    rb_define_const(ExpressionClass, "AND", INT2FIX(EXPRESSION_AND));
+    rb_define_const(ExpressionClass, "OR", INT2FIX(EXPRESSION_OR));
+    rb_define_const(ExpressionClass, "NOT", INT2FIX(EXPRESSION_NOT));
+}
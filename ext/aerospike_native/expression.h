@@ -0,0 +1,32 @@
+#ifndef EXPRESSION_H
+#define EXPRESSION_H
+
+#include "aerospike_native.h"
+#ifdef HAVE_AEROSPIKE_AS_PREDEXP_H
+#include <aerospike/as_predexp.h>
+#endif
+
+RUBY_EXTERN VALUE ExpressionClass;
+void define_expression();
+
+enum ExpressionType {
+    EXPRESSION_BIN,
+    EXPRESSION_VALUE,
+    EXPRESSION_EQ,
+    EXPRESSION_NE,
+    EXPRESSION_GT,
+    EXPRESSION_GE,
+    EXPRESSION_LT,
+    EXPRESSION_LE,
+    EXPRESSION_AND,
+    EXPRESSION_OR,
+    EXPRESSION_NOT
+};
+
+void check_aerospike_expression(VALUE vExp);
+int expression_predexp_size(VALUE vExp);
+#ifdef HAVE_AEROSPIKE_AS_PREDEXP_H
+void expression_predexp(VALUE vExp, as_predexp_base** predexps);
+#endif
+
+#endif // EXPRESSION_H
@@ -5,6 +5,11 @@ extension_name = 'aerospike_native'
 find_executable('make')
 find_executable('git')
 have_library('crypto')
+have_header('openssl/sha.h')
+have_library('pthread')
+have_library('m')
+have_header('zlib.h') if have_library('z', 'gzopen', 'zlib.h')
+have_header('sys/sdt.h')
 #have_library('libc')
 #have_library('openssl')
 
@@ -34,4 +39,18 @@ libs.each do |lib|
   $LOCAL_LIBS << "#{lib} "
 end
 
+# optional features of aerospike client library
+have_header('aerospike/as_geojson.h')
+have_header('aerospike/as_predexp.h')
+have_func('as_scan_predexp_add', ['aerospike/as_scan.h'])
+have_func('as_predexp_rec_digest_modulo', ['aerospike/as_scan.h', 'aerospike/as_predexp.h'])
+have_func('aerospike_index_create_complex', ['aerospike/aerospike.h', 'aerospike/aerospike_index.h'])
+have_header('aerospike/as_cdt_ctx.h')
+have_func('as_operations_add_list_append', ['aerospike/as_operations.h'])
+have_func('as_operations_add_incr_double', ['aerospike/as_operations.h'])
+have_header('aerospike/as_hll_operations.h')
+have_header('aerospike/as_bit_operations.h')
+have_struct_member('as_config', 'max_socket_idle', 'aerospike/as_config.h')
+have_struct_member('as_config', 'min_conns_per_node', 'aerospike/as_config.h')
+
 create_makefile(extension_name)
@@ -0,0 +1,137 @@
+#include "geo.h"
+
+VALUE GeoJSONClass;
+
+/*
+ * call-seq:
+ *   new(json) -> AerospikeNative::GeoJSON
+ *
+ * wrap GeoJSON string (or object responding to to_json) to store it as geojson bin
+ */
+VALUE geo_initialize(VALUE vSelf, VALUE vJson)
+{
+    if (TYPE(vJson) != T_STRING) {
+        rb_require("json");
+        vJson = rb_funcall(vJson, rb_intern("to_json"), 0);
+        Check_Type(vJson, T_STRING);
+    }
+
+    rb_iv_set(vSelf, "@value", rb_obj_freeze(rb_str_dup(vJson)));
+    return vSelf;
+}
+
+VALUE geo_to_s(VALUE vSelf)
+{
+    return rb_iv_get(vSelf, "@value");
+}
+
+VALUE geo_inspect(VALUE vSelf)
+{
+    VALUE vValue = rb_iv_get(vSelf, "@value");
+    return rb_sprintf("#<AerospikeNative::GeoJSON %s>", StringValueCStr(vValue));
+}
+
+VALUE geo_equal(VALUE vSelf, VALUE vOther)
+{
+    if (!is_aerospike_geojson(vOther)) {
+        return Qfalse;
+    }
+
+    return rb_str_equal(rb_iv_get(vSelf, "@value"), rb_iv_get(vOther, "@value"));
+}
+
+/*
+ * call-seq:
+ *   point(lng, lat) -> AerospikeNative::GeoJSON
+ */
+VALUE geo_point(VALUE vSelf, VALUE vLng, VALUE vLat)
+{
+    return rb_geojson_point(NUM2DBL(vLng), NUM2DBL(vLat));
+}
+
+/*
+ * call-seq:
+ *   circle(lng, lat, radius) -> AerospikeNative::GeoJSON
+ *
+ * AeroCircle region, radius in meters
+ */
+VALUE geo_circle(VALUE vSelf, VALUE vLng, VALUE vLat, VALUE vRadius)
+{
+    return rb_geojson_circle(NUM2DBL(vLng), NUM2DBL(vLat), NUM2DBL(vRadius));
+}
+
+/*
+ * call-seq:
+ *   polygon([[lng, lat], [lng, lat], ...]) -> AerospikeNative::GeoJSON
+ *
+ * polygon region, ring is closed automatically
+ */
+VALUE geo_polygon(VALUE vSelf, VALUE vPoints)
+{
+    VALUE vJson;
+    char buffer[64];
+    long n, size;
+
+    Check_Type(vPoints, T_ARRAY);
+    size = RARRAY_LEN(vPoints);
+    if (size < 3) {
+        rb_raise(rb_eArgError, "polygon should have at least 3 points");
+    }
+
+    vJson = rb_str_new2("{\"type\":\"Polygon\",\"coordinates\":[[");
+    for(n = 0; n <= size; n++) {
+        VALUE vPoint = rb_ary_entry(vPoints, n % size);
+        Check_Type(vPoint, T_ARRAY);
+        if (RARRAY_LEN(vPoint) != 2) {
+            rb_raise(rb_eArgError, "wrong point (expected [lng, lat])");
+        }
+        if (n == size && rb_equal(vPoint, rb_ary_entry(vPoints, size - 1))) {
+            break;
+        }
+        snprintf(buffer, sizeof(buffer), "%s[%.17g,%.17g]", n > 0 ? "," : "",
+                 NUM2DBL(rb_ary_entry(vPoint, 0)), NUM2DBL(rb_ary_entry(vPoint, 1)));
+        rb_str_cat2(vJson, buffer);
+    }
+    rb_str_cat2(vJson, "]]}");
+
+    return rb_class_new_instance(1, &vJson, GeoJSONClass);
+}
+
+VALUE rb_geojson_new(const char* json)
+{
+    VALUE vJson = rb_str_new2(json);
+    return rb_class_new_instance(1, &vJson, GeoJSONClass);
+}
+
+VALUE rb_geojson_point(double lng, double lat)
+{
+    char buffer[96];
+    snprintf(buffer, sizeof(buffer), "{\"type\":\"Point\",\"coordinates\":[%.17g,%.17g]}", lng, lat);
+    return rb_geojson_new(buffer);
+}
+
+VALUE rb_geojson_circle(double lng, double lat, double radius)
+{
+    char buffer[128];
+    snprintf(buffer, sizeof(buffer), "{\"type\":\"AeroCircle\",\"coordinates\":[[%.17g,%.17g],%.17g]}", lng, lat, radius);
+    return rb_geojson_new(buffer);
+}
+
+bool is_aerospike_geojson(VALUE vValue)
+{
+    return RTEST(rb_obj_is_kind_of(vValue, GeoJSONClass));
+}
+
+void define_geo()
+{
+    GeoJSONClass = rb_define_class_under(AerospikeNativeClass, "GeoJSON", rb_cObject);
+    rb_define_method(GeoJSONClass, "initialize", geo_initialize, 1);
+    rb_define_method(GeoJSONClass, "to_s", geo_to_s, 0);
+    rb_define_method(GeoJSONClass, "inspect", geo_inspect, 0);
+    rb_define_method(GeoJSONClass, "==", geo_equal, 1);
+    rb_define_attr(GeoJSONClass, "value", 1, 0);
+
+    rb_define_singleton_method(GeoJSONClass, "point", geo_point, 2);
+    rb_define_singleton_method(GeoJSONClass, "circle", geo_circle, 3);
+    rb_define_singleton_method(GeoJSONClass, "polygon", geo_polygon, 1);
+}
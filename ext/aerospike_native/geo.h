@@ -0,0 +1,16 @@
+#ifndef GEO_H
+#define GEO_H
+
+#include "aerospike_native.h"
+#ifdef HAVE_AEROSPIKE_AS_GEOJSON_H
+#include <aerospike/as_geojson.h>
+#endif
+
+RUBY_EXTERN VALUE GeoJSONClass;
+void define_geo();
+bool is_aerospike_geojson(VALUE vValue);
+VALUE rb_geojson_new(const char* json);
+VALUE rb_geojson_point(double lng, double lat);
+VALUE rb_geojson_circle(double lng, double lat, double radius);
+
+#endif // GEO_H
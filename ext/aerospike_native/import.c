@@ -0,0 +1,1063 @@
+#include "import.h"
+#include "client.h"
+#include <sys/types.h>
+#include <time.h>
+#include <aerospike/aerospike_key.h>
+#include <aerospike/as_arraylist.h>
+#include <aerospike/as_hashmap.h>
+#include <aerospike/as_boolean.h>
+#include <aerospike/as_double.h>
+#include <aerospike/as_nil.h>
+#include <ruby/thread.h>
+
+/*
+ * returns size of msgpack value at begin, 0 when value is truncated, -1 when value is malformed
+ */
+ssize_t import_msgpack_skip(const uint8_t* begin, const uint8_t* end)
+{
+    const uint8_t* p = begin;
+    uint64_t pending = 1;
+
+    while (pending > 0) {
+        uint8_t type;
+        uint64_t size = 0;
+        int header = 0;
+
+        if (p >= end) {
+            return 0;
+        }
+
+        type = *p++;
+        pending--;
+
+        if (type <= 0x7f || type >= 0xe0 || type == 0xc0 || type == 0xc2 || type == 0xc3) {
+            continue;
+        } else if ((type & 0xe0) == 0xa0) {
+            size = type & 0x1f;
+        } else if ((type & 0xf0) == 0x90) {
+            pending += type & 0x0f;
+        } else if ((type & 0xf0) == 0x80) {
+            pending += (type & 0x0f) * 2;
+        } else {
+            switch(type) {
+            case 0xcc: case 0xd0:
+                size = 1;
+                break;
+            case 0xcd: case 0xd1: case 0xd4:
+                size = 2;
+                break;
+            case 0xd5:
+                size = 3;
+                break;
+            case 0xca: case 0xce: case 0xd2:
+                size = 4;
+                break;
+            case 0xd6:
+                size = 5;
+                break;
+            case 0xcb: case 0xcf: case 0xd3:
+                size = 8;
+                break;
+            case 0xd7:
+                size = 9;
+                break;
+            case 0xd8:
+                size = 17;
+                break;
+            case 0xc4: case 0xd9: case 0xc7:
+                header = 1;
+                break;
+            case 0xc5: case 0xda: case 0xc8: case 0xdc: case 0xde:
+                header = 2;
+                break;
+            case 0xc6: case 0xdb: case 0xc9: case 0xdd: case 0xdf:
+                header = 4;
+                break;
+            default:
+                return -1;
+            }
+
+            if (header > 0) {
+                uint64_t value = 0;
+                int n;
+
+                if (p + header > end) {
+                    return 0;
+                }
+                for(n = 0; n < header; n++) {
+                    value = (value << 8) | *p++;
+                }
+
+                if (type == 0xdc || type == 0xdd) {
+                    pending += value;
+                } else if (type == 0xde || type == 0xdf) {
+                    pending += value * 2;
+                } else if (type >= 0xc7 && type <= 0xc9) {
+                    size = value + 1; // ext type byte
+                } else {
+                    size = value;
+                }
+            }
+        }
+
+        if ((uint64_t)(end - p) < size) {
+            return 0;
+        }
+        p += size;
+    }
+
+    return p - begin;
+}
+
+static inline uint64_t import_read_be(const uint8_t** pp, int size)
+{
+    uint64_t value = 0;
+    int n;
+
+    for(n = 0; n < size; n++) {
+        value = (value << 8) | *(*pp)++;
+    }
+    return value;
+}
+
+static bool import_read_str(const uint8_t** pp, const uint8_t* end, const uint8_t** str, size_t* size)
+{
+    const uint8_t* p = *pp;
+    uint8_t type = *p++;
+    int header;
+
+    if ((type & 0xe0) == 0xa0) {
+        *size = type & 0x1f;
+    } else {
+        switch(type) {
+        case 0xd9: case 0xc4:
+            header = 1;
+            break;
+        case 0xda: case 0xc5:
+            header = 2;
+            break;
+        case 0xdb: case 0xc6:
+            header = 4;
+            break;
+        default:
+            return false;
+        }
+        *size = import_read_be(&p, header);
+    }
+
+    if ((size_t)(end - p) < *size) {
+        return false;
+    }
+
+    *str = p;
+    *pp = p + *size;
+    return true;
+}
+
+static bool import_read_int(const uint8_t** pp, int64_t* value)
+{
+    const uint8_t* p = *pp;
+    uint8_t type = *p++;
+
+    if (type <= 0x7f) {
+        *value = type;
+    } else if (type >= 0xe0) {
+        *value = (int8_t) type;
+    } else {
+        switch(type) {
+        case 0xcc:
+            *value = (uint8_t) import_read_be(&p, 1);
+            break;
+        case 0xcd:
+            *value = (uint16_t) import_read_be(&p, 2);
+            break;
+        case 0xce:
+            *value = (uint32_t) import_read_be(&p, 4);
+            break;
+        case 0xcf: {
+            uint64_t u = import_read_be(&p, 8);
+            if (u > INT64_MAX) {
+                return false;
+            }
+            *value = (int64_t) u;
+            break;
+        }
+        case 0xd0:
+            *value = (int8_t) import_read_be(&p, 1);
+            break;
+        case 0xd1:
+            *value = (int16_t) import_read_be(&p, 2);
+            break;
+        case 0xd2:
+            *value = (int32_t) import_read_be(&p, 4);
+            break;
+        case 0xd3:
+            *value = (int64_t) import_read_be(&p, 8);
+            break;
+        default:
+            return false;
+        }
+    }
+
+    *pp = p;
+    return true;
+}
+
+static bool import_read_map(const uint8_t** pp, uint32_t* size)
+{
+    const uint8_t* p = *pp;
+    uint8_t type = *p++;
+
+    if ((type & 0xf0) == 0x80) {
+        *size = type & 0x0f;
+    } else if (type == 0xde) {
+        *size = (uint32_t) import_read_be(&p, 2);
+    } else if (type == 0xdf) {
+        *size = (uint32_t) import_read_be(&p, 4);
+    } else {
+        return false;
+    }
+
+    *pp = p;
+    return true;
+}
+
+static bool import_skip(const uint8_t** pp, const uint8_t* end)
+{
+    ssize_t size = import_msgpack_skip(*pp, end);
+    if (size <= 0) {
+        return false;
+    }
+    *pp += size;
+    return true;
+}
+
+static char* import_strndup(const uint8_t* str, size_t size)
+{
+    char* result = malloc(size + 1);
+    memcpy(result, str, size);
+    result[size] = '\0';
+    return result;
+}
+
+static bool import_copy_name(char* dest, size_t capacity, const uint8_t* str, size_t size)
+{
+    if (size >= capacity) {
+        return false;
+    }
+    memcpy(dest, str, size);
+    dest[size] = '\0';
+    return true;
+}
+
+static void import_item_destroy(import_item* item)
+{
+    as_key_destroy(&item->key);
+    as_record_destroy(&item->record);
+    free(item);
+}
+
+static bool import_decode_key(import_item* item, const char* ns, const char* set, const uint8_t* p, const uint8_t* end, const uint8_t* digest)
+{
+    const uint8_t* str;
+    size_t size;
+    int64_t value;
+
+    if (p == NULL || *p == 0xc0) {
+        if (digest == NULL) {
+            return false;
+        }
+        as_key_init_digest(&item->key, ns, set, digest);
+    } else if (import_read_int(&p, &value)) {
+        as_key_init_int64(&item->key, ns, set, value);
+    } else if ((*p & 0xe0) == 0xa0 || (*p >= 0xd9 && *p <= 0xdb)) {
+        if (!import_read_str(&p, end, &str, &size)) {
+            return false;
+        }
+        as_key_init_strp(&item->key, ns, set, import_strndup(str, size), true);
+    } else if (*p >= 0xc4 && *p <= 0xc6) {
+        uint8_t* bytes;
+        if (!import_read_str(&p, end, &str, &size)) {
+            return false;
+        }
+        bytes = malloc(size);
+        memcpy(bytes, str, size);
+        as_key_init_rawp(&item->key, ns, set, bytes, size, true);
+    } else {
+        // other ruby keys are stored as their msgpack encoding, so exported slice gives the same digest
+        const uint8_t* start = p;
+        uint8_t* bytes;
+        if (!import_skip(&p, end)) {
+            if (digest == NULL) {
+                return false;
+            }
+            as_key_init_digest(&item->key, ns, set, digest);
+            return true;
+        }
+        bytes = malloc(p - start);
+        memcpy(bytes, start, p - start);
+        as_key_init_rawp(&item->key, ns, set, bytes, p - start, true);
+    }
+
+    return true;
+}
+
+/*
+ * decode msgpack value into new as_val, caller owns result
+ */
+static as_val* import_decode_value(const uint8_t** pp, const uint8_t* end)
+{
+    const uint8_t* p = *pp;
+    const uint8_t* str;
+    size_t size;
+    int64_t integer;
+    uint8_t type;
+
+    if (p >= end) {
+        return NULL;
+    }
+
+    type = *p;
+    if (import_read_int(pp, &integer)) {
+        return (as_val*) as_integer_new(integer);
+    }
+
+    if ((type & 0xe0) == 0xa0 || (type >= 0xd9 && type <= 0xdb)) {
+        if (!import_read_str(pp, end, &str, &size)) {
+            return NULL;
+        }
+        return (as_val*) as_string_new(import_strndup(str, size), true);
+    }
+
+    if (type >= 0xc4 && type <= 0xc6) {
+        uint8_t* bytes;
+        if (!import_read_str(pp, end, &str, &size)) {
+            return NULL;
+        }
+        bytes = malloc(size);
+        memcpy(bytes, str, size);
+        return (as_val*) as_bytes_new_wrap(bytes, size, true);
+    }
+
+    if ((type & 0xf0) == 0x90 || type == 0xdc || type == 0xdd) {
+        uint32_t n, count;
+        as_arraylist* list;
+
+        p++;
+        count = (type & 0xf0) == 0x90 ? (type & 0x0f) : (uint32_t) import_read_be(&p, type == 0xdc ? 2 : 4);
+        list = as_arraylist_new(count, 0);
+        for(n = 0; n < count; n++) {
+            as_val* value = import_decode_value(&p, end);
+            if (value == NULL) {
+                as_val_destroy((as_val*) list);
+                return NULL;
+            }
+            as_arraylist_append(list, value);
+        }
+        *pp = p;
+        return (as_val*) list;
+    }
+
+    if ((type & 0xf0) == 0x80 || type == 0xde || type == 0xdf) {
+        uint32_t n, count;
+        as_hashmap* map;
+
+        if (!import_read_map(&p, &count)) {
+            return NULL;
+        }
+        map = as_hashmap_new(count > 0 ? count : 1);
+        for(n = 0; n < count; n++) {
+            as_val* key = import_decode_value(&p, end);
+            as_val* value = key != NULL ? import_decode_value(&p, end) : NULL;
+            if (value == NULL) {
+                if (key != NULL) {
+                    as_val_destroy(key);
+                }
+                as_val_destroy((as_val*) map);
+                return NULL;
+            }
+            as_hashmap_set(map, key, value);
+        }
+        *pp = p;
+        return (as_val*) map;
+    }
+
+    switch(type) {
+    case 0xc0:
+        *pp = p + 1;
+        return (as_val*) &as_nil;
+    case 0xc2:
+    case 0xc3:
+        *pp = p + 1;
+        return (as_val*) as_boolean_new(type == 0xc3);
+    case 0xca: {
+        uint32_t bits;
+        float value;
+        p++;
+        bits = (uint32_t) import_read_be(&p, 4);
+        memcpy(&value, &bits, sizeof(value));
+        *pp = p;
+        return (as_val*) as_double_new(value);
+    }
+    case 0xcb: {
+        uint64_t bits;
+        double value;
+        p++;
+        bits = import_read_be(&p, 8);
+        memcpy(&value, &bits, sizeof(value));
+        *pp = p;
+        return (as_val*) as_double_new(value);
+    }
+    }
+
+    // ext types are kept as raw msgpack
+    str = p;
+    if (!import_skip(&p, end)) {
+        return NULL;
+    }
+    {
+        uint8_t* bytes = malloc(p - str);
+        memcpy(bytes, str, p - str);
+        *pp = p;
+        return (as_val*) as_bytes_new_wrap(bytes, p - str, true);
+    }
+}
+
+/*
+ * bins are converted the same way as client put does: nil, integers and strings are stored natively,
+ * arrays and maps too with client 'native_collections' setting, other values are stored as msgpack bytes (raw slice of input)
+ */
+static bool import_decode_bins(import_item* item, const uint8_t* p, const uint8_t* end, uint32_t ttl, bool native_collections)
+{
+    uint32_t n, size;
+
+    if (p == NULL) {
+        as_record_init(&item->record, 0);
+        item->record.ttl = ttl;
+        return true;
+    }
+
+    if (!import_read_map(&p, &size) || size > UINT16_MAX) {
+        as_record_init(&item->record, 0);
+        return false;
+    }
+
+    as_record_init(&item->record, size);
+    item->record.ttl = ttl;
+
+    for(n = 0; n < size; n++) {
+        char name[AS_BIN_NAME_MAX_SIZE];
+        const uint8_t* str;
+        const uint8_t* value;
+        size_t str_size;
+        int64_t integer;
+
+        if (p >= end || !import_read_str(&p, end, &str, &str_size)) {
+            return false;
+        }
+        if (!import_copy_name(name, sizeof(name), str, str_size) || p >= end) {
+            return false;
+        }
+
+        value = p;
+        if (*p == 0xc0) {
+            as_record_set_nil(&item->record, name);
+            p++;
+        } else if (import_read_int(&p, &integer)) {
+            as_record_set_int64(&item->record, name, integer);
+        } else if (((*p & 0xe0) == 0xa0 || (*p >= 0xd9 && *p <= 0xdb)) && import_read_str(&p, end, &str, &str_size)) {
+            as_record_set_strp(&item->record, name, import_strndup(str, str_size), true);
+        } else if (native_collections && ((*p & 0xf0) == 0x90 || *p == 0xdc || *p == 0xdd)) {
+            as_val* list = import_decode_value(&p, end);
+            if (list == NULL) {
+                return false;
+            }
+            as_record_set_list(&item->record, name, (as_list*) list);
+        } else if (native_collections && ((*p & 0xf0) == 0x80 || *p == 0xde || *p == 0xdf)) {
+            as_val* map = import_decode_value(&p, end);
+            if (map == NULL) {
+                return false;
+            }
+            as_record_set_map(&item->record, name, (as_map*) map);
+        } else {
+            uint8_t* bytes;
+            p = value;
+            if (!import_skip(&p, end)) {
+                return false;
+            }
+            bytes = malloc(p - value);
+            memcpy(bytes, value, p - value);
+            as_record_set_rawp(&item->record, name, bytes, p - value, true);
+        }
+    }
+
+    return true;
+}
+
+/*
+ * decode one exported record: {"ns", "set", "digest", "key", "gen", "ttl", "bins"}
+ */
+static import_item* import_decode_record(import_loader* loader, const uint8_t* p, const uint8_t* end)
+{
+    import_item* item;
+    uint32_t n, size;
+    char ns[AS_NAMESPACE_MAX_SIZE] = "";
+    char set[AS_SET_MAX_SIZE] = "";
+    const uint8_t* digest = NULL;
+    const uint8_t* key = NULL;
+    const uint8_t* bins = NULL;
+    int64_t ttl = 0;
+    bool valid = true;
+
+    if (!import_read_map(&p, &size)) {
+        return NULL;
+    }
+
+    for(n = 0; n < size && valid; n++) {
+        const uint8_t* name;
+        size_t name_size;
+        const uint8_t* str;
+        size_t str_size;
+
+        if (!import_read_str(&p, end, &name, &name_size) || p >= end) {
+            return NULL;
+        }
+
+        if (name_size == 2 && memcmp(name, "ns", 2) == 0) {
+            valid = import_read_str(&p, end, &str, &str_size) && import_copy_name(ns, sizeof(ns), str, str_size);
+        } else if (name_size == 3 && memcmp(name, "set", 3) == 0) {
+            valid = import_read_str(&p, end, &str, &str_size) && import_copy_name(set, sizeof(set), str, str_size);
+        } else if (name_size == 6 && memcmp(name, "digest", 6) == 0) {
+            valid = import_read_str(&p, end, &digest, &str_size) && str_size == AS_DIGEST_VALUE_SIZE;
+        } else if (name_size == 3 && memcmp(name, "ttl", 3) == 0) {
+            valid = import_read_int(&p, &ttl);
+        } else if (name_size == 3 && memcmp(name, "key", 3) == 0) {
+            key = p;
+            valid = import_skip(&p, end);
+        } else if (name_size == 4 && memcmp(name, "bins", 4) == 0) {
+            bins = p;
+            valid = import_skip(&p, end);
+        } else {
+            valid = import_skip(&p, end);
+        }
+    }
+
+    if (!valid) {
+        return NULL;
+    }
+
+    if (!loader->use_file_ns) {
+        strcpy(ns, loader->ns);
+    }
+    if (!loader->use_file_set) {
+        strcpy(set, loader->set);
+    }
+    if (ns[0] == '\0') {
+        return NULL;
+    }
+
+    item = malloc(sizeof(import_item));
+    if (!import_decode_key(item, ns, set, key, end, digest)) {
+        free(item);
+        return NULL;
+    }
+    if (!import_decode_bins(item, bins, end, (uint32_t) ttl, loader->native_collections)) {
+        import_item_destroy(item);
+        return NULL;
+    }
+
+    return item;
+}
+
+static void import_push(import_loader* loader, import_item* item)
+{
+    pthread_mutex_lock(&loader->lock);
+    while (loader->queue_size == loader->queue_capacity && !loader->cancelled) {
+        pthread_cond_wait(&loader->not_full, &loader->lock);
+    }
+
+    if (loader->cancelled) {
+        pthread_mutex_unlock(&loader->lock);
+        import_item_destroy(item);
+        return;
+    }
+
+    loader->queue[(loader->queue_head + loader->queue_size) % loader->queue_capacity] = item;
+    loader->queue_size++;
+    pthread_cond_signal(&loader->not_empty);
+    pthread_mutex_unlock(&loader->lock);
+}
+
+static ssize_t import_read(import_loader* loader, uint8_t* buffer, size_t size)
+{
+#ifdef HAVE_ZLIB_H
+    if (loader->gz_file != NULL) {
+        return gzread(loader->gz_file, buffer, size);
+    }
+#endif
+    size = fread(buffer, 1, size, loader->file);
+    if (size == 0 && ferror(loader->file)) {
+        return -1;
+    }
+    return size;
+}
+
+static void* import_reader(void* ptr)
+{
+    import_loader* loader = (import_loader*) ptr;
+    size_t offset = 0;
+    bool eof = false;
+
+    while (!loader->cancelled) {
+        ssize_t size = import_msgpack_skip(loader->buffer + offset, loader->buffer + loader->buffer_size);
+
+        if (size > 0) {
+            import_item* item = import_decode_record(loader, loader->buffer + offset, loader->buffer + offset + size);
+            if (item != NULL) {
+                import_push(loader, item);
+            } else {
+                __sync_fetch_and_add(&loader->invalid, 1);
+            }
+            __sync_fetch_and_add(&loader->records, 1);
+            offset += size;
+            continue;
+        }
+
+        if (size < 0 || (eof && offset < loader->buffer_size)) {
+            // stream can't be resynchronized after malformed or truncated record
+            loader->error = EILSEQ;
+            break;
+        }
+        if (eof) {
+            break;
+        }
+
+        memmove(loader->buffer, loader->buffer + offset, loader->buffer_size - offset);
+        loader->buffer_size -= offset;
+        offset = 0;
+
+        if (loader->buffer_capacity - loader->buffer_size < IMPORT_CHUNK_SIZE) {
+            uint8_t* buffer = realloc(loader->buffer, loader->buffer_capacity * 2);
+            if (buffer == NULL) {
+                // old buffer is still owned by loader and released on close
+                loader->error = ENOMEM;
+                break;
+            }
+            loader->buffer = buffer;
+            loader->buffer_capacity *= 2;
+        }
+
+        size = import_read(loader, loader->buffer + loader->buffer_size, IMPORT_CHUNK_SIZE);
+        if (size < 0) {
+            loader->error = errno ? errno : EIO;
+            break;
+        }
+        eof = size == 0;
+        loader->buffer_size += size;
+        __sync_fetch_and_add(&loader->bytes_read, size);
+    }
+
+    pthread_mutex_lock(&loader->lock);
+    loader->reading = false;
+    pthread_cond_broadcast(&loader->not_empty);
+    pthread_mutex_unlock(&loader->lock);
+
+    return NULL;
+}
+
+static void* import_worker(void* ptr)
+{
+    import_loader* loader = (import_loader*) ptr;
+    import_item* item;
+    as_error err;
+    as_status status;
+
+    while (true) {
+        pthread_mutex_lock(&loader->lock);
+        while (loader->queue_size == 0 && loader->reading && !loader->cancelled) {
+            pthread_cond_wait(&loader->not_empty, &loader->lock);
+        }
+
+        if (loader->cancelled || loader->queue_size == 0) {
+            loader->running--;
+            if (loader->running == 0) {
+                pthread_cond_broadcast(&loader->finished);
+            }
+            pthread_mutex_unlock(&loader->lock);
+            break;
+        }
+
+        item = loader->queue[loader->queue_head];
+        loader->queue_head = (loader->queue_head + 1) % loader->queue_capacity;
+        loader->queue_size--;
+        pthread_cond_signal(&loader->not_full);
+        pthread_mutex_unlock(&loader->lock);
+
+        status = aerospike_key_put(loader->as, &err, loader->policy, &item->key, &item->record);
+        if (status == AEROSPIKE_OK) {
+            __sync_fetch_and_add(&loader->written, 1);
+        } else {
+            int index = status + IMPORT_STATUS_OFFSET;
+            if (index < 0 || index >= IMPORT_STATUS_COUNT) {
+                index = AEROSPIKE_ERR_CLIENT + IMPORT_STATUS_OFFSET;
+            }
+            __sync_fetch_and_add(&loader->failed, 1);
+            __sync_fetch_and_add(&loader->errors[index], 1);
+        }
+
+        import_item_destroy(item);
+    }
+
+    return NULL;
+}
+
+/*
+ * returns 0 on success or errno
+ */
+int import_loader_open(import_loader* loader, const char* path, int concurrency)
+{
+    memset(loader, 0, sizeof(import_loader));
+    loader->concurrency = concurrency;
+
+#ifdef HAVE_ZLIB_H
+    // gzread reads uncompressed files transparently
+    loader->gz_file = gzopen(path, "rb");
+    if (loader->gz_file == NULL) {
+        return errno ? errno : EIO;
+    }
+#else
+    loader->file = fopen(path, "rb");
+    if (loader->file == NULL) {
+        return errno;
+    }
+#endif
+
+    loader->buffer_capacity = IMPORT_CHUNK_SIZE * 2;
+    loader->buffer = malloc(loader->buffer_capacity);
+    loader->queue_capacity = concurrency * IMPORT_QUEUE_FACTOR;
+    loader->queue = malloc(sizeof(import_item*) * loader->queue_capacity);
+    if (loader->buffer == NULL || loader->queue == NULL) {
+        free(loader->buffer);
+        free(loader->queue);
+#ifdef HAVE_ZLIB_H
+        gzclose(loader->gz_file);
+#else
+        fclose(loader->file);
+#endif
+        return ENOMEM;
+    }
+
+    pthread_mutex_init(&loader->lock, NULL);
+    pthread_cond_init(&loader->not_empty, NULL);
+    pthread_cond_init(&loader->not_full, NULL);
+    pthread_cond_init(&loader->finished, NULL);
+
+    return 0;
+}
+
+/*
+ * start reader and writer threads, returns 0 on success or errno
+ */
+int import_loader_start(import_loader* loader)
+{
+    int n, error;
+
+    loader->reading = true;
+    error = pthread_create(&loader->reader, NULL, import_reader, loader);
+    if (error != 0) {
+        loader->reading = false;
+        return error;
+    }
+    loader->reader_started = true;
+
+    for(n = 0; n < loader->concurrency; n++) {
+        pthread_mutex_lock(&loader->lock);
+        loader->running++;
+        pthread_mutex_unlock(&loader->lock);
+
+        error = pthread_create(&loader->workers[n], NULL, import_worker, loader);
+        if (error != 0) {
+            pthread_mutex_lock(&loader->lock);
+            loader->running--;
+            pthread_mutex_unlock(&loader->lock);
+            import_loader_cancel(loader);
+            return error;
+        }
+        loader->workers_started++;
+    }
+
+    return 0;
+}
+
+/*
+ * wait for all records to be written, returns true when loading is finished
+ */
+bool import_loader_wait(import_loader* loader, uint32_t timeout_ms)
+{
+    struct timespec deadline;
+    bool finished;
+
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (timeout_ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    pthread_mutex_lock(&loader->lock);
+    while (loader->running > 0 && !loader->cancelled) {
+        if (pthread_cond_timedwait(&loader->finished, &loader->lock, &deadline) == ETIMEDOUT) {
+            break;
+        }
+    }
+    finished = loader->running == 0;
+    pthread_mutex_unlock(&loader->lock);
+
+    return finished;
+}
+
+void import_loader_cancel(import_loader* loader)
+{
+    pthread_mutex_lock(&loader->lock);
+    loader->cancelled = true;
+    pthread_cond_broadcast(&loader->not_empty);
+    pthread_cond_broadcast(&loader->not_full);
+    pthread_cond_broadcast(&loader->finished);
+    pthread_mutex_unlock(&loader->lock);
+}
+
+/*
+ * join threads and release resources, loader must be finished or cancelled
+ */
+void import_loader_close(import_loader* loader)
+{
+    int n;
+
+    if (loader->reader_started) {
+        pthread_join(loader->reader, NULL);
+    }
+    for(n = 0; n < loader->workers_started; n++) {
+        pthread_join(loader->workers[n], NULL);
+    }
+
+    while (loader->queue_size > 0) {
+        import_item_destroy(loader->queue[loader->queue_head]);
+        loader->queue_head = (loader->queue_head + 1) % loader->queue_capacity;
+        loader->queue_size--;
+    }
+
+#ifdef HAVE_ZLIB_H
+    if (loader->gz_file != NULL) {
+        gzclose(loader->gz_file);
+    }
+#endif
+    if (loader->file != NULL) {
+        fclose(loader->file);
+    }
+
+    free(loader->buffer);
+    free(loader->queue);
+    pthread_mutex_destroy(&loader->lock);
+    pthread_cond_destroy(&loader->not_empty);
+    pthread_cond_destroy(&loader->not_full);
+    pthread_cond_destroy(&loader->finished);
+}
+
+VALUE import_loader_stats(import_loader* loader)
+{
+    VALUE vStats = rb_hash_new();
+    VALUE vErrors = rb_hash_new();
+    int n;
+
+    for(n = 0; n < IMPORT_STATUS_COUNT; n++) {
+        if (loader->errors[n] > 0) {
+            rb_hash_aset(vErrors, INT2FIX(n - IMPORT_STATUS_OFFSET), ULL2NUM(loader->errors[n]));
+        }
+    }
+
+    rb_hash_aset(vStats, rb_str_new2("bytes_read"), ULL2NUM(loader->bytes_read));
+    rb_hash_aset(vStats, rb_str_new2("records"), ULL2NUM(loader->records));
+    rb_hash_aset(vStats, rb_str_new2("written"), ULL2NUM(loader->written));
+    rb_hash_aset(vStats, rb_str_new2("failed"), ULL2NUM(loader->failed));
+    rb_hash_aset(vStats, rb_str_new2("invalid"), ULL2NUM(loader->invalid));
+    rb_hash_aset(vStats, rb_str_new2("errors"), vErrors);
+
+    return vStats;
+}
+
+typedef struct import_wait_args_s {
+    import_loader* loader;
+    uint32_t timeout_ms;
+    bool finished;
+} import_wait_args;
+
+static void* import_wait_without_gvl(void* ptr)
+{
+    import_wait_args* args = (import_wait_args*) ptr;
+    args->finished = import_loader_wait(args->loader, args->timeout_ms);
+    return NULL;
+}
+
+static void import_wait_interrupt(void* ptr)
+{
+    import_loader_cancel((import_loader*) ptr);
+}
+
+static void* import_close_without_gvl(void* ptr)
+{
+    import_loader_close((import_loader*) ptr);
+    return NULL;
+}
+
+static VALUE import_run(VALUE vArgs)
+{
+    import_wait_args* args = (import_wait_args*) vArgs;
+
+    while (!args->finished) {
+        rb_thread_call_without_gvl(import_wait_without_gvl, args, import_wait_interrupt, args->loader);
+        if (args->loader->cancelled) {
+            break;
+        }
+        if (!args->finished && rb_block_given_p()) {
+            rb_yield(import_loader_stats(args->loader));
+        }
+    }
+
+    return Qnil;
+}
+
+static VALUE import_ensure(VALUE vArgs)
+{
+    import_wait_args* args = (import_wait_args*) vArgs;
+
+    if (!args->finished) {
+        import_loader_cancel(args->loader);
+    }
+    rb_thread_call_without_gvl(import_close_without_gvl, args->loader, NULL, NULL);
+
+    return Qnil;
+}
+
+/*
+ * call-seq:
+ *   import(path, namespace, set) -> Hash
+ *   import(path, namespace, set, options) -> Hash
+ *   import(path, namespace, set, options, write_policy) -> Hash
+ *   import(path, namespace, set, options, write_policy) { |progress| ... } -> Hash
+ *
+ * load records exported with Scan#export into namespace and set (nil to keep exported ones),
+ * records are parsed and written by native threads without GVL.
+ * options: format: :msgpack, concurrency: number of parallel writes (default 16),
+ * progress_interval: milliseconds between progress yields (default 1000)
+ */
+VALUE client_import(int argc, VALUE* vArgs, VALUE vSelf)
+{
+    VALUE vPath, vNamespace, vSet;
+    VALUE vOptions = Qnil;
+    VALUE vFormat, vConcurrency, vInterval;
+    import_loader loader;
+    import_wait_args args;
+    as_policy_write policy;
+    aerospike* ptr;
+    int concurrency = 16;
+    uint32_t interval = 1000;
+    int error;
+
+    if (argc > 5 || argc < 3) {  // there should only be 3, 4 or 5 arguments
+        rb_raise(rb_eArgError, "wrong number of arguments (%d for 3..5)", argc);
+    }
+
+    vPath = vArgs[0];
+    Check_Type(vPath, T_STRING);
+    vNamespace = vArgs[1];
+    vSet = vArgs[2];
+    if (TYPE(vNamespace) != T_NIL) {
+        Check_Type(vNamespace, T_STRING);
+        if (RSTRING_LEN(vNamespace) >= AS_NAMESPACE_MAX_SIZE) {
+            rb_raise(rb_eArgError, "namespace name is too long");
+        }
+    }
+    if (TYPE(vSet) != T_NIL) {
+        Check_Type(vSet, T_STRING);
+        if (RSTRING_LEN(vSet) >= AS_SET_MAX_SIZE) {
+            rb_raise(rb_eArgError, "set name is too long");
+        }
+    }
+
+    if (argc > 3 && TYPE(vArgs[3]) != T_NIL) {
+        Check_Type(vArgs[3], T_HASH);
+        vOptions = vArgs[3];
+    }
+
+    vFormat = rb_hash_option(vOptions, "format");
+    if (TYPE(vFormat) != T_NIL) {
+        GET_STRING(vFormat);
+        if (strcmp(StringValueCStr(vFormat), "msgpack") != 0) {
+            rb_raise(rb_eArgError, "unknown import format %s (expected msgpack)", StringValueCStr(vFormat));
+        }
+    }
+
+    vConcurrency = rb_hash_option(vOptions, "concurrency");
+    if (TYPE(vConcurrency) != T_NIL) {
+        concurrency = NUM2INT(vConcurrency);
+        if (concurrency < 1 || concurrency > IMPORT_MAX_CONCURRENCY) {
+            rb_raise(rb_eArgError, "concurrency should be in 1..%d", IMPORT_MAX_CONCURRENCY);
+        }
+    }
+
+    vInterval = rb_hash_option(vOptions, "progress_interval");
+    if (TYPE(vInterval) != T_NIL) {
+        interval = NUM2UINT(vInterval);
+        if (interval == 0) {
+            rb_raise(rb_eArgError, "progress_interval should be positive");
+        }
+    }
+
+    as_policy_write_init(&policy);
+    if (argc == 5 && TYPE(vArgs[4]) != T_NIL) {
+        SET_WRITE_POLICY(policy, vArgs[4]);
+    }
+
+    Data_Get_Struct(vSelf, aerospike, ptr);
+
+    error = import_loader_open(&loader, StringValueCStr(vPath), concurrency);
+    if (error != 0) {
+        rb_syserr_fail_str(error, vPath);
+    }
+
+    loader.as = ptr;
+    loader.policy = &policy;
+    loader.use_file_ns = TYPE(vNamespace) == T_NIL;
+    loader.use_file_set = TYPE(vSet) == T_NIL;
+    loader.native_collections = client_native_collections(vSelf);
+    if (!loader.use_file_ns) {
+        strcpy(loader.ns, StringValueCStr(vNamespace));
+    }
+    if (!loader.use_file_set) {
+        strcpy(loader.set, StringValueCStr(vSet));
+    }
+
+    args.loader = &loader;
+    args.timeout_ms = interval;
+    args.finished = false;
+
+    error = import_loader_start(&loader);
+    if (error != 0) {
+        import_ensure((VALUE) &args);
+        rb_syserr_fail(error, "import threads");
+    }
+
+    rb_ensure(import_run, (VALUE) &args, import_ensure, (VALUE) &args);
+
+    if (loader.cancelled) {
+        rb_thread_check_ints();
+        raise_aerospike_exception(AEROSPIKE_ERR_CLIENT_ABORT, "import interrupted");
+    }
+
+    if (loader.error != 0) {
+        rb_syserr_fail_str(loader.error, vPath);
+    }
+
+    return import_loader_stats(&loader);
+}
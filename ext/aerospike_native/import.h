@@ -0,0 +1,80 @@
+#ifndef IMPORT_H
+#define IMPORT_H
+
+#include "aerospike_native.h"
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#ifdef HAVE_ZLIB_H
+#include <zlib.h>
+#endif
+#include <aerospike/as_key.h>
+#include <aerospike/as_record.h>
+
+#define IMPORT_CHUNK_SIZE (64 * 1024)
+#define IMPORT_MAX_CONCURRENCY 256
+#define IMPORT_QUEUE_FACTOR 64
+#define IMPORT_STATUS_OFFSET 256
+#define IMPORT_STATUS_COUNT 512
+
+typedef struct import_item_s {
+    as_key key;
+    as_record record;
+} import_item;
+
+typedef struct import_loader_s {
+    aerospike* as;
+    as_policy_write* policy;
+    char ns[AS_NAMESPACE_MAX_SIZE];
+    char set[AS_SET_MAX_SIZE];
+    bool use_file_ns;
+    bool use_file_set;
+    bool native_collections;
+
+    FILE* file;
+#ifdef HAVE_ZLIB_H
+    gzFile gz_file;
+#endif
+    uint8_t* buffer;
+    size_t buffer_size;
+    size_t buffer_capacity;
+
+    pthread_t reader;
+    pthread_t workers[IMPORT_MAX_CONCURRENCY];
+    int concurrency;
+    int workers_started;
+    int running;
+    bool reader_started;
+
+    import_item** queue;
+    size_t queue_capacity;
+    size_t queue_head;
+    size_t queue_size;
+    bool reading;
+
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+    pthread_cond_t finished;
+
+    volatile bool cancelled;
+    int error;
+    uint64_t bytes_read;
+    uint64_t records;
+    uint64_t written;
+    uint64_t failed;
+    uint64_t invalid;
+    uint64_t errors[IMPORT_STATUS_COUNT];
+} import_loader;
+
+ssize_t import_msgpack_skip(const uint8_t* begin, const uint8_t* end);
+int import_loader_open(import_loader* loader, const char* path, int concurrency);
+int import_loader_start(import_loader* loader);
+bool import_loader_wait(import_loader* loader, uint32_t timeout_ms);
+void import_loader_cancel(import_loader* loader);
+void import_loader_close(import_loader* loader);
+VALUE import_loader_stats(import_loader* loader);
+
+VALUE client_import(int argc, VALUE* vArgs, VALUE vSelf);
+
+#endif // IMPORT_H
@@ -0,0 +1,210 @@
+#include "index_task.h"
+#include "client.h"
+#include <aerospike/aerospike_info.h>
+#include <aerospike/as_info.h>
+#include <ruby/thread.h>
+
+VALUE IndexTaskClass;
+
+typedef struct index_progress_s {
+    int nodes;
+    int found;
+    uint32_t progress;
+} index_progress;
+
+typedef struct index_info_args_s {
+    aerospike* as;
+    as_error* err;
+    as_policy_info* policy;
+    const char* command;
+    index_progress* progress;
+    as_status status;
+} index_info_args;
+
+/*
+ * call-seq:
+ *   new(client, namespace, index_name) -> AerospikeNative::IndexTask
+ *
+ * initialize handle of secondary index which is being built
+ */
+VALUE index_task_initialize(VALUE vSelf, VALUE vClient, VALUE vNamespace, VALUE vIndexName)
+{
+    check_aerospike_client(vClient);
+    Check_Type(vNamespace, T_STRING);
+    Check_Type(vIndexName, T_STRING);
+
+    rb_iv_set(vSelf, "@client", vClient);
+    rb_iv_set(vSelf, "@namespace", vNamespace);
+    rb_iv_set(vSelf, "@index_name", vIndexName);
+
+    return vSelf;
+}
+
+VALUE rb_index_task_new(VALUE vClient, VALUE vNamespace, VALUE vIndexName)
+{
+    VALUE vParams[3];
+
+    vParams[0] = vClient;
+    vParams[1] = vNamespace;
+    vParams[2] = vIndexName;
+
+    return rb_class_new_instance(3, vParams, IndexTaskClass);
+}
+
+static bool index_progress_callback(const as_error* err, const as_node* node, const char* req, char* res, void* udata)
+{
+    index_progress* info = (index_progress*) udata;
+    char* value = NULL;
+    char* token;
+    char* saveptr = NULL;
+    uint32_t pct = 0;
+
+    info->nodes++;
+    if (res == NULL || as_info_parse_single_response(res, &value) != AEROSPIKE_OK || value == NULL) {
+        return true;
+    }
+
+    // index is not created on this node yet, so nothing is loaded there
+    if (strncmp(value, "FAIL", 4) == 0 || strncmp(value, "ERROR", 5) == 0) {
+        info->progress = 0;
+        return true;
+    }
+
+    info->found++;
+    for(token = strtok_r(value, ";", &saveptr); token != NULL; token = strtok_r(NULL, ";", &saveptr)) {
+        if (strncmp(token, "load_pct=", 9) == 0) {
+            pct = (uint32_t) strtoul(token + 9, NULL, 10);
+            break;
+        }
+    }
+
+    if (pct < info->progress) {
+        info->progress = pct;
+    }
+
+    return true;
+}
+
+static void* index_info_without_gvl(void* ptr)
+{
+    index_info_args* args = (index_info_args*) ptr;
+
+    args->status = aerospike_info_foreach(args->as, args->err, args->policy, args->command, index_progress_callback, args->progress);
+
+    return NULL;
+}
+
+/*
+ * call-seq:
+ *   progress -> Integer
+ *   progress(policy_settings) -> Integer
+ *
+ * return index build percentage, minimum of load_pct among all nodes (GVL is released while nodes are asked)
+ */
+VALUE index_task_progress(int argc, VALUE* vArgs, VALUE vSelf)
+{
+    VALUE vClient, vNamespace, vIndexName;
+    aerospike* ptr;
+    as_error err;
+    as_policy_info policy;
+    index_progress info;
+    index_info_args args;
+    char command[256];
+
+    if (argc > 1) {  // there should only be 0 or 1 argument
+        rb_raise(rb_eArgError, "wrong number of arguments (%d for 0..1)", argc);
+    }
+
+    as_policy_info_init(&policy);
+    if (argc == 1 && TYPE(vArgs[0]) != T_NIL) {
+        SET_INFO_POLICY(policy, vArgs[0]);
+    }
+
+    vClient = rb_iv_get(vSelf, "@client");
+    vNamespace = rb_iv_get(vSelf, "@namespace");
+    vIndexName = rb_iv_get(vSelf, "@index_name");
+    Data_Get_Struct(vClient, aerospike, ptr);
+
+    info.nodes = 0;
+    info.found = 0;
+    info.progress = 100;
+    snprintf(command, sizeof(command), "sindex/%s/%s", StringValueCStr(vNamespace), StringValueCStr(vIndexName));
+
+    args.as = ptr;
+    args.err = &err;
+    args.policy = &policy;
+    args.command = command;
+    args.progress = &info;
+    args.status = AEROSPIKE_OK;
+    rb_thread_call_without_gvl(index_info_without_gvl, &args, NULL, NULL);
+
+    if (args.status != AEROSPIKE_OK) {
+        raise_aerospike_exception(err.code, err.message);
+    }
+
+    return UINT2NUM(info.found > 0 ? info.progress : 0);
+}
+
+/*
+ * call-seq:
+ *   done? -> true or false
+ *
+ * check index is built on all nodes
+ */
+VALUE index_task_is_done(VALUE vSelf)
+{
+    return NUM2UINT(index_task_progress(0, NULL, vSelf)) >= 100 ? Qtrue : Qfalse;
+}
+
+/*
+ * call-seq:
+ *   wait -> true
+ *   wait(timeout_ms) -> true or false
+ *
+ * poll index with exponential backoff (10ms up to 1s) until it's built, GVL is released between polls
+ */
+VALUE index_task_wait(int argc, VALUE* vArgs, VALUE vSelf)
+{
+    struct timeval delay;
+    long timeout = -1, waited = 0, backoff = 10;
+
+    if (argc > 1) {  // there should only be 0 or 1 argument
+        rb_raise(rb_eArgError, "wrong number of arguments (%d for 0..1)", argc);
+    }
+
+    if (argc == 1 && TYPE(vArgs[0]) != T_NIL) {
+        Check_Type(vArgs[0], T_FIXNUM);
+        timeout = FIX2LONG(vArgs[0]);
+    }
+
+    while (index_task_is_done(vSelf) != Qtrue) {
+        if (timeout >= 0 && waited >= timeout) {
+            return Qfalse;
+        }
+        if (timeout >= 0 && waited + backoff > timeout) {
+            backoff = timeout - waited;
+        }
+
+        delay.tv_sec = backoff / 1000;
+        delay.tv_usec = (backoff % 1000) * 1000;
+        rb_thread_wait_for(delay);
+
+        waited += backoff;
+        backoff = backoff * 2 > 1000 ? 1000 : backoff * 2;
+    }
+
+    return Qtrue;
+}
+
+void define_index_task()
+{
+    IndexTaskClass = rb_define_class_under(AerospikeNativeClass, "IndexTask", rb_cObject);
+    rb_define_method(IndexTaskClass, "initialize", index_task_initialize, 3);
+    rb_define_method(IndexTaskClass, "progress", index_task_progress, -1);
+    rb_define_method(IndexTaskClass, "done?", index_task_is_done, 0);
+    rb_define_method(IndexTaskClass, "wait", index_task_wait, -1);
+
+    rb_define_attr(IndexTaskClass, "client", 1, 0);
+    rb_define_attr(IndexTaskClass, "namespace", 1, 0);
+    rb_define_attr(IndexTaskClass, "index_name", 1, 0);
+}
@@ -0,0 +1,11 @@
+#ifndef INDEX_TASK_H
+#define INDEX_TASK_H
+
+#include "aerospike_native.h"
+
+RUBY_EXTERN VALUE IndexTaskClass;
+void define_index_task();
+VALUE rb_index_task_new(VALUE vClient, VALUE vNamespace, VALUE vIndexName);
+VALUE index_task_wait(int argc, VALUE* vArgs, VALUE vSelf);
+
+#endif // INDEX_TASK_H
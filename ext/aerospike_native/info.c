@@ -0,0 +1,467 @@
+#include "info.h"
+#include "client.h"
+#include <aerospike/aerospike_info.h>
+#include <aerospike/as_cluster.h>
+#include <aerospike/as_info.h>
+#include <ruby/thread.h>
+
+typedef struct info_args_s {
+    aerospike* as;
+    as_error* err;
+    as_policy_info* policy;
+    const char* node;
+    const char* command;
+    info_responses* responses;
+    as_status status;
+} info_args;
+
+// namespace statistics which are summed up across nodes
+static const char* namespace_totals[] = {
+    "objects", "master_objects", "prole_objects", "tombstones", "master_tombstones",
+    "evicted_objects", "expired_objects",
+    "memory_used_bytes", "memory_used_data_bytes", "memory_used_index_bytes", "memory_used_sindex_bytes",
+    "device_used_bytes", "pmem_used_bytes",
+    "master-objects", "prole-objects", "used-bytes-memory", "used-bytes-disk",
+    NULL
+};
+
+/*
+ * take ownership of response, runs without GVL so allocation failure is only flagged and raised by info_request
+ */
+static bool info_responses_add(info_responses* responses, const char* node, char* response)
+{
+    if (response == NULL) {
+        responses->out_of_memory = true;
+        return false;
+    }
+    if (responses->size == responses->capacity) {
+        uint32_t capacity = responses->capacity == 0 ? 8 : responses->capacity * 2;
+        info_response* items = (info_response*) realloc(responses->items, capacity * sizeof(info_response));
+        if (items == NULL) {
+            free(response);
+            responses->out_of_memory = true;
+            return false;
+        }
+        responses->items = items;
+        responses->capacity = capacity;
+    }
+
+    strncpy(responses->items[responses->size].node, node, AS_NODE_NAME_SIZE - 1);
+    responses->items[responses->size].node[AS_NODE_NAME_SIZE - 1] = '\0';
+    responses->items[responses->size].response = response;
+    responses->size++;
+
+    return true;
+}
+
+static void info_responses_free(info_responses* responses)
+{
+    uint32_t n;
+
+    for(n = 0; n < responses->size; n++) {
+        free(responses->items[n].response);
+    }
+    free(responses->items);
+
+    responses->items = NULL;
+    responses->size = 0;
+    responses->capacity = 0;
+}
+
+static bool info_callback(const as_error* err, const as_node* node, const char* req, char* res, void* udata)
+{
+    // response is owned by client library, ruby objects are built after GVL is acquired again
+    if (res != NULL) {
+        return info_responses_add((info_responses*) udata, node->name, strdup(res));
+    }
+
+    return true;
+}
+
+static void* info_without_gvl(void* ptr)
+{
+    info_args* args = (info_args*) ptr;
+    as_node* node;
+    char* res = NULL;
+
+    if (args->node == NULL) {
+        args->status = aerospike_info_foreach(args->as, args->err, args->policy, args->command, info_callback, args->responses);
+        return NULL;
+    }
+
+    node = as_node_get_by_name(args->as->cluster, args->node);
+    if (node == NULL) {
+        args->status = as_error_update(args->err, AEROSPIKE_ERR_PARAM, "Node %s is not found", args->node);
+        return NULL;
+    }
+
+    args->status = aerospike_info_node(args->as, args->err, args->policy, node, args->command, &res);
+    as_node_release(node);
+
+    if (args->status == AEROSPIKE_OK && res != NULL) {
+        info_responses_add(args->responses, args->node, res);
+    }
+
+    return NULL;
+}
+
+static void info_request(VALUE vSelf, as_policy_info* policy, const char* node, const char* command, info_responses* responses)
+{
+    aerospike* ptr;
+    as_error err;
+    info_args args;
+
+    Data_Get_Struct(vSelf, aerospike, ptr);
+
+    args.as = ptr;
+    args.err = &err;
+    args.policy = policy;
+    args.node = node;
+    args.command = command;
+    args.responses = responses;
+    args.status = AEROSPIKE_OK;
+    rb_thread_call_without_gvl(info_without_gvl, &args, NULL, NULL);
+
+    if (responses->out_of_memory) {
+        info_responses_free(responses);
+        rb_raise(rb_eNoMemError, "failed to allocate info responses");
+    }
+    if (args.status != AEROSPIKE_OK) {
+        info_responses_free(responses);
+        raise_aerospike_exception(err.code, err.message);
+    }
+}
+
+static VALUE info_scalar(const char* value)
+{
+    const char* digits = value;
+
+    if (*digits == '-') {
+        digits++;
+    }
+    if (*digits != '\0' && strspn(digits, "0123456789") == strlen(digits)) {
+        return rb_cstr2inum(value, 10);
+    }
+    if (strcmp(value, "true") == 0) {
+        return Qtrue;
+    }
+    if (strcmp(value, "false") == 0) {
+        return Qfalse;
+    }
+
+    return rb_str_new2(value);
+}
+
+static VALUE info_pairs(char* value, const char* separator)
+{
+    VALUE vHash = rb_hash_new();
+    char* token;
+    char* saveptr = NULL;
+    char* eq;
+
+    for(token = strtok_r(value, separator, &saveptr); token != NULL; token = strtok_r(NULL, separator, &saveptr)) {
+        eq = strchr(token, '=');
+        if (eq == NULL) {
+            continue;
+        }
+        *eq = '\0';
+        rb_hash_aset(vHash, rb_str_new2(token), info_scalar(eq + 1));
+    }
+
+    return vHash;
+}
+
+/*
+ * parse info value: "k=v;k=v" into Hash, "k=v:k=v;k=v:k=v" (sets, sindex) into Array of Hashes,
+ * "a;b" into Array and single values into Integer, boolean or String
+ */
+static VALUE info_parse_value(char* value)
+{
+    VALUE vArray;
+    char* token;
+    char* saveptr = NULL;
+    char* colon;
+    char* item_end;
+    bool records;
+
+    if (strchr(value, '=') == NULL) {
+        if (strchr(value, ';') == NULL) {
+            return info_scalar(value);
+        }
+
+        vArray = rb_ary_new();
+        for(token = strtok_r(value, ";", &saveptr); token != NULL; token = strtok_r(NULL, ";", &saveptr)) {
+            rb_ary_push(vArray, info_scalar(token));
+        }
+        return vArray;
+    }
+
+    item_end = strchr(value, ';');
+    colon = strchr(value, ':');
+    records = colon != NULL && (item_end == NULL || colon < item_end) && strchr(colon, '=') != NULL &&
+        (item_end == NULL || strchr(colon, '=') < item_end);
+    if (!records) {
+        return info_pairs(value, ";");
+    }
+
+    vArray = rb_ary_new();
+    for(token = strtok_r(value, ";", &saveptr); token != NULL; token = strtok_r(NULL, ";", &saveptr)) {
+        rb_ary_push(vArray, info_pairs(token, ":"));
+    }
+
+    return vArray;
+}
+
+static VALUE info_response_value(char* response, bool raw)
+{
+    char* value = NULL;
+
+    if (as_info_parse_single_response(response, &value) != AEROSPIKE_OK || value == NULL) {
+        return Qnil;
+    }
+
+    return raw ? rb_str_new2(value) : info_parse_value(value);
+}
+
+static uint32_t info_bitmap_count(const char* bitmap)
+{
+    uint32_t count = 0;
+    int bits;
+
+    // count of set bits in base64 encoded partitions bitmap without decoding it
+    for(; *bitmap != '\0'; bitmap++) {
+        if (*bitmap >= 'A' && *bitmap <= 'Z') {
+            bits = *bitmap - 'A';
+        } else if (*bitmap >= 'a' && *bitmap <= 'z') {
+            bits = *bitmap - 'a' + 26;
+        } else if (*bitmap >= '0' && *bitmap <= '9') {
+            bits = *bitmap - '0' + 52;
+        } else if (*bitmap == '+') {
+            bits = 62;
+        } else if (*bitmap == '/') {
+            bits = 63;
+        } else {
+            continue;
+        }
+
+        for(; bits != 0; bits >>= 1) {
+            count += bits & 1;
+        }
+    }
+
+    return count;
+}
+
+/*
+ * parse "ns:bitmap;..." (replicas-master) or "ns:[regime,]count,bitmap,...;..." (replicas)
+ * into Hash of master partitions count per namespace
+ */
+static VALUE info_partitions(char* value)
+{
+    VALUE vPartitions = rb_hash_new();
+    char* token;
+    char* segment;
+    char* saveptr = NULL;
+    char* segment_saveptr = NULL;
+    char* colon;
+
+    for(token = strtok_r(value, ";", &saveptr); token != NULL; token = strtok_r(NULL, ";", &saveptr)) {
+        colon = strchr(token, ':');
+        if (colon == NULL) {
+            continue;
+        }
+        *colon = '\0';
+
+        for(segment = strtok_r(colon + 1, ",", &segment_saveptr); segment != NULL; segment = strtok_r(NULL, ",", &segment_saveptr)) {
+            if (strlen(segment) > 8) {
+                rb_hash_aset(vPartitions, rb_str_new2(token), UINT2NUM(info_bitmap_count(segment)));
+                break;
+            }
+        }
+    }
+
+    return vPartitions;
+}
+
+static VALUE info_node_hash(const char* node, char* response)
+{
+    VALUE vNode = rb_hash_new();
+    VALUE vPartitions = Qnil;
+    char* line;
+    char* saveptr = NULL;
+    char* value;
+
+    rb_hash_aset(vNode, rb_str_new2("name"), rb_str_new2(node));
+    for(line = strtok_r(response, "\n", &saveptr); line != NULL; line = strtok_r(NULL, "\n", &saveptr)) {
+        value = strchr(line, '\t');
+        if (value == NULL) {
+            continue;
+        }
+        *value++ = '\0';
+        if (*value == '\0' || strncmp(value, "ERROR", 5) == 0) {
+            continue;
+        }
+
+        if (strcmp(line, "service") == 0) {
+            rb_hash_aset(vNode, rb_str_new2("address"), rb_str_new2(value));
+        } else if (strcmp(line, "build") == 0) {
+            rb_hash_aset(vNode, rb_str_new2("build"), rb_str_new2(value));
+        } else if (strcmp(line, "partition-generation") == 0) {
+            rb_hash_aset(vNode, rb_str_new2("partition_generation"), info_scalar(value));
+        } else if (strcmp(line, "replicas-master") == 0 || (strcmp(line, "replicas") == 0 && TYPE(vPartitions) == T_NIL)) {
+            vPartitions = info_partitions(value);
+        }
+    }
+    rb_hash_aset(vNode, rb_str_new2("partitions"), TYPE(vPartitions) == T_NIL ? rb_hash_new() : vPartitions);
+
+    return vNode;
+}
+
+/*
+ * call-seq:
+ *   nodes -> Array
+ *   nodes(policy_settings) -> Array
+ *
+ * return cluster nodes as hashes with 'name', 'address', 'build', 'partition_generation'
+ * and 'partitions' (count of master partitions per namespace)
+ */
+VALUE client_nodes(int argc, VALUE* vArgs, VALUE vSelf)
+{
+    VALUE vNodes;
+    as_policy_info policy;
+    info_responses responses = { NULL, 0, 0, false };
+    uint32_t n;
+
+    if (argc > 1) {  // there should only be 0 or 1 argument
+        rb_raise(rb_eArgError, "wrong number of arguments (%d for 0..1)", argc);
+    }
+
+    as_policy_info_init(&policy);
+    if (argc == 1 && TYPE(vArgs[0]) != T_NIL) {
+        SET_INFO_POLICY(policy, vArgs[0]);
+    }
+
+    info_request(vSelf, &policy, NULL, INFO_NODES_COMMAND, &responses);
+
+    vNodes = rb_ary_new();
+    for(n = 0; n < responses.size; n++) {
+        rb_ary_push(vNodes, info_node_hash(responses.items[n].node, responses.items[n].response));
+    }
+    info_responses_free(&responses);
+
+    return vNodes;
+}
+
+/*
+ * call-seq:
+ *   info(command) -> Hash
+ *   info(command, options) -> Hash or value
+ *   info(command, options, policy_settings) -> Hash or value
+ *
+ * execute info command on all nodes and return Hash of node name => parsed response.
+ * Options are 'node' => name to ask single node and return its parsed response
+ * and 'raw' => true to return response strings without parsing
+ */
+VALUE client_info(int argc, VALUE* vArgs, VALUE vSelf)
+{
+    VALUE vCommand, vNode = Qnil, vResult;
+    as_policy_info policy;
+    info_responses responses = { NULL, 0, 0, false };
+    bool raw = false;
+    uint32_t n;
+
+    if (argc == 0 || argc > 3) {  // there should only be 1, 2 or 3 arguments
+        rb_raise(rb_eArgError, "wrong number of arguments (%d for 1..3)", argc);
+    }
+
+    vCommand = vArgs[0];
+    GET_STRING(vCommand);
+
+    if (argc > 1 && TYPE(vArgs[1]) != T_NIL) {
+        Check_Type(vArgs[1], T_HASH);
+        vNode = rb_hash_option(vArgs[1], "node");
+        raw = RTEST(rb_hash_option(vArgs[1], "raw"));
+        if (TYPE(vNode) != T_NIL) {
+            GET_STRING(vNode);
+        }
+    }
+
+    as_policy_info_init(&policy);
+    if (argc == 3 && TYPE(vArgs[2]) != T_NIL) {
+        SET_INFO_POLICY(policy, vArgs[2]);
+    }
+
+    info_request(vSelf, &policy, TYPE(vNode) == T_NIL ? NULL : StringValueCStr(vNode), StringValueCStr(vCommand), &responses);
+
+    if (TYPE(vNode) != T_NIL) {
+        vResult = responses.size > 0 ? info_response_value(responses.items[0].response, raw) : Qnil;
+    } else {
+        vResult = rb_hash_new();
+        for(n = 0; n < responses.size; n++) {
+            rb_hash_aset(vResult, rb_str_new2(responses.items[n].node), info_response_value(responses.items[n].response, raw));
+        }
+    }
+    info_responses_free(&responses);
+
+    return vResult;
+}
+
+/*
+ * call-seq:
+ *   namespace_stats(namespace) -> Hash
+ *   namespace_stats(namespace, policy_settings) -> Hash
+ *
+ * return namespace statistics: 'nodes' => Hash of node name => statistics
+ * and 'total' => objects and memory/device usage counters summed up across nodes
+ */
+VALUE client_namespace_stats(int argc, VALUE* vArgs, VALUE vSelf)
+{
+    VALUE vNamespace, vNodes, vTotal, vStats, vKey, vValue, vSum, vResult;
+    as_policy_info policy;
+    info_responses responses = { NULL, 0, 0, false };
+    char command[256];
+    uint32_t n;
+    int idx;
+
+    if (argc == 0 || argc > 2) {  // there should only be 1 or 2 arguments
+        rb_raise(rb_eArgError, "wrong number of arguments (%d for 1..2)", argc);
+    }
+
+    vNamespace = vArgs[0];
+    GET_STRING(vNamespace);
+
+    as_policy_info_init(&policy);
+    if (argc == 2 && TYPE(vArgs[1]) != T_NIL) {
+        SET_INFO_POLICY(policy, vArgs[1]);
+    }
+
+    snprintf(command, sizeof(command), "namespace/%s", StringValueCStr(vNamespace));
+    info_request(vSelf, &policy, NULL, command, &responses);
+
+    vNodes = rb_hash_new();
+    vTotal = rb_hash_new();
+    for(n = 0; n < responses.size; n++) {
+        vStats = info_response_value(responses.items[n].response, false);
+        if (TYPE(vStats) != T_HASH) {
+            continue;
+        }
+        rb_hash_aset(vNodes, rb_str_new2(responses.items[n].node), vStats);
+
+        for(idx = 0; namespace_totals[idx] != NULL; idx++) {
+            vKey = rb_str_new2(namespace_totals[idx]);
+            vValue = rb_hash_aref(vStats, vKey);
+            if (TYPE(vValue) != T_FIXNUM && TYPE(vValue) != T_BIGNUM) {
+                continue;
+            }
+            vSum = rb_hash_aref(vTotal, vKey);
+            rb_hash_aset(vTotal, vKey, TYPE(vSum) == T_NIL ? vValue : rb_funcall(vSum, rb_intern("+"), 1, vValue));
+        }
+    }
+    info_responses_free(&responses);
+
+    vResult = rb_hash_new();
+    rb_hash_aset(vResult, rb_str_new2("nodes"), vNodes);
+    rb_hash_aset(vResult, rb_str_new2("total"), vTotal);
+
+    return vResult;
+}
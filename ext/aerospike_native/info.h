@@ -0,0 +1,25 @@
+#ifndef INFO_H
+#define INFO_H
+
+#include "aerospike_native.h"
+#include <aerospike/as_node.h>
+
+#define INFO_NODES_COMMAND "node\nservice\nbuild\npartition-generation\nreplicas-master\nreplicas\n"
+
+typedef struct info_response_s {
+    char node[AS_NODE_NAME_SIZE];
+    char* response;
+} info_response;
+
+typedef struct info_responses_s {
+    info_response* items;
+    uint32_t size;
+    uint32_t capacity;
+    bool out_of_memory;
+} info_responses;
+
+VALUE client_nodes(int argc, VALUE* vArgs, VALUE vSelf);
+VALUE client_info(int argc, VALUE* vArgs, VALUE vSelf);
+VALUE client_namespace_stats(int argc, VALUE* vArgs, VALUE vSelf);
+
+#endif // INFO_H
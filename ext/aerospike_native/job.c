@@ -0,0 +1,271 @@
+#include "job.h"
+#include "client.h"
+#include <aerospike/aerospike_info.h>
+#include <aerospike/aerospike_scan.h>
+#include <aerospike/as_info.h>
+
+VALUE JobClass;
+
+typedef struct job_info_s {
+    int nodes;
+    int found;
+    int active;
+    int aborted;
+    uint64_t progress;
+    uint64_t records;
+} job_info;
+
+/*
+ * call-seq:
+ *   new(client, module, job_id) -> AerospikeNative::Job
+ *
+ * initialize handle of background scan or query, module is "scan" or "query"
+ */
+VALUE job_initialize(VALUE vSelf, VALUE vClient, VALUE vModule, VALUE vJobId)
+{
+    check_aerospike_client(vClient);
+    GET_STRING(vModule);
+    if (strcmp(StringValueCStr(vModule), JOB_MODULE_SCAN) != 0 && strcmp(StringValueCStr(vModule), JOB_MODULE_QUERY) != 0) {
+        rb_raise(rb_eArgError, "Incorrect job module (expected \"%s\" or \"%s\")", JOB_MODULE_SCAN, JOB_MODULE_QUERY);
+    }
+    NUM2ULL(vJobId);
+
+    rb_iv_set(vSelf, "@client", vClient);
+    rb_iv_set(vSelf, "@module", vModule);
+    rb_iv_set(vSelf, "@job_id", vJobId);
+
+    return vSelf;
+}
+
+VALUE rb_job_new(VALUE vClient, const char* module, uint64_t job_id)
+{
+    VALUE vParams[3];
+
+    vParams[0] = vClient;
+    vParams[1] = rb_str_new2(module);
+    vParams[2] = ULL2NUM(job_id);
+
+    return rb_class_new_instance(3, vParams, JobClass);
+}
+
+static bool job_info_callback(const as_error* err, const as_node* node, const char* req, char* res, void* udata)
+{
+    job_info* info = (job_info*) udata;
+    char* value = NULL;
+    char* token;
+    char* saveptr = NULL;
+
+    info->nodes++;
+    if (res == NULL || as_info_parse_single_response(res, &value) != AEROSPIKE_OK || value == NULL) {
+        return true;
+    }
+
+    // job is unknown on this node (finished long ago or never started)
+    if (strncmp(value, "ERROR", 5) == 0) {
+        return true;
+    }
+
+    info->found++;
+    for(token = strtok_r(value, ":", &saveptr); token != NULL; token = strtok_r(NULL, ":", &saveptr)) {
+        if (strncmp(token, "status=", 7) == 0) {
+            if (strncmp(token + 7, "active", 6) == 0) {
+                info->active++;
+            } else if (strstr(token + 7, "abort") != NULL) {
+                info->aborted++;
+            }
+        } else if (strncmp(token, "job-progress=", 13) == 0) {
+            info->progress += strtoull(token + 13, NULL, 10);
+        } else if (strncmp(token, "recs-read=", 10) == 0) {
+            info->records += strtoull(token + 10, NULL, 10);
+        }
+    }
+
+    return true;
+}
+
+static VALUE job_info_hash(uint32_t progress, uint64_t records, int status)
+{
+    VALUE vHash = rb_hash_new();
+
+    rb_hash_aset(vHash, rb_str_new2("progress_percent"), UINT2NUM(progress));
+    rb_hash_aset(vHash, rb_str_new2("records_scanned"), ULL2NUM(records));
+    rb_hash_aset(vHash, rb_str_new2("status"), INT2NUM(status));
+
+    return vHash;
+}
+
+/*
+ * call-seq:
+ *   info -> Hash
+ *   info(policy_settings) -> Hash
+ *
+ * return job progress in the same format as scan_info, query progress is collected from all nodes
+ */
+VALUE job_info_get(int argc, VALUE* vArgs, VALUE vSelf)
+{
+    VALUE vClient, vModule;
+    aerospike* ptr;
+    as_error err;
+    uint64_t job_id;
+
+    if (argc > 1) {  // there should only be 0 or 1 argument
+        rb_raise(rb_eArgError, "wrong number of arguments (%d for 0..1)", argc);
+    }
+
+    vClient = rb_iv_get(vSelf, "@client");
+    vModule = rb_iv_get(vSelf, "@module");
+    job_id = NUM2ULL(rb_iv_get(vSelf, "@job_id"));
+    Data_Get_Struct(vClient, aerospike, ptr);
+
+    if (strcmp(StringValueCStr(vModule), JOB_MODULE_SCAN) == 0) {
+        as_policy_scan policy;
+        as_scan_info info;
+
+        as_policy_scan_init(&policy);
+        if (argc == 1 && TYPE(vArgs[0]) != T_NIL) {
+            SET_SCAN_POLICY(policy, vArgs[0]);
+        }
+
+        if (aerospike_scan_info(ptr, &err, &policy, job_id, &info) != AEROSPIKE_OK) {
+            raise_aerospike_exception(err.code, err.message);
+        }
+
+        return job_info_hash(info.progress_pct, info.records_scanned, info.status);
+    } else {
+        as_policy_info policy;
+        job_info info;
+        char command[128];
+        int status;
+
+        as_policy_info_init(&policy);
+        if (argc == 1 && TYPE(vArgs[0]) != T_NIL) {
+            SET_INFO_POLICY(policy, vArgs[0]);
+        }
+
+        memset(&info, 0, sizeof(info));
+        snprintf(command, sizeof(command), "jobs:module=query;cmd=get-job;trid=%llu", (unsigned long long) job_id);
+        if (aerospike_info_foreach(ptr, &err, &policy, command, job_info_callback, &info) != AEROSPIKE_OK) {
+            raise_aerospike_exception(err.code, err.message);
+        }
+
+        if (info.found == 0) {
+            status = AS_SCAN_STATUS_UNDEF;
+        } else if (info.aborted > 0) {
+            status = AS_SCAN_STATUS_ABORTED;
+        } else if (info.active > 0) {
+            status = AS_SCAN_STATUS_INPROGRESS;
+        } else {
+            status = AS_SCAN_STATUS_COMPLETED;
+        }
+
+        return job_info_hash(info.found > 0 ? (uint32_t)(info.progress / info.found) : 0, info.records, status);
+    }
+}
+
+/*
+ * call-seq:
+ *   done? -> true or false
+ *
+ * check job is completed or aborted. Job handle is created only after job was started,
+ * so unknown job status means that server already removed the finished job from its jobs list
+ */
+VALUE job_is_done(VALUE vSelf)
+{
+    VALUE vInfo = job_info_get(0, NULL, vSelf);
+    int status = NUM2INT(rb_hash_aref(vInfo, rb_str_new2("status")));
+
+    return (status == AS_SCAN_STATUS_COMPLETED || status == AS_SCAN_STATUS_ABORTED || status == AS_SCAN_STATUS_UNDEF) ? Qtrue : Qfalse;
+}
+
+/*
+ * call-seq:
+ *   wait -> true
+ *   wait(timeout_ms) -> true or false
+ *
+ * poll job with exponential backoff (10ms up to 1s) until it's done, GVL is released between polls
+ */
+VALUE job_wait(int argc, VALUE* vArgs, VALUE vSelf)
+{
+    struct timeval delay;
+    long timeout = -1, waited = 0, backoff = 10;
+
+    if (argc > 1) {  // there should only be 0 or 1 argument
+        rb_raise(rb_eArgError, "wrong number of arguments (%d for 0..1)", argc);
+    }
+
+    if (argc == 1 && TYPE(vArgs[0]) != T_NIL) {
+        Check_Type(vArgs[0], T_FIXNUM);
+        timeout = FIX2LONG(vArgs[0]);
+    }
+
+    while (job_is_done(vSelf) != Qtrue) {
+        if (timeout >= 0 && waited >= timeout) {
+            return Qfalse;
+        }
+        if (timeout >= 0 && waited + backoff > timeout) {
+            backoff = timeout - waited;
+        }
+
+        delay.tv_sec = backoff / 1000;
+        delay.tv_usec = (backoff % 1000) * 1000;
+        rb_thread_wait_for(delay);
+
+        waited += backoff;
+        backoff = backoff * 2 > 1000 ? 1000 : backoff * 2;
+    }
+
+    return Qtrue;
+}
+
+/*
+ * call-seq:
+ *   cancel -> true
+ *   cancel(policy_settings) -> true
+ *
+ * abort job on all nodes
+ */
+VALUE job_cancel(int argc, VALUE* vArgs, VALUE vSelf)
+{
+    VALUE vClient, vModule;
+    aerospike* ptr;
+    as_error err;
+    as_policy_info policy;
+    job_info info;
+    char command[128];
+
+    if (argc > 1) {  // there should only be 0 or 1 argument
+        rb_raise(rb_eArgError, "wrong number of arguments (%d for 0..1)", argc);
+    }
+
+    as_policy_info_init(&policy);
+    if (argc == 1 && TYPE(vArgs[0]) != T_NIL) {
+        SET_INFO_POLICY(policy, vArgs[0]);
+    }
+
+    vClient = rb_iv_get(vSelf, "@client");
+    vModule = rb_iv_get(vSelf, "@module");
+    Data_Get_Struct(vClient, aerospike, ptr);
+
+    memset(&info, 0, sizeof(info));
+    snprintf(command, sizeof(command), "jobs:module=%s;cmd=kill-job;trid=%llu",
+        StringValueCStr(vModule), NUM2ULL(rb_iv_get(vSelf, "@job_id")));
+    if (aerospike_info_foreach(ptr, &err, &policy, command, job_info_callback, &info) != AEROSPIKE_OK) {
+        raise_aerospike_exception(err.code, err.message);
+    }
+
+    return Qtrue;
+}
+
+void define_job()
+{
+    JobClass = rb_define_class_under(AerospikeNativeClass, "Job", rb_cObject);
+    rb_define_method(JobClass, "initialize", job_initialize, 3);
+    rb_define_method(JobClass, "info", job_info_get, -1);
+    rb_define_method(JobClass, "done?", job_is_done, 0);
+    rb_define_method(JobClass, "wait", job_wait, -1);
+    rb_define_method(JobClass, "cancel", job_cancel, -1);
+
+    rb_define_attr(JobClass, "client", 1, 0);
+    rb_define_attr(JobClass, "module", 1, 0);
+    rb_define_attr(JobClass, "job_id", 1, 0);
+}
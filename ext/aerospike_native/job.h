@@ -0,0 +1,13 @@
+#ifndef JOB_H
+#define JOB_H
+
+#include "aerospike_native.h"
+
+#define JOB_MODULE_SCAN "scan"
+#define JOB_MODULE_QUERY "query"
+
+RUBY_EXTERN VALUE JobClass;
+void define_job();
+VALUE rb_job_new(VALUE vClient, const char* module, uint64_t job_id);
+
+#endif // JOB_H
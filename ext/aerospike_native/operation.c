@@ -1,4 +1,17 @@
 #include "operation.h"
+#include "record.h"
+#include <aerospike/as_record.h>
+#ifdef HAVE_AEROSPIKE_AS_CDT_CTX_H
+#include <aerospike/as_list_operations.h>
+#include <aerospike/as_map_operations.h>
+#endif
+#ifdef HAVE_AEROSPIKE_AS_HLL_OPERATIONS_H
+#include <aerospike/as_arraylist.h>
+#include <aerospike/as_hll_operations.h>
+#endif
+#ifdef HAVE_AEROSPIKE_AS_BIT_OPERATIONS_H
+#include <aerospike/as_bit_operations.h>
+#endif
 
 VALUE OperationClass;
 
@@ -83,13 +96,15 @@ VALUE operation_prepend(VALUE vSelf, VALUE vBinName, VALUE vBinValue)
  * call-seq:
  *   increment(bin_name, bin_value) -> AerospikeNative::Operation
  *
- * initialize new increment operation
+ * initialize new increment operation, bin_value is 64-bit integer or float
  */
 VALUE operation_increment(VALUE vSelf, VALUE vBinName, VALUE vBinValue)
 {
     VALUE vArgs[3];
 
-    Check_Type(vBinValue, T_FIXNUM);
+    if (TYPE(vBinValue) != T_FIXNUM && TYPE(vBinValue) != T_BIGNUM && TYPE(vBinValue) != T_FLOAT) {
+        rb_raise(rb_eTypeError, "wrong argument type (expected Integer or Float)");
+    }
 
     vArgs[0] = INT2NUM(OPERATION_INCREMENT);
     vArgs[1] = vBinName;
@@ -129,6 +144,849 @@ VALUE operation_read(VALUE vSelf, VALUE vBinName)
     return rb_class_new_instance(3, vArgs, vSelf);
 }
 
+static VALUE operation_new(VALUE vClass, int op_type, VALUE vBinName, VALUE vBinValue)
+{
+    VALUE vArgs[3];
+
+    vArgs[0] = INT2NUM(op_type);
+    vArgs[1] = vBinName;
+    vArgs[2] = vBinValue;
+    return rb_class_new_instance(3, vArgs, vClass);
+}
+
+/*
+ * call-seq:
+ *   list_append(bin_name, value) -> AerospikeNative::Operation
+ *
+ * initialize new operation which appends value to list bin, result is list size
+ */
+VALUE operation_list_append(VALUE vSelf, VALUE vBinName, VALUE vValue)
+{
+    return operation_new(vSelf, OPERATION_LIST_APPEND, vBinName, vValue);
+}
+
+/*
+ * call-seq:
+ *   list_append_unique(bin_name, value) -> AerospikeNative::Operation
+ *
+ * initialize new operation which appends value to list bin only if list doesn't contain it yet,
+ * duplicate value is skipped without error, result is list size
+ */
+VALUE operation_list_append_unique(VALUE vSelf, VALUE vBinName, VALUE vValue)
+{
+    return operation_new(vSelf, OPERATION_LIST_APPEND_UNIQUE, vBinName, vValue);
+}
+
+/*
+ * call-seq:
+ *   list_insert(bin_name, index, value) -> AerospikeNative::Operation
+ *
+ * initialize new operation which inserts value into list bin at index, result is list size
+ */
+VALUE operation_list_insert(VALUE vSelf, VALUE vBinName, VALUE vIndex, VALUE vValue)
+{
+    Check_Type(vIndex, T_FIXNUM);
+
+    return operation_new(vSelf, OPERATION_LIST_INSERT, vBinName, rb_ary_new3(2, vIndex, vValue));
+}
+
+/*
+ * call-seq:
+ *   list_pop(bin_name, index) -> AerospikeNative::Operation
+ *
+ * initialize new operation which removes item at index from list bin, result is removed item
+ */
+VALUE operation_list_pop(VALUE vSelf, VALUE vBinName, VALUE vIndex)
+{
+    Check_Type(vIndex, T_FIXNUM);
+
+    return operation_new(vSelf, OPERATION_LIST_POP, vBinName, vIndex);
+}
+
+/*
+ * call-seq:
+ *   list_remove_range(bin_name, index, count) -> AerospikeNative::Operation
+ *
+ * initialize new operation which removes count items starting at index from list bin, result is number of removed items
+ */
+VALUE operation_list_remove_range(VALUE vSelf, VALUE vBinName, VALUE vIndex, VALUE vCount)
+{
+    Check_Type(vIndex, T_FIXNUM);
+    Check_Type(vCount, T_FIXNUM);
+
+    return operation_new(vSelf, OPERATION_LIST_REMOVE_RANGE, vBinName, rb_ary_new3(2, vIndex, vCount));
+}
+
+/*
+ * call-seq:
+ *   list_get_range(bin_name, index) -> AerospikeNative::Operation
+ *   list_get_range(bin_name, index, count) -> AerospikeNative::Operation
+ *
+ * initialize new operation which reads count items (or all items up to the end) starting at index from list bin
+ */
+VALUE operation_list_get_range(int argc, VALUE* vArgs, VALUE vSelf)
+{
+    VALUE vCount = Qnil;
+
+    if (argc > 3 || argc < 2) {  // there should only be 2 or 3 arguments
+        rb_raise(rb_eArgError, "wrong number of arguments (%d for 2..3)", argc);
+    }
+
+    Check_Type(vArgs[1], T_FIXNUM);
+    if (argc == 3 && TYPE(vArgs[2]) != T_NIL) {
+        Check_Type(vArgs[2], T_FIXNUM);
+        vCount = vArgs[2];
+    }
+
+    return operation_new(vSelf, OPERATION_LIST_GET_RANGE, vArgs[0], rb_ary_new3(2, vArgs[1], vCount));
+}
+
+/*
+ * call-seq:
+ *   list_trim(bin_name, index, count) -> AerospikeNative::Operation
+ *
+ * initialize new operation which keeps only count items starting at index in list bin, result is number of removed items
+ */
+VALUE operation_list_trim(VALUE vSelf, VALUE vBinName, VALUE vIndex, VALUE vCount)
+{
+    Check_Type(vIndex, T_FIXNUM);
+    Check_Type(vCount, T_FIXNUM);
+
+    return operation_new(vSelf, OPERATION_LIST_TRIM, vBinName, rb_ary_new3(2, vIndex, vCount));
+}
+
+/*
+ * call-seq:
+ *   list_size(bin_name) -> AerospikeNative::Operation
+ *
+ * initialize new operation which reads list bin size
+ */
+VALUE operation_list_size(VALUE vSelf, VALUE vBinName)
+{
+    return operation_new(vSelf, OPERATION_LIST_SIZE, vBinName, Qnil);
+}
+
+/*
+ * call-seq:
+ *   list_sort(bin_name) -> AerospikeNative::Operation
+ *   list_sort(bin_name, flags) -> AerospikeNative::Operation
+ *
+ * initialize new operation which sorts list bin, flags are AerospikeNative::LIST_SORT_DEFAULT or AerospikeNative::LIST_SORT_DROP_DUPLICATES
+ */
+VALUE operation_list_sort(int argc, VALUE* vArgs, VALUE vSelf)
+{
+    VALUE vFlags = INT2FIX(LIST_SORT_DEFAULT);
+
+    if (argc > 2 || argc < 1) {  // there should only be 1 or 2 arguments
+        rb_raise(rb_eArgError, "wrong number of arguments (%d for 1..2)", argc);
+    }
+
+    if (argc == 2 && TYPE(vArgs[1]) != T_NIL) {
+        Check_Type(vArgs[1], T_FIXNUM);
+        vFlags = vArgs[1];
+    }
+
+    return operation_new(vSelf, OPERATION_LIST_SORT, vArgs[0], vFlags);
+}
+
+/*
+ * add list operation to ops, return true when operation result should be read
+ */
+bool operation_add_list(as_operations* ops, int op_type, VALUE vBinName, VALUE vBinValue)
+{
+#if defined(HAVE_AEROSPIKE_AS_CDT_CTX_H)
+    as_list_policy policy;
+#endif
+#if defined(HAVE_AEROSPIKE_AS_CDT_CTX_H) || defined(HAVE_AS_OPERATIONS_ADD_LIST_APPEND)
+    char* name = StringValueCStr(vBinName);
+#endif
+
+    switch(op_type) {
+#if defined(HAVE_AEROSPIKE_AS_CDT_CTX_H)
+    case OPERATION_LIST_APPEND:
+        as_operations_list_append(ops, name, NULL, NULL, rb_value_to_as_val(vBinValue));
+        break;
+    case OPERATION_LIST_APPEND_UNIQUE:
+        as_list_policy_set(&policy, AS_LIST_UNORDERED, AS_LIST_WRITE_ADD_UNIQUE | AS_LIST_WRITE_NO_FAIL);
+        as_operations_list_append(ops, name, NULL, &policy, rb_value_to_as_val(vBinValue));
+        break;
+    case OPERATION_LIST_INSERT:
+        as_operations_list_insert(ops, name, NULL, NULL, NUM2LL(rb_ary_entry(vBinValue, 0)), rb_value_to_as_val(rb_ary_entry(vBinValue, 1)));
+        break;
+    case OPERATION_LIST_POP:
+        as_operations_list_pop(ops, name, NULL, NUM2LL(vBinValue));
+        break;
+    case OPERATION_LIST_REMOVE_RANGE:
+        as_operations_list_remove_range(ops, name, NULL, NUM2LL(rb_ary_entry(vBinValue, 0)), NUM2ULL(rb_ary_entry(vBinValue, 1)));
+        break;
+    case OPERATION_LIST_GET_RANGE:
+        if (TYPE(rb_ary_entry(vBinValue, 1)) == T_NIL) {
+            as_operations_list_get_range_from(ops, name, NULL, NUM2LL(rb_ary_entry(vBinValue, 0)));
+        } else {
+            as_operations_list_get_range(ops, name, NULL, NUM2LL(rb_ary_entry(vBinValue, 0)), NUM2ULL(rb_ary_entry(vBinValue, 1)));
+        }
+        break;
+    case OPERATION_LIST_TRIM:
+        as_operations_list_trim(ops, name, NULL, NUM2LL(rb_ary_entry(vBinValue, 0)), NUM2ULL(rb_ary_entry(vBinValue, 1)));
+        break;
+    case OPERATION_LIST_SIZE:
+        as_operations_list_size(ops, name, NULL);
+        break;
+    case OPERATION_LIST_SORT:
+        as_operations_list_sort(ops, name, NULL, (as_list_sort_flags) NUM2INT(vBinValue));
+        return false;
+#elif defined(HAVE_AS_OPERATIONS_ADD_LIST_APPEND)
+    case OPERATION_LIST_APPEND:
+        as_operations_add_list_append(ops, name, rb_value_to_as_val(vBinValue));
+        break;
+    case OPERATION_LIST_INSERT:
+        as_operations_add_list_insert(ops, name, NUM2LL(rb_ary_entry(vBinValue, 0)), rb_value_to_as_val(rb_ary_entry(vBinValue, 1)));
+        break;
+    case OPERATION_LIST_POP:
+        as_operations_add_list_pop(ops, name, NUM2LL(vBinValue));
+        break;
+    case OPERATION_LIST_REMOVE_RANGE:
+        as_operations_add_list_remove_range(ops, name, NUM2LL(rb_ary_entry(vBinValue, 0)), NUM2ULL(rb_ary_entry(vBinValue, 1)));
+        break;
+    case OPERATION_LIST_GET_RANGE:
+        if (TYPE(rb_ary_entry(vBinValue, 1)) == T_NIL) {
+            as_operations_add_list_get_range_from(ops, name, NUM2LL(rb_ary_entry(vBinValue, 0)));
+        } else {
+            as_operations_add_list_get_range(ops, name, NUM2LL(rb_ary_entry(vBinValue, 0)), NUM2ULL(rb_ary_entry(vBinValue, 1)));
+        }
+        break;
+    case OPERATION_LIST_TRIM:
+        as_operations_add_list_trim(ops, name, NUM2LL(rb_ary_entry(vBinValue, 0)), NUM2ULL(rb_ary_entry(vBinValue, 1)));
+        break;
+    case OPERATION_LIST_SIZE:
+        as_operations_add_list_size(ops, name);
+        break;
+    case OPERATION_LIST_APPEND_UNIQUE:
+    case OPERATION_LIST_SORT:
+        rb_raise(rb_eNotImpError, "list operation is not supported by aerospike client library");
+        break;
+#else
+    case OPERATION_LIST_APPEND:
+    case OPERATION_LIST_APPEND_UNIQUE:
+    case OPERATION_LIST_INSERT:
+    case OPERATION_LIST_POP:
+    case OPERATION_LIST_REMOVE_RANGE:
+    case OPERATION_LIST_GET_RANGE:
+    case OPERATION_LIST_TRIM:
+    case OPERATION_LIST_SIZE:
+    case OPERATION_LIST_SORT:
+        rb_raise(rb_eNotImpError, "list operations are not supported by aerospike client library");
+        break;
+#endif
+    default:
+        rb_raise(rb_eArgError, "Incorrect operation type");
+        break;
+    }
+
+    return true;
+}
+
+static VALUE operation_map_return_type(int argc, VALUE* vArgs, int idx, int default_type)
+{
+    if (argc <= idx || TYPE(vArgs[idx]) == T_NIL) {
+        return INT2FIX(default_type);
+    }
+
+    Check_Type(vArgs[idx], T_FIXNUM);
+    if (FIX2INT(vArgs[idx]) < MAP_RETURN_NONE || FIX2INT(vArgs[idx]) > MAP_RETURN_KEY_VALUE) {
+        rb_raise(rb_eArgError, "Incorrect map return type");
+    }
+
+    return vArgs[idx];
+}
+
+/*
+ * call-seq:
+ *   map_put(bin_name, key, value) -> AerospikeNative::Operation
+ *
+ * initialize new operation which puts key and value into map bin, result is map size
+ */
+VALUE operation_map_put(VALUE vSelf, VALUE vBinName, VALUE vKey, VALUE vValue)
+{
+    return operation_new(vSelf, OPERATION_MAP_PUT, vBinName, rb_ary_new3(2, vKey, vValue));
+}
+
+/*
+ * call-seq:
+ *   map_put_items(bin_name, items) -> AerospikeNative::Operation
+ *
+ * initialize new operation which puts all items of hash into map bin, result is map size
+ */
+VALUE operation_map_put_items(VALUE vSelf, VALUE vBinName, VALUE vItems)
+{
+    Check_Type(vItems, T_HASH);
+
+    return operation_new(vSelf, OPERATION_MAP_PUT_ITEMS, vBinName, vItems);
+}
+
+/*
+ * call-seq:
+ *   map_increment(bin_name, key, delta) -> AerospikeNative::Operation
+ *
+ * initialize new operation which increments map value of key by integer or float delta, result is new value
+ */
+VALUE operation_map_increment(VALUE vSelf, VALUE vBinName, VALUE vKey, VALUE vDelta)
+{
+    if (TYPE(vDelta) != T_FIXNUM && TYPE(vDelta) != T_FLOAT) {
+        rb_raise(rb_eTypeError, "wrong argument type (expected Fixnum or Float)");
+    }
+
+    return operation_new(vSelf, OPERATION_MAP_INCREMENT, vBinName, rb_ary_new3(2, vKey, vDelta));
+}
+
+/*
+ * call-seq:
+ *   map_remove_by_key(bin_name, key) -> AerospikeNative::Operation
+ *   map_remove_by_key(bin_name, key, return_type) -> AerospikeNative::Operation
+ *
+ * initialize new operation which removes key from map bin, return_type is one of AerospikeNative::MAP_RETURN_* (none by default)
+ */
+VALUE operation_map_remove_by_key(int argc, VALUE* vArgs, VALUE vSelf)
+{
+    if (argc > 3 || argc < 2) {  // there should only be 2 or 3 arguments
+        rb_raise(rb_eArgError, "wrong number of arguments (%d for 2..3)", argc);
+    }
+
+    return operation_new(vSelf, OPERATION_MAP_REMOVE_BY_KEY, vArgs[0], rb_ary_new3(2, vArgs[1], operation_map_return_type(argc, vArgs, 2, MAP_RETURN_NONE)));
+}
+
+/*
+ * call-seq:
+ *   map_remove_by_value(bin_name, value) -> AerospikeNative::Operation
+ *   map_remove_by_value(bin_name, value, return_type) -> AerospikeNative::Operation
+ *
+ * initialize new operation which removes all items with value from map bin, return_type is one of AerospikeNative::MAP_RETURN_* (none by default)
+ */
+VALUE operation_map_remove_by_value(int argc, VALUE* vArgs, VALUE vSelf)
+{
+    if (argc > 3 || argc < 2) {  // there should only be 2 or 3 arguments
+        rb_raise(rb_eArgError, "wrong number of arguments (%d for 2..3)", argc);
+    }
+
+    return operation_new(vSelf, OPERATION_MAP_REMOVE_BY_VALUE, vArgs[0], rb_ary_new3(2, vArgs[1], operation_map_return_type(argc, vArgs, 2, MAP_RETURN_NONE)));
+}
+
+/*
+ * call-seq:
+ *   map_remove_by_rank(bin_name, rank) -> AerospikeNative::Operation
+ *   map_remove_by_rank(bin_name, rank, return_type) -> AerospikeNative::Operation
+ *
+ * initialize new operation which removes item with value rank (-1 is the largest) from map bin, return_type is one of AerospikeNative::MAP_RETURN_* (none by default)
+ */
+VALUE operation_map_remove_by_rank(int argc, VALUE* vArgs, VALUE vSelf)
+{
+    if (argc > 3 || argc < 2) {  // there should only be 2 or 3 arguments
+        rb_raise(rb_eArgError, "wrong number of arguments (%d for 2..3)", argc);
+    }
+
+    Check_Type(vArgs[1], T_FIXNUM);
+
+    return operation_new(vSelf, OPERATION_MAP_REMOVE_BY_RANK, vArgs[0], rb_ary_new3(2, vArgs[1], operation_map_return_type(argc, vArgs, 2, MAP_RETURN_NONE)));
+}
+
+/*
+ * call-seq:
+ *   map_get_by_key_range(bin_name, key_begin, key_end) -> AerospikeNative::Operation
+ *   map_get_by_key_range(bin_name, key_begin, key_end, return_type) -> AerospikeNative::Operation
+ *
+ * initialize new operation which reads map items with key_begin <= key < key_end (nil key_end means no upper bound),
+ * return_type is one of AerospikeNative::MAP_RETURN_* (key-value pairs by default)
+ */
+VALUE operation_map_get_by_key_range(int argc, VALUE* vArgs, VALUE vSelf)
+{
+    if (argc > 4 || argc < 3) {  // there should only be 3 or 4 arguments
+        rb_raise(rb_eArgError, "wrong number of arguments (%d for 3..4)", argc);
+    }
+
+    return operation_new(vSelf, OPERATION_MAP_GET_BY_KEY_RANGE, vArgs[0], rb_ary_new3(3, vArgs[1], vArgs[2], operation_map_return_type(argc, vArgs, 3, MAP_RETURN_KEY_VALUE)));
+}
+
+/*
+ * call-seq:
+ *   map_get_by_rank_range(bin_name, rank) -> AerospikeNative::Operation
+ *   map_get_by_rank_range(bin_name, rank, count) -> AerospikeNative::Operation
+ *   map_get_by_rank_range(bin_name, rank, count, return_type) -> AerospikeNative::Operation
+ *
+ * initialize new operation which reads count map items (or all up to the largest) starting at value rank,
+ * use rank -N and count N to read top N items, return_type is one of AerospikeNative::MAP_RETURN_* (key-value pairs by default)
+ */
+VALUE operation_map_get_by_rank_range(int argc, VALUE* vArgs, VALUE vSelf)
+{
+    VALUE vCount = Qnil;
+
+    if (argc > 4 || argc < 2) {  // there should only be 2..4 arguments
+        rb_raise(rb_eArgError, "wrong number of arguments (%d for 2..4)", argc);
+    }
+
+    Check_Type(vArgs[1], T_FIXNUM);
+    if (argc > 2 && TYPE(vArgs[2]) != T_NIL) {
+        Check_Type(vArgs[2], T_FIXNUM);
+        vCount = vArgs[2];
+    }
+
+    return operation_new(vSelf, OPERATION_MAP_GET_BY_RANK_RANGE, vArgs[0], rb_ary_new3(3, vArgs[1], vCount, operation_map_return_type(argc, vArgs, 3, MAP_RETURN_KEY_VALUE)));
+}
+
+/*
+ * add map operation to ops, return true when operation result should be read
+ */
+bool operation_add_map(as_operations* ops, int op_type, VALUE vBinName, VALUE vBinValue)
+{
+#ifdef HAVE_AEROSPIKE_AS_CDT_CTX_H
+    as_map_policy policy;
+    char* name = StringValueCStr(vBinName);
+    VALUE vEnd;
+
+    as_map_policy_init(&policy);
+
+    switch(op_type) {
+    case OPERATION_MAP_PUT:
+        as_operations_map_put(ops, name, NULL, &policy, rb_value_to_as_val(rb_ary_entry(vBinValue, 0)), rb_value_to_as_val(rb_ary_entry(vBinValue, 1)));
+        break;
+    case OPERATION_MAP_PUT_ITEMS:
+        as_operations_map_put_items(ops, name, NULL, &policy, (as_map*) rb_value_to_as_val(vBinValue));
+        break;
+    case OPERATION_MAP_INCREMENT:
+        as_operations_map_increment(ops, name, NULL, &policy, rb_value_to_as_val(rb_ary_entry(vBinValue, 0)), rb_value_to_as_val(rb_ary_entry(vBinValue, 1)));
+        break;
+    case OPERATION_MAP_REMOVE_BY_KEY:
+        as_operations_map_remove_by_key(ops, name, NULL, rb_value_to_as_val(rb_ary_entry(vBinValue, 0)), (as_map_return_type) NUM2INT(rb_ary_entry(vBinValue, 1)));
+        break;
+    case OPERATION_MAP_REMOVE_BY_VALUE:
+        as_operations_map_remove_by_value(ops, name, NULL, rb_value_to_as_val(rb_ary_entry(vBinValue, 0)), (as_map_return_type) NUM2INT(rb_ary_entry(vBinValue, 1)));
+        break;
+    case OPERATION_MAP_REMOVE_BY_RANK:
+        as_operations_map_remove_by_rank(ops, name, NULL, NUM2LL(rb_ary_entry(vBinValue, 0)), (as_map_return_type) NUM2INT(rb_ary_entry(vBinValue, 1)));
+        break;
+    case OPERATION_MAP_GET_BY_KEY_RANGE:
+        vEnd = rb_ary_entry(vBinValue, 1);
+        as_operations_map_get_by_key_range(ops, name, NULL, rb_value_to_as_val(rb_ary_entry(vBinValue, 0)),
+            TYPE(vEnd) == T_NIL ? NULL : rb_value_to_as_val(vEnd), (as_map_return_type) NUM2INT(rb_ary_entry(vBinValue, 2)));
+        break;
+    case OPERATION_MAP_GET_BY_RANK_RANGE:
+        if (TYPE(rb_ary_entry(vBinValue, 1)) == T_NIL) {
+            as_operations_map_get_by_rank_range_to_end(ops, name, NULL, NUM2LL(rb_ary_entry(vBinValue, 0)), (as_map_return_type) NUM2INT(rb_ary_entry(vBinValue, 2)));
+        } else {
+            as_operations_map_get_by_rank_range(ops, name, NULL, NUM2LL(rb_ary_entry(vBinValue, 0)), NUM2ULL(rb_ary_entry(vBinValue, 1)), (as_map_return_type) NUM2INT(rb_ary_entry(vBinValue, 2)));
+        }
+        break;
+    default:
+        rb_raise(rb_eArgError, "Incorrect operation type");
+        break;
+    }
+
+    return true;
+#else
+    rb_raise(rb_eNotImpError, "map operations are not supported by aerospike client library");
+    return false;
+#endif
+}
+
+/*
+ * call-seq:
+ *   hll_add(bin_name, values) -> AerospikeNative::Operation
+ *   hll_add(bin_name, values, index_bit_count) -> AerospikeNative::Operation
+ *
+ * initialize new operation which adds array of values to HLL bin (bin is created with index_bit_count 4..16, 14 by default),
+ * result is number of values which changed HLL
+ */
+VALUE operation_hll_add(int argc, VALUE* vArgs, VALUE vSelf)
+{
+    VALUE vIndexBits = INT2FIX(HLL_DEFAULT_INDEX_BITS);
+
+    if (argc > 3 || argc < 2) {  // there should only be 2 or 3 arguments
+        rb_raise(rb_eArgError, "wrong number of arguments (%d for 2..3)", argc);
+    }
+
+    Check_Type(vArgs[1], T_ARRAY);
+    if (argc == 3 && TYPE(vArgs[2]) != T_NIL) {
+        Check_Type(vArgs[2], T_FIXNUM);
+        vIndexBits = vArgs[2];
+    }
+
+    return operation_new(vSelf, OPERATION_HLL_ADD, vArgs[0], rb_ary_new3(2, vArgs[1], vIndexBits));
+}
+
+/*
+ * call-seq:
+ *   hll_get_count(bin_name) -> AerospikeNative::Operation
+ *
+ * initialize new operation which reads estimated number of unique values in HLL bin
+ */
+VALUE operation_hll_get_count(VALUE vSelf, VALUE vBinName)
+{
+    return operation_new(vSelf, OPERATION_HLL_GET_COUNT, vBinName, Qnil);
+}
+
+/*
+ * call-seq:
+ *   hll_union(bin_name, hlls) -> AerospikeNative::Operation
+ *
+ * initialize new operation which stores union of HLL bin and array of HLL values (binary strings read from HLL bins) into the bin
+ */
+VALUE operation_hll_union(VALUE vSelf, VALUE vBinName, VALUE vHlls)
+{
+    Check_Type(vHlls, T_ARRAY);
+
+    return operation_new(vSelf, OPERATION_HLL_UNION, vBinName, vHlls);
+}
+
+/*
+ * call-seq:
+ *   hll_union_count(bin_name, hlls) -> AerospikeNative::Operation
+ *
+ * initialize new operation which reads estimated number of unique values in union of HLL bin and array of HLL values
+ */
+VALUE operation_hll_union_count(VALUE vSelf, VALUE vBinName, VALUE vHlls)
+{
+    Check_Type(vHlls, T_ARRAY);
+
+    return operation_new(vSelf, OPERATION_HLL_UNION_COUNT, vBinName, vHlls);
+}
+
+/*
+ * call-seq:
+ *   hll_intersect_count(bin_name, hlls) -> AerospikeNative::Operation
+ *
+ * initialize new operation which reads estimated number of unique values in intersection of HLL bin and array of HLL values
+ */
+VALUE operation_hll_intersect_count(VALUE vSelf, VALUE vBinName, VALUE vHlls)
+{
+    Check_Type(vHlls, T_ARRAY);
+
+    return operation_new(vSelf, OPERATION_HLL_INTERSECT_COUNT, vBinName, vHlls);
+}
+
+/*
+ * call-seq:
+ *   bit_resize(bin_name, byte_size) -> AerospikeNative::Operation
+ *
+ * initialize new operation which resizes bytes bin (creating it if needed), new bytes are zero
+ */
+VALUE operation_bit_resize(VALUE vSelf, VALUE vBinName, VALUE vByteSize)
+{
+    Check_Type(vByteSize, T_FIXNUM);
+
+    return operation_new(vSelf, OPERATION_BIT_RESIZE, vBinName, vByteSize);
+}
+
+/*
+ * call-seq:
+ *   bit_set(bin_name, bit_offset, bit_size, value) -> AerospikeNative::Operation
+ *
+ * initialize new operation which overwrites bit_size bits at bit_offset of bytes bin with bits of value (binary string)
+ */
+VALUE operation_bit_set(VALUE vSelf, VALUE vBinName, VALUE vBitOffset, VALUE vBitSize, VALUE vValue)
+{
+    Check_Type(vBitOffset, T_FIXNUM);
+    Check_Type(vBitSize, T_FIXNUM);
+    Check_Type(vValue, T_STRING);
+
+    return operation_new(vSelf, OPERATION_BIT_SET, vBinName, rb_ary_new3(3, vBitOffset, vBitSize, vValue));
+}
+
+/*
+ * call-seq:
+ *   bit_or(bin_name, bit_offset, bit_size, value) -> AerospikeNative::Operation
+ *
+ * initialize new operation which applies bitwise or of value (binary string) to bit_size bits at bit_offset of bytes bin
+ */
+VALUE operation_bit_or(VALUE vSelf, VALUE vBinName, VALUE vBitOffset, VALUE vBitSize, VALUE vValue)
+{
+    Check_Type(vBitOffset, T_FIXNUM);
+    Check_Type(vBitSize, T_FIXNUM);
+    Check_Type(vValue, T_STRING);
+
+    return operation_new(vSelf, OPERATION_BIT_OR, vBinName, rb_ary_new3(3, vBitOffset, vBitSize, vValue));
+}
+
+/*
+ * call-seq:
+ *   bit_get(bin_name, bit_offset, bit_size) -> AerospikeNative::Operation
+ *
+ * initialize new operation which reads bit_size bits at bit_offset of bytes bin, result is binary string
+ */
+VALUE operation_bit_get(VALUE vSelf, VALUE vBinName, VALUE vBitOffset, VALUE vBitSize)
+{
+    Check_Type(vBitOffset, T_FIXNUM);
+    Check_Type(vBitSize, T_FIXNUM);
+
+    return operation_new(vSelf, OPERATION_BIT_GET, vBinName, rb_ary_new3(2, vBitOffset, vBitSize));
+}
+
+/*
+ * call-seq:
+ *   bit_count(bin_name, bit_offset, bit_size) -> AerospikeNative::Operation
+ *
+ * initialize new operation which counts set bits among bit_size bits at bit_offset of bytes bin
+ */
+VALUE operation_bit_count(VALUE vSelf, VALUE vBinName, VALUE vBitOffset, VALUE vBitSize)
+{
+    Check_Type(vBitOffset, T_FIXNUM);
+    Check_Type(vBitSize, T_FIXNUM);
+
+    return operation_new(vSelf, OPERATION_BIT_COUNT, vBinName, rb_ary_new3(2, vBitOffset, vBitSize));
+}
+
+/*
+ * call-seq:
+ *   bit_lscan(bin_name, bit_offset, bit_size, value) -> AerospikeNative::Operation
+ *
+ * initialize new operation which finds position of the first bit equal to value (true or false) among bit_size bits at bit_offset, result is -1 if not found
+ */
+VALUE operation_bit_lscan(VALUE vSelf, VALUE vBinName, VALUE vBitOffset, VALUE vBitSize, VALUE vValue)
+{
+    Check_Type(vBitOffset, T_FIXNUM);
+    Check_Type(vBitSize, T_FIXNUM);
+
+    return operation_new(vSelf, OPERATION_BIT_LSCAN, vBinName, rb_ary_new3(3, vBitOffset, vBitSize, RTEST(vValue) ? Qtrue : Qfalse));
+}
+
+#ifdef HAVE_AEROSPIKE_AS_HLL_OPERATIONS_H
+static as_list* operation_hll_list(VALUE vHlls)
+{
+    long n, count = RARRAY_LEN(vHlls);
+    as_arraylist* list = as_arraylist_new((uint32_t) count, 0);
+
+    for(n = 0; n < count; n++) {
+        VALUE vHll = rb_ary_entry(vHlls, n);
+        as_bytes* bytes;
+        uint8_t* value;
+
+        Check_Type(vHll, T_STRING);
+        value = malloc(RSTRING_LEN(vHll));
+        memcpy(value, RSTRING_PTR(vHll), RSTRING_LEN(vHll));
+        bytes = as_bytes_new_wrap(value, (uint32_t) RSTRING_LEN(vHll), true);
+        as_bytes_set_type(bytes, AS_BYTES_HLL);
+        as_arraylist_append(list, (as_val*) bytes);
+    }
+
+    return (as_list*) list;
+}
+#endif
+
+/*
+ * add HLL operation to ops, return true when operation result should be read
+ */
+bool operation_add_hll(as_operations* ops, int op_type, VALUE vBinName, VALUE vBinValue)
+{
+#ifdef HAVE_AEROSPIKE_AS_HLL_OPERATIONS_H
+    as_hll_policy policy;
+    as_list* list = NULL;
+    char* name = StringValueCStr(vBinName);
+    bool result = true;
+
+    as_hll_policy_init(&policy);
+
+    switch(op_type) {
+    case OPERATION_HLL_ADD:
+        list = rb_array_to_as_list(rb_ary_entry(vBinValue, 0));
+        as_operations_hll_add(ops, name, NULL, &policy, list, NUM2INT(rb_ary_entry(vBinValue, 1)));
+        break;
+    case OPERATION_HLL_GET_COUNT:
+        as_operations_hll_get_count(ops, name, NULL);
+        break;
+    case OPERATION_HLL_UNION:
+        list = operation_hll_list(vBinValue);
+        as_operations_hll_set_union(ops, name, NULL, &policy, list);
+        result = false;
+        break;
+    case OPERATION_HLL_UNION_COUNT:
+        list = operation_hll_list(vBinValue);
+        as_operations_hll_get_union_count(ops, name, NULL, list);
+        break;
+    case OPERATION_HLL_INTERSECT_COUNT:
+        list = operation_hll_list(vBinValue);
+        as_operations_hll_get_intersect_count(ops, name, NULL, list);
+        break;
+    default:
+        rb_raise(rb_eArgError, "Incorrect operation type");
+        break;
+    }
+
+    // values are packed into operation right away, list is not consumed
+    if (list != NULL) {
+        as_list_destroy(list);
+    }
+
+    return result;
+#else
+    rb_raise(rb_eNotImpError, "HLL operations are not supported by aerospike client library");
+    return false;
+#endif
+}
+
+/*
+ * add bitwise operation to ops, return true when operation result should be read
+ */
+bool operation_add_bit(as_operations* ops, int op_type, VALUE vBinName, VALUE vBinValue)
+{
+#ifdef HAVE_AEROSPIKE_AS_BIT_OPERATIONS_H
+    as_bit_policy policy;
+    char* name = StringValueCStr(vBinName);
+    VALUE vValue;
+
+    as_bit_policy_init(&policy);
+
+    switch(op_type) {
+    case OPERATION_BIT_RESIZE:
+        as_operations_bit_resize(ops, name, NULL, &policy, NUM2UINT(vBinValue), AS_BIT_RESIZE_DEFAULT);
+        return false;
+    case OPERATION_BIT_SET:
+        vValue = rb_ary_entry(vBinValue, 2);
+        as_operations_bit_set(ops, name, NULL, &policy, NUM2INT(rb_ary_entry(vBinValue, 0)), NUM2UINT(rb_ary_entry(vBinValue, 1)),
+            (uint32_t) RSTRING_LEN(vValue), (uint8_t*) RSTRING_PTR(vValue));
+        return false;
+    case OPERATION_BIT_OR:
+        vValue = rb_ary_entry(vBinValue, 2);
+        as_operations_bit_or(ops, name, NULL, &policy, NUM2INT(rb_ary_entry(vBinValue, 0)), NUM2UINT(rb_ary_entry(vBinValue, 1)),
+            (uint32_t) RSTRING_LEN(vValue), (uint8_t*) RSTRING_PTR(vValue));
+        return false;
+    case OPERATION_BIT_GET:
+        as_operations_bit_get(ops, name, NULL, NUM2INT(rb_ary_entry(vBinValue, 0)), NUM2UINT(rb_ary_entry(vBinValue, 1)));
+        break;
+    case OPERATION_BIT_COUNT:
+        as_operations_bit_count(ops, name, NULL, NUM2INT(rb_ary_entry(vBinValue, 0)), NUM2UINT(rb_ary_entry(vBinValue, 1)));
+        break;
+    case OPERATION_BIT_LSCAN:
+        as_operations_bit_lscan(ops, name, NULL, NUM2INT(rb_ary_entry(vBinValue, 0)), NUM2UINT(rb_ary_entry(vBinValue, 1)), RTEST(rb_ary_entry(vBinValue, 2)));
+        break;
+    default:
+        rb_raise(rb_eArgError, "Incorrect operation type");
+        break;
+    }
+
+    return true;
+#else
+    rb_raise(rb_eNotImpError, "bitwise operations are not supported by aerospike client library");
+    return false;
+#endif
+}
+
+/*
+ * add increment by 64-bit integer or float delta to ops
+ */
+void operation_add_incr(as_operations* ops, const char* name, VALUE vDelta)
+{
+    switch(TYPE(vDelta)) {
+    case T_FIXNUM:
+    case T_BIGNUM:
+        as_operations_add_incr(ops, name, NUM2LL(vDelta));
+        break;
+    case T_FLOAT:
+#ifdef HAVE_AS_OPERATIONS_ADD_INCR_DOUBLE
+        as_operations_add_incr_double(ops, name, NUM2DBL(vDelta));
+#else
+        rb_raise(rb_eNotImpError, "float increments are not supported by aerospike client library");
+#endif
+        break;
+    default:
+        rb_raise(rb_eTypeError, "wrong argument type for increment (expected Integer or Float)");
+        break;
+    }
+}
+
+/*
+ * add operation to ops, return true when operation result should be read,
+ * bin names of bitwise get operations are collected into vRawBins
+ */
+bool operation_add(as_operations* ops, int op_type, VALUE vBinName, VALUE vBinValue, VALUE* vRawBins)
+{
+    switch( op_type ) {
+    case OPERATION_WRITE:
+        switch( TYPE(vBinValue) ) {
+        case T_NIL: {
+            as_record rec;
+            as_record_inita(&rec, 1);
+            as_record_set_nil(&rec, StringValueCStr( vBinName ));
+            ops->binops.entries[ops->binops.size].op = AS_OPERATOR_WRITE;
+            ops->binops.entries[ops->binops.size].bin = rec.bins.entries[0];
+            ops->binops.size++;
+            break;
+        }
+        case T_STRING:
+            as_operations_add_write_str(ops, StringValueCStr( vBinName ), StringValueCStr( vBinValue ));
+            break;
+        case T_FIXNUM:
+            as_operations_add_write_int64(ops, StringValueCStr( vBinName ), NUM2LONG( vBinValue ));
+            break;
+        default: {
+            VALUE vBytes = rb_funcall(vBinValue, rb_intern("to_msgpack"), 0);
+            long size = RSTRING_LEN(vBytes);
+            uint8_t* bytes = malloc(size);
+            memcpy(bytes, RSTRING_PTR(vBytes), size);
+            as_operations_add_write_rawp(ops, StringValueCStr( vBinName ), bytes, (uint32_t) size, true);
+            break;
+        }
+        }
+        return false;
+    case OPERATION_READ:
+        as_operations_add_read(ops, StringValueCStr( vBinName ));
+        return true;
+    case OPERATION_INCREMENT:
+        operation_add_incr(ops, StringValueCStr( vBinName ), vBinValue);
+        return false;
+    case OPERATION_APPEND:
+        Check_Type(vBinValue, T_STRING);
+        as_operations_add_append_str(ops, StringValueCStr( vBinName ), StringValueCStr( vBinValue ));
+        return false;
+    case OPERATION_PREPEND:
+        Check_Type(vBinValue, T_STRING);
+        as_operations_add_prepend_str(ops, StringValueCStr( vBinName ), StringValueCStr( vBinValue ));
+        return false;
+    case OPERATION_TOUCH:
+        as_operations_add_touch(ops);
+        return true;
+    case OPERATION_LIST_APPEND:
+    case OPERATION_LIST_APPEND_UNIQUE:
+    case OPERATION_LIST_INSERT:
+    case OPERATION_LIST_POP:
+    case OPERATION_LIST_REMOVE_RANGE:
+    case OPERATION_LIST_GET_RANGE:
+    case OPERATION_LIST_TRIM:
+    case OPERATION_LIST_SIZE:
+    case OPERATION_LIST_SORT:
+        return operation_add_list(ops, op_type, vBinName, vBinValue);
+    case OPERATION_MAP_PUT:
+    case OPERATION_MAP_PUT_ITEMS:
+    case OPERATION_MAP_INCREMENT:
+    case OPERATION_MAP_REMOVE_BY_KEY:
+    case OPERATION_MAP_REMOVE_BY_VALUE:
+    case OPERATION_MAP_REMOVE_BY_RANK:
+    case OPERATION_MAP_GET_BY_KEY_RANGE:
+    case OPERATION_MAP_GET_BY_RANK_RANGE:
+        return operation_add_map(ops, op_type, vBinName, vBinValue);
+    case OPERATION_HLL_ADD:
+    case OPERATION_HLL_GET_COUNT:
+    case OPERATION_HLL_UNION:
+    case OPERATION_HLL_UNION_COUNT:
+    case OPERATION_HLL_INTERSECT_COUNT:
+        return operation_add_hll(ops, op_type, vBinName, vBinValue);
+    case OPERATION_BIT_GET:
+        if (*vRawBins == Qnil) {
+            *vRawBins = rb_ary_new();
+        }
+        rb_ary_push(*vRawBins, vBinName);
+        // fall through
+    case OPERATION_BIT_RESIZE:
+    case OPERATION_BIT_SET:
+    case OPERATION_BIT_OR:
+    case OPERATION_BIT_COUNT:
+    case OPERATION_BIT_LSCAN:
+        return operation_add_bit(ops, op_type, vBinName, vBinValue);
+    default:
+        rb_raise(rb_eArgError, "Incorrect operation type");
+        break;
+    }
+
+    return false;
+}
+
 void define_operation()
 {
     OperationClass = rb_define_class_under(AerospikeNativeClass, "Operation", rb_cObject);
@@ -139,6 +997,34 @@ void define_operation()
     rb_define_singleton_method(OperationClass, "increment", operation_increment, 2);
     rb_define_singleton_method(OperationClass, "touch", operation_touch, 0);
     rb_define_singleton_method(OperationClass, "read", operation_read, 1);
+    rb_define_singleton_method(OperationClass, "list_append", operation_list_append, 2);
+    rb_define_singleton_method(OperationClass, "list_append_unique", operation_list_append_unique, 2);
+    rb_define_singleton_method(OperationClass, "list_insert", operation_list_insert, 3);
+    rb_define_singleton_method(OperationClass, "list_pop", operation_list_pop, 2);
+    rb_define_singleton_method(OperationClass, "list_remove_range", operation_list_remove_range, 3);
+    rb_define_singleton_method(OperationClass, "list_get_range", operation_list_get_range, -1);
+    rb_define_singleton_method(OperationClass, "list_trim", operation_list_trim, 3);
+    rb_define_singleton_method(OperationClass, "list_size", operation_list_size, 1);
+    rb_define_singleton_method(OperationClass, "list_sort", operation_list_sort, -1);
+    rb_define_singleton_method(OperationClass, "map_put", operation_map_put, 3);
+    rb_define_singleton_method(OperationClass, "map_put_items", operation_map_put_items, 2);
+    rb_define_singleton_method(OperationClass, "map_increment", operation_map_increment, 3);
+    rb_define_singleton_method(OperationClass, "map_remove_by_key", operation_map_remove_by_key, -1);
+    rb_define_singleton_method(OperationClass, "map_remove_by_value", operation_map_remove_by_value, -1);
+    rb_define_singleton_method(OperationClass, "map_remove_by_rank", operation_map_remove_by_rank, -1);
+    rb_define_singleton_method(OperationClass, "map_get_by_key_range", operation_map_get_by_key_range, -1);
+    rb_define_singleton_method(OperationClass, "map_get_by_rank_range", operation_map_get_by_rank_range, -1);
+    rb_define_singleton_method(OperationClass, "hll_add", operation_hll_add, -1);
+    rb_define_singleton_method(OperationClass, "hll_get_count", operation_hll_get_count, 1);
+    rb_define_singleton_method(OperationClass, "hll_union", operation_hll_union, 2);
+    rb_define_singleton_method(OperationClass, "hll_union_count", operation_hll_union_count, 2);
+    rb_define_singleton_method(OperationClass, "hll_intersect_count", operation_hll_intersect_count, 2);
+    rb_define_singleton_method(OperationClass, "bit_resize", operation_bit_resize, 2);
+    rb_define_singleton_method(OperationClass, "bit_set", operation_bit_set, 4);
+    rb_define_singleton_method(OperationClass, "bit_or", operation_bit_or, 4);
+    rb_define_singleton_method(OperationClass, "bit_get", operation_bit_get, 3);
+    rb_define_singleton_method(OperationClass, "bit_count", operation_bit_count, 3);
+    rb_define_singleton_method(OperationClass, "bit_lscan", operation_bit_lscan, 4);
     rb_define_attr(OperationClass, "op_type", 1, 0);
     rb_define_attr(OperationClass, "bin_name", 1, 0);
     rb_define_attr(OperationClass, "bin_value", 1, 0);
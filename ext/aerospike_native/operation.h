@@ -2,6 +2,7 @@
 #define OPERATION_H
 
 #include "aerospike_native.h"
+#include <aerospike/as_operations.h>
 
 RUBY_EXTERN VALUE OperationClass;
 void define_operation();
@@ -12,8 +13,62 @@ enum OperationType {
     OPERATION_INCREMENT,
     OPERATION_APPEND,
     OPERATION_PREPEND,
-    OPERATION_TOUCH
+    OPERATION_TOUCH,
+    OPERATION_LIST_APPEND,
+    OPERATION_LIST_APPEND_UNIQUE,
+    OPERATION_LIST_INSERT,
+    OPERATION_LIST_POP,
+    OPERATION_LIST_REMOVE_RANGE,
+    OPERATION_LIST_GET_RANGE,
+    OPERATION_LIST_TRIM,
+    OPERATION_LIST_SIZE,
+    OPERATION_LIST_SORT,
+    OPERATION_MAP_PUT,
+    OPERATION_MAP_PUT_ITEMS,
+    OPERATION_MAP_INCREMENT,
+    OPERATION_MAP_REMOVE_BY_KEY,
+    OPERATION_MAP_REMOVE_BY_VALUE,
+    OPERATION_MAP_REMOVE_BY_RANK,
+    OPERATION_MAP_GET_BY_KEY_RANGE,
+    OPERATION_MAP_GET_BY_RANK_RANGE,
+    OPERATION_HLL_ADD,
+    OPERATION_HLL_GET_COUNT,
+    OPERATION_HLL_UNION,
+    OPERATION_HLL_UNION_COUNT,
+    OPERATION_HLL_INTERSECT_COUNT,
+    OPERATION_BIT_RESIZE,
+    OPERATION_BIT_SET,
+    OPERATION_BIT_OR,
+    OPERATION_BIT_GET,
+    OPERATION_BIT_COUNT,
+    OPERATION_BIT_LSCAN
 };
 
+#define HLL_DEFAULT_INDEX_BITS 14
+
+enum ListSortFlags {
+    LIST_SORT_DEFAULT = 0,
+    LIST_SORT_DROP_DUPLICATES = 2
+};
+
+enum MapReturnType {
+    MAP_RETURN_NONE = 0,
+    MAP_RETURN_INDEX = 1,
+    MAP_RETURN_REVERSE_INDEX = 2,
+    MAP_RETURN_RANK = 3,
+    MAP_RETURN_REVERSE_RANK = 4,
+    MAP_RETURN_COUNT = 5,
+    MAP_RETURN_KEY = 6,
+    MAP_RETURN_VALUE = 7,
+    MAP_RETURN_KEY_VALUE = 8
+};
+
+void operation_add_incr(as_operations* ops, const char* name, VALUE vDelta);
+bool operation_add(as_operations* ops, int op_type, VALUE vBinName, VALUE vBinValue, VALUE* vRawBins);
+bool operation_add_list(as_operations* ops, int op_type, VALUE vBinName, VALUE vBinValue);
+bool operation_add_map(as_operations* ops, int op_type, VALUE vBinName, VALUE vBinValue);
+bool operation_add_hll(as_operations* ops, int op_type, VALUE vBinName, VALUE vBinValue);
+bool operation_add_bit(as_operations* ops, int op_type, VALUE vBinName, VALUE vBinValue);
+
 #endif // OPERATION_H
 
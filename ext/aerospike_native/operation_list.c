@@ -0,0 +1,190 @@
+#include "operation_list.h"
+#include "operation.h"
+
+VALUE OperationListClass;
+
+static void operation_list_mark(void *p)
+{
+    operation_list* ptr = p;
+    long n;
+
+    for(n = 0; n < ptr->size; n++) {
+        rb_gc_mark(ptr->entries[n].vBinName);
+        rb_gc_mark(ptr->entries[n].vBinValue);
+    }
+}
+
+static void operation_list_deallocate(void *p)
+{
+    operation_list* ptr = p;
+
+    if (ptr->entries != NULL) {
+        free(ptr->entries);
+    }
+    xfree(ptr);
+}
+
+static VALUE operation_list_allocate(VALUE klass)
+{
+    VALUE obj;
+    operation_list *ptr;
+
+    obj = Data_Make_Struct(klass, operation_list, operation_list_mark, operation_list_deallocate, ptr);
+    ptr->size = 0;
+    ptr->slots = 0;
+    ptr->entries = NULL;
+
+    return obj;
+}
+
+static bool operation_has_slot(int op_type)
+{
+    switch(op_type) {
+    case OPERATION_WRITE:
+    case OPERATION_INCREMENT:
+    case OPERATION_APPEND:
+    case OPERATION_PREPEND:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/*
+ * call-seq:
+ *   new(operations) -> AerospikeNative::OperationList
+ *
+ * compile array of AerospikeNative::Operation once for client.operate, values of write, increment, append and prepend
+ * operations become slots which can be replaced on every call by client.operate(key, list, values)
+ */
+VALUE operation_list_initialize(VALUE vSelf, VALUE vOperations)
+{
+    operation_list* ptr;
+    operation_entry* entries;
+    long n, size;
+
+    Check_Type(vOperations, T_ARRAY);
+    size = RARRAY_LEN(vOperations);
+    if (size == 0) {
+        rb_raise(rb_eArgError, "Operations list is empty");
+    }
+
+    Data_Get_Struct(vSelf, operation_list, ptr);
+
+    for(n = 0; n < size; n++) {
+        if (!rb_obj_is_kind_of(rb_ary_entry(vOperations, n), OperationClass)) {
+            rb_raise(rb_eArgError, "Incorrect type (expected AerospikeNative::Operation)");
+        }
+    }
+
+    entries = (operation_entry*) calloc(size, sizeof(operation_entry));
+    if (entries == NULL) {
+        rb_raise(rb_eNoMemError, "failed to allocate operations list");
+    }
+
+    // entries are attached before they are filled so mark function sees frozen bin name copies
+    if (ptr->entries != NULL) {
+        free(ptr->entries);
+    }
+    ptr->entries = entries;
+    ptr->size = size;
+    ptr->slots = 0;
+    for(n = 0; n < size; n++) {
+        VALUE vOperation = rb_ary_entry(vOperations, n);
+        VALUE vBinName = rb_iv_get(vOperation, "@bin_name");
+
+        entries[n].op_type = NUM2INT(rb_iv_get(vOperation, "@op_type"));
+        entries[n].vBinName = TYPE(vBinName) == T_STRING ? rb_str_new_frozen(vBinName) : Qnil;
+        entries[n].vBinValue = rb_iv_get(vOperation, "@bin_value");
+        entries[n].slot = -1;
+        if (operation_has_slot(entries[n].op_type)) {
+            entries[n].slot = (int) ptr->slots++;
+        }
+    }
+
+    return vSelf;
+}
+
+/*
+ * call-seq:
+ *   size -> Fixnum
+ *
+ * number of operations
+ */
+VALUE operation_list_get_size(VALUE vSelf)
+{
+    return LONG2NUM(operation_list_size(vSelf));
+}
+
+/*
+ * call-seq:
+ *   slots -> Fixnum
+ *
+ * number of values expected by client.operate(key, list, values)
+ */
+VALUE operation_list_get_slots(VALUE vSelf)
+{
+    operation_list* ptr;
+
+    Data_Get_Struct(vSelf, operation_list, ptr);
+
+    return LONG2NUM(ptr->slots);
+}
+
+bool is_operation_list(VALUE vValue)
+{
+    return rb_obj_is_kind_of(vValue, OperationListClass) == Qtrue;
+}
+
+long operation_list_size(VALUE vList)
+{
+    operation_list* ptr;
+
+    Data_Get_Struct(vList, operation_list, ptr);
+
+    return ptr->size;
+}
+
+/*
+ * add compiled operations to ops (initialized for operation_list_size operations), slots are filled from vValues
+ * or from compiled values when vValues is nil, return true when operations results should be read
+ */
+bool operation_list_add(VALUE vList, VALUE vValues, as_operations* ops, VALUE* vRawBins)
+{
+    operation_list* ptr;
+    bool isset_read = false;
+    long n;
+
+    Data_Get_Struct(vList, operation_list, ptr);
+
+    if (TYPE(vValues) != T_NIL) {
+        Check_Type(vValues, T_ARRAY);
+        if (RARRAY_LEN(vValues) != ptr->slots) {
+            rb_raise(rb_eArgError, "wrong number of values (%ld for %ld)", RARRAY_LEN(vValues), ptr->slots);
+        }
+    }
+
+    for(n = 0; n < ptr->size; n++) {
+        operation_entry* entry = &ptr->entries[n];
+        VALUE vBinValue = entry->vBinValue;
+
+        if (entry->slot >= 0 && TYPE(vValues) != T_NIL) {
+            vBinValue = RARRAY_AREF(vValues, entry->slot);
+        }
+
+        if (operation_add(ops, entry->op_type, entry->vBinName, vBinValue, vRawBins)) {
+            isset_read = true;
+        }
+    }
+
+    return isset_read;
+}
+
+void define_operation_list()
+{
+    OperationListClass = rb_define_class_under(AerospikeNativeClass, "OperationList", rb_cObject);
+    rb_define_alloc_func(OperationListClass, operation_list_allocate);
+    rb_define_method(OperationListClass, "initialize", operation_list_initialize, 1);
+    rb_define_method(OperationListClass, "size", operation_list_get_size, 0);
+    rb_define_method(OperationListClass, "slots", operation_list_get_slots, 0);
+}
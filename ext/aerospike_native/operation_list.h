@@ -0,0 +1,27 @@
+#ifndef OPERATION_LIST_H
+#define OPERATION_LIST_H
+
+#include "aerospike_native.h"
+#include <aerospike/as_operations.h>
+
+typedef struct operation_entry_s {
+    int op_type;
+    int slot;
+    VALUE vBinName;
+    VALUE vBinValue;
+} operation_entry;
+
+typedef struct operation_list_s {
+    long size;
+    long slots;
+    operation_entry* entries;
+} operation_list;
+
+RUBY_EXTERN VALUE OperationListClass;
+void define_operation_list();
+
+bool is_operation_list(VALUE vValue);
+long operation_list_size(VALUE vList);
+bool operation_list_add(VALUE vList, VALUE vValues, as_operations* ops, VALUE* vRawBins);
+
+#endif // OPERATION_LIST_H
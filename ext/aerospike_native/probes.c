@@ -0,0 +1,17 @@
+#include "probes.h"
+
+#ifdef HAVE_SYS_SDT_H
+// semaphores are incremented by tracer when probe is attached
+#define PROBE_DEFINE_SEMAPHORE(name) \
+    volatile unsigned short PROBE_SEMAPHORE(name) __attribute__((section(".probes"))) = 0
+
+PROBE_DEFINE_SEMAPHORE(command__begin);
+PROBE_DEFINE_SEMAPHORE(command__end);
+PROBE_DEFINE_SEMAPHORE(batch__begin);
+PROBE_DEFINE_SEMAPHORE(batch__end);
+PROBE_DEFINE_SEMAPHORE(query__record);
+PROBE_DEFINE_SEMAPHORE(record__convert__begin);
+PROBE_DEFINE_SEMAPHORE(record__convert__end);
+
+uint64_t probes_last_command_id = 0;
+#endif
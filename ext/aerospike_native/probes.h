@@ -0,0 +1,89 @@
+#ifndef PROBES_H
+#define PROBES_H
+
+#include "aerospike_native.h"
+
+/*
+ * USDT probes of provider aerospike_native, e.g. bpftrace -e 'usdt:aerospike_native.so:command__end { ... }'.
+ * Every probe has a semaphore which is non-zero only while the probe is attached,
+ * so probe arguments are not even evaluated otherwise
+ */
+#ifdef HAVE_SYS_SDT_H
+#define _SDT_HAS_SEMAPHORES 1
+#include <sys/sdt.h>
+
+#define PROBE_SEMAPHORE(name) aerospike_native_##name##_semaphore
+#define PROBE_ENABLED(name) __builtin_expect(PROBE_SEMAPHORE(name) != 0, 0)
+
+extern volatile unsigned short aerospike_native_command__begin_semaphore;
+extern volatile unsigned short aerospike_native_command__end_semaphore;
+extern volatile unsigned short aerospike_native_batch__begin_semaphore;
+extern volatile unsigned short aerospike_native_batch__end_semaphore;
+extern volatile unsigned short aerospike_native_query__record_semaphore;
+extern volatile unsigned short aerospike_native_record__convert__begin_semaphore;
+extern volatile unsigned short aerospike_native_record__convert__end_semaphore;
+extern uint64_t probes_last_command_id;
+
+#define PROBES_COMMAND_ID() \
+    (PROBE_ENABLED(command__begin) || PROBE_ENABLED(command__end) || PROBE_ENABLED(batch__begin) || \
+     PROBE_ENABLED(batch__end) || PROBE_ENABLED(query__record) ? __sync_add_and_fetch(&probes_last_command_id, 1) : 0)
+
+#define PROBE_COMMAND_BEGIN(id, command, ns, set)                                                   \
+    do {                                                                                            \
+        if (PROBE_ENABLED(command__begin)) {                                                        \
+            STAP_PROBE4(aerospike_native, command__begin, id, command, ns, set);                    \
+        }                                                                                           \
+    } while (0)
+#define PROBE_COMMAND_END(id, command, ns, status, network, conversion, sent, received, records)    \
+    do {                                                                                            \
+        if (PROBE_ENABLED(command__end)) {                                                          \
+            STAP_PROBE9(aerospike_native, command__end, id, command, ns, status, network, conversion, \
+                sent, received, records);                                                           \
+        }                                                                                           \
+    } while (0)
+#define PROBE_BATCH_BEGIN(id, ns, keys)                                                             \
+    do {                                                                                            \
+        if (PROBE_ENABLED(batch__begin)) {                                                          \
+            STAP_PROBE3(aerospike_native, batch__begin, id, ns, keys);                              \
+        }                                                                                           \
+    } while (0)
+#define PROBE_BATCH_END(id, ns, keys, status)                                                       \
+    do {                                                                                            \
+        if (PROBE_ENABLED(batch__end)) {                                                            \
+            STAP_PROBE4(aerospike_native, batch__end, id, ns, keys, status);                        \
+        }                                                                                           \
+    } while (0)
+#define PROBE_QUERY_RECORD(id, ns, bins)                                                            \
+    do {                                                                                            \
+        if (PROBE_ENABLED(query__record)) {                                                         \
+            STAP_PROBE3(aerospike_native, query__record, id, ns, bins);                             \
+        }                                                                                           \
+    } while (0)
+#define PROBE_RECORD_CONVERT_BEGIN(ns, bins)                                                        \
+    do {                                                                                            \
+        if (PROBE_ENABLED(record__convert__begin)) {                                                \
+            STAP_PROBE2(aerospike_native, record__convert__begin, ns, bins);                        \
+        }                                                                                           \
+    } while (0)
+#define PROBE_RECORD_CONVERT_END(ns, bins)                                                          \
+    do {                                                                                            \
+        if (PROBE_ENABLED(record__convert__end)) {                                                  \
+            STAP_PROBE2(aerospike_native, record__convert__end, ns, bins);                          \
+        }                                                                                           \
+    } while (0)
+
+#else
+
+#define PROBE_ENABLED(name) 0
+#define PROBES_COMMAND_ID() 0
+#define PROBE_COMMAND_BEGIN(id, command, ns, set) do { } while (0)
+#define PROBE_COMMAND_END(id, command, ns, status, network, conversion, sent, received, records) do { } while (0)
+#define PROBE_BATCH_BEGIN(id, ns, keys) do { } while (0)
+#define PROBE_BATCH_END(id, ns, keys, status) do { } while (0)
+#define PROBE_QUERY_RECORD(id, ns, bins) do { } while (0)
+#define PROBE_RECORD_CONVERT_BEGIN(ns, bins) do { (void) (bins); } while (0)
+#define PROBE_RECORD_CONVERT_END(ns, bins) do { (void) (bins); } while (0)
+
+#endif // HAVE_SYS_SDT_H
+
+#endif // PROBES_H
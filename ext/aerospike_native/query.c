@@ -1,7 +1,13 @@
 #include "query.h"
 #include "client.h"
 #include "record.h"
+#include "job.h"
+#include "geo.h"
+#include "stats.h"
+#include "probes.h"
 #include <aerospike/aerospike_query.h>
+#include <ruby/thread.h>
+#include <time.h>
 
 VALUE QueryClass;
 
@@ -111,7 +117,8 @@ int query_where_hash_foreach(VALUE vKey, VALUE vValue, VALUE vHash)
     switch(TYPE(vValue)) {
     case T_ARRAY:
         idx = RARRAY_LEN(vValue);
-        if (idx != 2) {
+        // collection range is [:list | :mapkeys | :mapvalues, min, max]
+        if (idx != 2 && !(idx == 3 && TYPE(rb_ary_entry(vValue, 0)) == T_SYMBOL)) {
             rb_raise(rb_eArgError, "wrong array length (expected 2 elements)");
         }
         vHashValue = vValue;
@@ -143,103 +150,526 @@ VALUE query_where(VALUE vSelf, VALUE vHash)
     return vSelf;
 }
 
-VALUE query_apply(int argc, VALUE* vArgs, VALUE vSelf)
+static VALUE query_where_geo(VALUE vSelf, VALUE vBinName, const char* predicate, VALUE vGeo)
+{
+    VALUE vBins;
+
+    GET_STRING(vBinName);
+    if (!is_aerospike_geojson(vGeo)) {
+        vGeo = rb_class_new_instance(1, &vGeo, GeoJSONClass);
+    }
+
+    vBins = rb_iv_get(vSelf, "@where_bins");
+    if(TYPE(vBins) == T_NIL) {
+        vBins = rb_hash_new();
+    }
+    rb_hash_aset(vBins, vBinName, rb_ary_new3(2, ID2SYM(rb_intern(predicate)), vGeo));
+    rb_iv_set(vSelf, "@where_bins", vBins);
+    return vSelf;
+}
+
+/*
+ * call-seq:
+ *   within_region(bin, region) -> AerospikeNative::Query
+ *
+ * match geojson bin points inside region (AerospikeNative::GeoJSON, GeoJSON string or hash)
+ */
+VALUE query_within_region(VALUE vSelf, VALUE vBinName, VALUE vRegion)
+{
+    return query_where_geo(vSelf, vBinName, "geo_within", vRegion);
+}
+
+/*
+ * call-seq:
+ *   within_radius(bin, lng, lat, radius) -> AerospikeNative::Query
+ *
+ * match geojson bin points inside circle, radius in meters
+ */
+VALUE query_within_radius(VALUE vSelf, VALUE vBinName, VALUE vLng, VALUE vLat, VALUE vRadius)
+{
+    return query_where_geo(vSelf, vBinName, "geo_within", rb_geojson_circle(NUM2DBL(vLng), NUM2DBL(vLat), NUM2DBL(vRadius)));
+}
+
+/*
+ * call-seq:
+ *   contains_point(bin, lng, lat) -> AerospikeNative::Query
+ *
+ * match geojson bin regions containing point
+ */
+VALUE query_contains_point(VALUE vSelf, VALUE vBinName, VALUE vLng, VALUE vLat)
+{
+    return query_where_geo(vSelf, vBinName, "geo_contains", rb_geojson_point(NUM2DBL(vLng), NUM2DBL(vLat)));
+}
+
+/*
+ * call-seq:
+ *   filter(exp) -> AerospikeNative::Query
+ *
+ * set AerospikeNative::Exp filter, it is compiled into server predicate expressions,
+ * so only matched records are returned by server
+ */
+VALUE query_set_filter(VALUE vSelf, VALUE vExp)
 {
+#ifdef HAVE_AEROSPIKE_AS_PREDEXP_H
+    if (TYPE(vExp) != T_NIL) {
+        expression_predexp_size(vExp);
+    }
+    rb_iv_set(vSelf, "@filter", vExp);
+    return vSelf;
+#else
+    rb_raise(rb_eNotImpError, "filter expressions are not supported by aerospike client library");
+#endif
+}
+
+/*
+ * call-seq:
+ *   limit(n) -> AerospikeNative::Query
+ *
+ * stop iteration on all nodes after n records are returned, nil or 0 removes limit
+ */
+VALUE query_set_limit(VALUE vSelf, VALUE vLimit)
+{
+    if (TYPE(vLimit) != T_NIL) {
+        Check_Type(vLimit, T_FIXNUM);
+        if (FIX2LONG(vLimit) < 0) {
+            rb_raise(rb_eArgError, "limit should not be negative");
+        }
+    }
+    rb_iv_set(vSelf, "@limit", vLimit);
+    return vSelf;
+}
+
+static VALUE query_first_exec(VALUE vSelf)
+{
+    return rb_funcall(vSelf, rb_intern("exec"), 0);
+}
+
+static VALUE query_first_restore(VALUE vArgs)
+{
+    rb_iv_set(rb_ary_entry(vArgs, 0), "@limit", rb_ary_entry(vArgs, 1));
+    return Qnil;
+}
+
+/*
+ * call-seq:
+ *   first -> AerospikeNative::Record or nil
+ *   first(n) -> Array
+ *
+ * return first records and stop iteration on all nodes
+ */
+VALUE query_first(int argc, VALUE* vArgs, VALUE vSelf)
+{
+    VALUE vLimit = INT2FIX(1);
+    VALUE vPrevious;
+    VALUE vRecords;
+
+    if (argc > 1) {  // there should only be 0 or 1 arguments
+        rb_raise(rb_eArgError, "wrong number of arguments (%d for 0..1)", argc);
+    }
+
+    if (argc == 1) {
+        vLimit = vArgs[0];
+        Check_Type(vLimit, T_FIXNUM);
+        if (FIX2LONG(vLimit) < 0) {
+            rb_raise(rb_eArgError, "negative array size");
+        }
+        if (FIX2LONG(vLimit) == 0) {
+            return rb_ary_new();
+        }
+    }
+
+    vPrevious = rb_ary_new3(2, vSelf, rb_iv_get(vSelf, "@limit"));
+    rb_iv_set(vSelf, "@limit", vLimit);
+    vRecords = rb_ensure(query_first_exec, vSelf, query_first_restore, vPrevious);
+
+    if (argc == 0) {
+        return rb_ary_entry(vRecords, 0);
+    }
+
+    return vRecords;
+}
+
+/*
+ * number of predicate expressions of @filter, 0 without filter
+ */
+int query_filter_size(VALUE vSelf)
+{
+    VALUE vFilter = rb_iv_get(vSelf, "@filter");
+
+    if (TYPE(vFilter) == T_NIL) {
+        return 0;
+    }
+
+    return expression_predexp_size(vFilter);
+}
+
+/*
+ * check apply arguments and return [module, function, args] array
+ */
+VALUE query_udf_new(int argc, VALUE* vArgs)
+{
+    VALUE vArglist = Qnil;
+
     if (argc < 2 || argc > 3) {  // there should only be 2 or 3 arguments
         rb_raise(rb_eArgError, "wrong number of arguments (%d for 2..3)", argc);
     }
 
     Check_Type(vArgs[0], T_STRING);
     Check_Type(vArgs[1], T_STRING);
-    rb_iv_set(vSelf, "@udf_module", vArgs[0]);
-    rb_iv_set(vSelf, "@udf_function", vArgs[1]);
-
     if (argc == 3 && TYPE(vArgs[2]) != T_NIL) {
         Check_Type(vArgs[2], T_ARRAY);
+        vArglist = vArgs[2];
+    }
+
+    return rb_ary_new3(3, vArgs[0], vArgs[1], vArglist);
+}
+
+/*
+ * [module, function, args] array of udf set by apply, vUdf of the single command takes precedence
+ */
+VALUE query_udf_get(VALUE vSelf, VALUE vUdf)
+{
+    if (TYPE(vUdf) != T_NIL) {
+        return vUdf;
     }
 
+    return rb_ary_new3(3, rb_iv_get(vSelf, "@udf_module"), rb_iv_get(vSelf, "@udf_function"), rb_iv_get(vSelf, "@udf_arglist"));
+}
+
+VALUE query_apply(int argc, VALUE* vArgs, VALUE vSelf)
+{
+    VALUE vUdf = query_udf_new(argc, vArgs);
+
+    rb_iv_set(vSelf, "@udf_module", rb_ary_entry(vUdf, 0));
+    rb_iv_set(vSelf, "@udf_function", rb_ary_entry(vUdf, 1));
+    rb_iv_set(vSelf, "@udf_arglist", rb_ary_entry(vUdf, 2));
+
     return vSelf;
 }
 
+static VALUE query_exec_udf(int argc, VALUE* vArgs, VALUE vSelf, VALUE vUdf);
+
+/*
+ * call-seq:
+ *   aggregate(module, function) -> Array
+ *   aggregate(module, function, args) -> Array
+ *   aggregate(module, function, args, policy_settings) -> Array
+ *   aggregate(module, function, ...) { |value| ... } -> Nil
+ *
+ * apply stream udf with arguments, reduce phase runs on client with configured lua paths.
+ * Udf is used only by this command and isn't stored in the query
+ */
+VALUE query_aggregate(int argc, VALUE* vArgs, VALUE vSelf)
+{
+    VALUE vUdf;
+
+    if (argc < 2 || argc > 4) {  // there should only be 2, 3 or 4 arguments
+        rb_raise(rb_eArgError, "wrong number of arguments (%d for 2..4)", argc);
+    }
+
+    vUdf = query_udf_new(argc > 3 ? 3 : argc, vArgs);
+    return query_exec_udf(argc == 4 ? 1 : 0, &vArgs[3], vSelf, vUdf);
+}
+
+void query_data_init(query_data* data)
+{
+    data->vArray = rb_ary_new();
+    data->partition_begin = 0;
+    data->partition_end = PARTITION_COUNT;
+    data->records_per_second = 0;
+    data->started_at = 0;
+    data->without_gvl = false;
+    data->records_scanned = 0;
+    data->records_matched = 0;
+    data->records_returned = 0;
+    data->limit = 0;
+    data->stopped = false;
+    data->jump_state = 0;
+    data->conversion_ns = 0;
+    data->block_ns = 0;
+    data->command_id = 0;
+}
+
+static uint64_t query_now_usec()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void* query_sleep_without_gvl(void* ptr)
+{
+    nanosleep((struct timespec*) ptr, NULL);
+    return NULL;
+}
+
+static void query_sleep(query_data* data, uint64_t usec)
+{
+    struct timespec ts;
+
+    ts.tv_sec = usec / 1000000;
+    ts.tv_nsec = (usec % 1000000) * 1000;
+
+    // callback may be called from C client thread or while GVL is already released
+    if (!data->without_gvl && ruby_native_thread_p()) {
+        rb_thread_call_without_gvl(query_sleep_without_gvl, &ts, RUBY_UBF_IO, NULL);
+    } else {
+        nanosleep(&ts, NULL);
+    }
+}
+
+/*
+ * pace callback to records_per_second, records is number of records scanned so far
+ */
+void query_throttle(query_data* data, uint64_t records)
+{
+    uint64_t started_at, expected, elapsed;
+
+    if (data->records_per_second == 0) {
+        return;
+    }
+
+    started_at = data->started_at;
+    if (started_at == 0) {
+        __sync_bool_compare_and_swap(&data->started_at, 0, query_now_usec());
+        started_at = data->started_at;
+    }
+
+    expected = records * 1000000 / data->records_per_second;
+    elapsed = query_now_usec() - started_at;
+    if (expected > elapsed) {
+        query_sleep(data, expected - elapsed);
+    }
+}
+
+static uint16_t query_record_partition(as_record* record)
+{
+    uint8_t* digest = record->key.digest.value;
+    return (uint16_t)((digest[0] | (digest[1] << 8)) & (PARTITION_COUNT - 1));
+}
+
+/*
+ * check partitions slice of the native record, doesn't touch ruby objects.
+ * Records of the slice are counted, so progress of the slices workers can be summed
+ */
+bool query_record_match(query_data* data, as_record* record)
+{
+    if (data->partition_begin != 0 || data->partition_end != PARTITION_COUNT) {
+        uint16_t partition_id = query_record_partition(record);
+        if (partition_id < data->partition_begin || partition_id >= data->partition_end) {
+            return false;
+        }
+    }
+    __sync_fetch_and_add(&data->records_matched, 1);
+
+    return true;
+}
+
+/*
+ * count returned record, returns false when iteration is stopped or limit is already reached
+ */
+bool query_record_accept(query_data* data)
+{
+    uint64_t returned;
+
+    if (data->stopped) {
+        return false;
+    }
+
+    returned = __sync_add_and_fetch(&data->records_returned, 1);
+    if (data->limit != 0 && returned > data->limit) {
+        // another node thread took the last record
+        __sync_fetch_and_sub(&data->records_returned, 1);
+        data->stopped = true;
+        return false;
+    }
+
+    return true;
+}
+
+/*
+ * callback result after accepted record, false aborts scan or query on all nodes
+ */
+bool query_record_continue(query_data* data)
+{
+    if (data->limit != 0 && data->records_returned >= data->limit) {
+        data->stopped = true;
+    }
+
+    return !data->stopped;
+}
+
+/*
+ * foreach status is successful when iteration was aborted by the callback
+ */
+bool query_status_ok(const query_data* data, as_status status)
+{
+    if (status == AEROSPIKE_OK) {
+        return true;
+    }
+
+    return data->stopped && (status == AEROSPIKE_ERR_CLIENT_ABORT || status == AEROSPIKE_ERR_QUERY_ABORTED || status == AEROSPIKE_ERR_SCAN_ABORTED);
+}
+
+/*
+ * rethrow break or exception of the block and raise foreach error
+ */
+void query_check_status(query_data* data, as_status status, as_error* err)
+{
+    if (data->jump_state != 0) {
+        rb_jump_tag(data->jump_state);
+    }
+
+    if (!query_status_ok(data, status)) {
+        raise_aerospike_exception(err->code, err->message);
+    }
+}
+
 bool query_callback(const as_val *value, void *udata) {
-    VALUE vRecord;
+    VALUE vRecord = Qnil;
+    query_data* data = (query_data*) udata;
+    uint64_t started_at;
 
     if (value == NULL) {
         // query is complete
         return true;
     }
 
+    if (data->stopped) {
+        return false;
+    }
+
     switch(as_val_type(value)) {
     case AS_REC: {
         as_record* record = as_record_fromval(value);
         if (record != NULL) {
+            PROBE_QUERY_RECORD(data->command_id, record->key.ns, record->bins.size);
+            query_throttle(data, __sync_add_and_fetch(&data->records_scanned, 1));
+            // skip records before any ruby object is built
+            if (!query_record_match(data, record)) {
+                return true;
+            }
+            started_at = stats_now();
             vRecord = rb_record_from_c(record, NULL);
+            __sync_fetch_and_add(&data->conversion_ns, stats_now() - started_at);
         }
         break;
     }
-    case AS_INTEGER: {
-        as_integer* integer = as_integer_fromval(value);
-        if (integer != NULL) {
-            vRecord = LONG2NUM( as_integer_get(integer) );
-        }
+    default:
+        started_at = stats_now();
+        vRecord = rb_value_from_as_val(value);
+        __sync_fetch_and_add(&data->conversion_ns, stats_now() - started_at);
         break;
     }
-    case AS_STRING: {
-        as_string* string = as_string_fromval(value);
-        if (string != NULL) {
-            vRecord = LONG2NUM( as_string_get(string) );
-        }
-        break;
+
+    if (!query_record_accept(data)) {
+        return false;
     }
-    case AS_NIL:
-        vRecord = Qnil;
-        break;
-    case AS_BOOLEAN: {
-        as_integer* integer = as_integer_fromval(value);
-        if (integer != NULL) {
-            vRecord = LONG2NUM( as_integer_get(integer) );
+
+    if ( rb_block_given_p() ) {
+        // break or exception in the block should stop iteration on all nodes before it is rethrown
+        started_at = stats_now();
+        rb_protect(rb_yield, vRecord, &data->jump_state);
+        __sync_fetch_and_add(&data->block_ns, stats_now() - started_at);
+        if (data->jump_state != 0) {
+            data->stopped = true;
+            return false;
         }
-        break;
+    } else {
+        rb_ary_push(data->vArray, vRecord);
     }
-    case AS_LIST:
-    case AS_MAP:
-    case AS_PAIR:
-    case AS_UNDEF:
-    default:
-        break;
+
+    return query_record_continue(data);
+}
+
+/*
+ * add tagged where condition: [:geo_within, geojson], [:geo_contains, geojson],
+ * [:list | :mapkeys | :mapvalues, value] or [:list | :mapkeys | :mapvalues, min, max]
+ */
+static void query_where_predicate(as_query* query, VALUE vBinName, VALUE vCondition)
+{
+    ID predicate = SYM2ID(rb_ary_entry(vCondition, 0));
+#if defined(HAVE_AEROSPIKE_AS_GEOJSON_H) || defined(HAVE_AEROSPIKE_INDEX_CREATE_COMPLEX)
+    VALUE vValue = rb_ary_entry(vCondition, 1);
+#endif
+#ifdef HAVE_AEROSPIKE_INDEX_CREATE_COMPLEX
+    VALUE vMax = rb_ary_entry(vCondition, 2);
+#endif
+
+    if (predicate == rb_intern("geo_within") || predicate == rb_intern("geo_contains")) {
+#ifdef HAVE_AEROSPIKE_AS_GEOJSON_H
+        VALUE vGeo = is_aerospike_geojson(vValue) ? rb_iv_get(vValue, "@value") : vValue;
+        if (TYPE(vGeo) != T_STRING) {
+            as_query_destroy(query);
+            rb_raise(rb_eArgError, "Incorrect geo condition (expected GeoJSON)");
+        }
+        if (predicate == rb_intern("geo_within")) {
+            as_query_where(query, StringValueCStr(vBinName), as_geo_within(StringValueCStr(vGeo)));
+        } else {
+            as_query_where(query, StringValueCStr(vBinName), as_geo_contains(StringValueCStr(vGeo)));
+        }
+        return;
+#else
+        as_query_destroy(query);
+        rb_raise(rb_eNotImpError, "geo queries are not supported by aerospike client library");
+#endif
     }
 
-    if ( rb_block_given_p() ) {
-        rb_yield(vRecord);
-    } else {
-        VALUE *vArray = (VALUE*) udata;
-        rb_ary_push(*vArray, vRecord);
+    if (predicate == rb_intern("list") || predicate == rb_intern("mapkeys") || predicate == rb_intern("mapvalues")) {
+#ifdef HAVE_AEROSPIKE_INDEX_CREATE_COMPLEX
+        as_index_type type = AS_INDEX_TYPE_LIST;
+        if (predicate == rb_intern("mapkeys")) {
+            type = AS_INDEX_TYPE_MAPKEYS;
+        } else if (predicate == rb_intern("mapvalues")) {
+            type = AS_INDEX_TYPE_MAPVALUES;
+        }
+
+        switch(TYPE(vValue)) {
+        case T_FIXNUM:
+            switch(TYPE(vMax)) {
+            case T_NIL:
+                as_query_where(query, StringValueCStr(vBinName), AS_PREDICATE_EQUAL, type, AS_INDEX_NUMERIC, (int64_t) FIX2LONG(vValue));
+                return;
+            case T_FIXNUM:
+                as_query_where(query, StringValueCStr(vBinName), AS_PREDICATE_RANGE, type, AS_INDEX_NUMERIC, (int64_t) FIX2LONG(vValue), (int64_t) FIX2LONG(vMax));
+                return;
+            }
+            break;
+        case T_SYMBOL:
+            vValue = rb_sym_to_s(vValue);
+        case T_STRING:
+            if (TYPE(vMax) == T_NIL) {
+                as_query_where(query, StringValueCStr(vBinName), AS_PREDICATE_EQUAL, type, AS_INDEX_STRING, StringValueCStr(vValue));
+                return;
+            }
+            break;
+        }
+#else
+        as_query_destroy(query);
+        rb_raise(rb_eNotImpError, "collection queries are not supported by aerospike client library");
+#endif
     }
 
-    return true;
+    as_query_destroy(query);
+    rb_raise(rb_eArgError, "Incorrect condition");
 }
 
-VALUE query_exec(int argc, VALUE* vArgs, VALUE vSelf)
+/*
+ * read query settings into as_query, as_query should be destroyed by caller
+ */
+static void query_prepare(VALUE vSelf, as_query* query, VALUE vUdf)
 {
     VALUE vNamespace;
     VALUE vSet;
-    VALUE vArray;
-    VALUE vClient;
     VALUE vWhere, vSelect, vOrder;
     VALUE vUdfModule;
     VALUE vWhereKeys, vOrderKeys;
 
-    aerospike *ptr;
-    as_error err;
-    as_policy_query policy;
-    as_query query;
-
     int n = 0;
     int where_idx = 0, select_idx = 0, order_idx = 0;
-
-    if (argc > 1) {  // there should only be 0 or 1 arguments
-        rb_raise(rb_eArgError, "wrong number of arguments (%d for 0..1)", argc);
-    }
+#ifdef HAVE_AEROSPIKE_AS_PREDEXP_H
+    int filter_idx = query_filter_size(vSelf);
+#endif
 
     vNamespace = rb_iv_get(vSelf, "@namespace");
     vSet = rb_iv_get(vSelf, "@set");
@@ -279,40 +709,37 @@ VALUE query_exec(int argc, VALUE* vArgs, VALUE vSelf)
         rb_raise(rb_eTypeError, "wrong argument type for order (expected Hash or Nil)");
     }
 
-    as_policy_query_init(&policy);
-    if (argc == 1 && TYPE(vArgs[0]) != T_NIL) {
-        SET_POLICY(policy, vArgs[0]);
-    }
-
-    vClient = rb_iv_get(vSelf, "@client");
-    Data_Get_Struct(vClient, aerospike, ptr);
-
-    as_query_init(&query, StringValueCStr(vNamespace), StringValueCStr(vSet));
+    as_query_init(query, StringValueCStr(vNamespace), StringValueCStr(vSet));
 
-    as_query_select_inita(&query, select_idx);
+    as_query_select_init(query, select_idx);
     for(n = 0; n < select_idx; n++) {
         VALUE vBinName;
         vBinName = rb_ary_entry(vSelect, n);
 
-        as_query_select(&query, StringValueCStr(vBinName));
+        as_query_select(query, StringValueCStr(vBinName));
     }
 
-    as_query_orderby_inita(&query, order_idx);
+    as_query_orderby_init(query, order_idx);
     for(n = 0; n < order_idx; n++) {
         VALUE vBinName;
         VALUE vCondition;
         vBinName = rb_ary_entry(vOrderKeys, n);
         vCondition = rb_hash_aref(vOrder, vBinName);
 
-        as_query_orderby(&query, StringValueCStr(vBinName), NUM2INT(vCondition));
+        as_query_orderby(query, StringValueCStr(vBinName), NUM2INT(vCondition));
     }
 
-    as_query_where_inita(&query, where_idx);
+    as_query_where_init(query, where_idx);
     for(n = 0; n < where_idx; n++) {
         VALUE vMin = Qnil, vMax = Qnil, vBinName;
         VALUE vCondition;
         vBinName = rb_ary_entry(vWhereKeys, n);
         vCondition = rb_hash_aref(vWhere, vBinName);
+        if (TYPE(vCondition) == T_ARRAY && TYPE(rb_ary_entry(vCondition, 0)) == T_SYMBOL) {
+            query_where_predicate(query, vBinName, vCondition);
+            continue;
+        }
+
         switch(TYPE(vCondition)) {
         case T_ARRAY:
             vMin = rb_ary_entry(vCondition, 0);
@@ -326,50 +753,168 @@ VALUE query_exec(int argc, VALUE* vArgs, VALUE vSelf)
         case T_FIXNUM:
             switch(TYPE(vMax)) {
             case T_NIL:
-                as_query_where(&query, StringValueCStr(vBinName), as_integer_equals(FIX2LONG(vMin)));
+                as_query_where(query, StringValueCStr(vBinName), as_integer_equals(FIX2LONG(vMin)));
                 break;
             case T_FIXNUM:
-                as_query_where(&query, StringValueCStr(vBinName), as_integer_range(FIX2LONG(vMin), FIX2LONG(vMax)));
+                as_query_where(query, StringValueCStr(vBinName), as_integer_range(FIX2LONG(vMin), FIX2LONG(vMax)));
                 break;
             default:
+                as_query_destroy(query);
                 rb_raise(rb_eArgError, "Incorrect condition");
             }
 
             break;
         case T_STRING:
-            Check_Type(vMax, T_NIL);
-            as_query_where(&query, StringValueCStr(vBinName), as_string_equals(StringValueCStr(vMin)));
+            if (TYPE(vMax) != T_NIL) {
+                as_query_destroy(query);
+                Check_Type(vMax, T_NIL);
+            }
+            as_query_where(query, StringValueCStr(vBinName), as_string_equals(StringValueCStr(vMin)));
             break;
         default:
+            as_query_destroy(query);
             rb_raise(rb_eArgError, "Incorrect condition");
         }
     }
 
-    vUdfModule = rb_iv_get(vSelf, "@udf_module");
+    vUdf = query_udf_get(vSelf, vUdf);
+    vUdfModule = rb_ary_entry(vUdf, 0);
     switch(TYPE(vUdfModule)) {
     case T_NIL:
         break;
     case T_STRING: {
-        VALUE vUdfFunction = rb_iv_get(vSelf, "@udf_function");
-        as_query_apply(&query, StringValueCStr(vUdfModule), StringValueCStr(vUdfFunction), NULL);
+        VALUE vUdfFunction = rb_ary_entry(vUdf, 1);
+        VALUE vUdfArglist = rb_ary_entry(vUdf, 2);
+        as_list* arglist = NULL;
+        if (TYPE(vUdfArglist) == T_ARRAY) {
+            arglist = rb_array_to_as_list(vUdfArglist);
+        }
+        as_query_apply(query, StringValueCStr(vUdfModule), StringValueCStr(vUdfFunction), arglist);
         break;
     }
     default:
+        as_query_destroy(query);
         rb_raise(rb_eTypeError, "wrong argument type for udf module (expected String or Nil)");
     }
 
-    vArray = rb_ary_new();
-    if (aerospike_query_foreach(ptr, &err, &policy, &query, query_callback, &vArray) != AEROSPIKE_OK) {
-        as_query_destroy(&query);
-        raise_aerospike_exception(err.code, err.message);
+#ifdef HAVE_AEROSPIKE_AS_PREDEXP_H
+    if (filter_idx > 0) {
+        as_predexp_base** predexps = ALLOCA_N(as_predexp_base*, filter_idx);
+        expression_predexp(rb_iv_get(vSelf, "@filter"), predexps);
+        as_query_predexp_init(query, filter_idx);
+        for(n = 0; n < filter_idx; n++) {
+            as_query_predexp_add(query, predexps[n]);
+        }
+    }
+#endif
+}
+
+static VALUE query_exec_udf(int argc, VALUE* vArgs, VALUE vSelf, VALUE vUdf)
+{
+    VALUE vClient;
+    VALUE vLimit;
+
+    aerospike *ptr;
+    as_error err;
+    as_status status;
+    as_policy_query policy;
+    as_query query;
+    query_data data;
+    stats_timer timer;
+
+    if (argc > 1) {  // there should only be 0 or 1 arguments
+        rb_raise(rb_eArgError, "wrong number of arguments (%d for 0..1)", argc);
+    }
+
+    as_policy_query_init(&policy);
+    if (argc == 1 && TYPE(vArgs[0]) != T_NIL) {
+        SET_POLICY(policy, vArgs[0]);
+    }
+
+    vClient = rb_iv_get(vSelf, "@client");
+    Data_Get_Struct(vClient, aerospike, ptr);
+
+    stats_timer_start(&timer, vClient, STATS_COMMAND_QUERY);
+    query_data_init(&data);
+    data.command_id = timer.id;
+    vLimit = rb_iv_get(vSelf, "@limit");
+    if (TYPE(vLimit) == T_FIXNUM) {
+        data.limit = FIX2ULONG(vLimit);
     }
+
+    query_prepare(vSelf, &query, vUdf);
+    stats_timer_namespace(&timer, query.ns, query.set);
+
+    stats_timer_begin_network(&timer);
+    status = aerospike_query_foreach(ptr, &err, &policy, &query, query_callback, &data);
+    stats_timer_end_network(&timer);
+    stats_timer_exclude(&timer, data.conversion_ns, data.block_ns);
+    stats_timer_records(&timer, data.records_returned);
     as_query_destroy(&query);
+    stats_timer_finish(&timer, query_status_ok(&data, status) ? AEROSPIKE_OK : status);
+    query_check_status(&data, status, &err);
 
     if ( rb_block_given_p() ) {
         return Qnil;
     }
 
-    return vArray;
+    return data.vArray;
+}
+
+VALUE query_exec(int argc, VALUE* vArgs, VALUE vSelf)
+{
+    return query_exec_udf(argc, vArgs, vSelf, Qnil);
+}
+
+/*
+ * call-seq:
+ *   execute_background(module, function) -> AerospikeNative::Job
+ *   execute_background(module, function, args) -> AerospikeNative::Job
+ *   execute_background(module, function, args, policy_settings) -> AerospikeNative::Job
+ *
+ * apply record udf to every matched record on server side, records are not returned.
+ * Udf is used only by this job and isn't stored in the query
+ */
+VALUE query_execute_background(int argc, VALUE* vArgs, VALUE vSelf)
+{
+    VALUE vClient, vUdf;
+
+    aerospike *ptr;
+    as_error err;
+    as_policy_write policy;
+    as_query query;
+    uint64_t query_id = 0;
+
+    if (argc < 2 || argc > 4) {  // there should only be 2, 3 or 4 arguments
+        rb_raise(rb_eArgError, "wrong number of arguments (%d for 2..4)", argc);
+    }
+
+    if (TYPE(rb_iv_get(vSelf, "@filter")) != T_NIL) {
+        rb_raise(rb_eArgError, "filter is not supported for background query");
+    }
+    if (TYPE(rb_iv_get(vSelf, "@limit")) == T_FIXNUM && FIX2LONG(rb_iv_get(vSelf, "@limit")) != 0) {
+        rb_raise(rb_eArgError, "limit is not supported for background query");
+    }
+
+    vUdf = query_udf_new(argc > 3 ? 3 : argc, vArgs);
+
+    as_policy_write_init(&policy);
+    if (argc == 4 && TYPE(vArgs[3]) != T_NIL) {
+        SET_WRITE_POLICY(policy, vArgs[3]);
+    }
+
+    vClient = rb_iv_get(vSelf, "@client");
+    Data_Get_Struct(vClient, aerospike, ptr);
+
+    query_prepare(vSelf, &query, vUdf);
+
+    if (aerospike_query_background(ptr, &err, &policy, &query, &query_id) != AEROSPIKE_OK) {
+        as_query_destroy(&query);
+        raise_aerospike_exception(err.code, err.message);
+    }
+    as_query_destroy(&query);
+
+    return rb_job_new(vClient, JOB_MODULE_QUERY, query_id);
 }
 
 void define_query()
@@ -379,8 +924,16 @@ void define_query()
     rb_define_method(QueryClass, "select", query_select, -1);
     rb_define_method(QueryClass, "order", query_order, 1);
     rb_define_method(QueryClass, "where", query_where, 1);
+    rb_define_method(QueryClass, "within_region", query_within_region, 2);
+    rb_define_method(QueryClass, "within_radius", query_within_radius, 4);
+    rb_define_method(QueryClass, "contains_point", query_contains_point, 3);
     rb_define_method(QueryClass, "apply", query_apply, -1);
+    rb_define_method(QueryClass, "aggregate", query_aggregate, -1);
+    rb_define_method(QueryClass, "filter", query_set_filter, 1);
+    rb_define_method(QueryClass, "limit", query_set_limit, 1);
+    rb_define_method(QueryClass, "first", query_first, -1);
     rb_define_method(QueryClass, "exec", query_exec, -1);
+    rb_define_method(QueryClass, "execute_background", query_execute_background, -1);
 
     rb_define_attr(QueryClass, "client", 1, 0);
     rb_define_attr(QueryClass, "namespace", 1, 0);
@@ -2,10 +2,43 @@
 #define QUERY_H
 
 #include "aerospike_native.h"
+#include "expression.h"
+
+#define PARTITION_COUNT 4096
+
+typedef struct query_data_s {
+    VALUE vArray;
+    uint16_t partition_begin;
+    uint16_t partition_end;
+    uint32_t records_per_second;
+    uint64_t started_at;
+    bool without_gvl;
+    uint64_t records_scanned;
+    uint64_t records_matched;
+    uint64_t records_returned;
+    uint64_t limit;
+    volatile bool stopped;
+    int jump_state;
+    uint64_t conversion_ns;
+    uint64_t block_ns;
+    uint64_t command_id;
+} query_data;
 
 RUBY_EXTERN VALUE QueryClass;
 void define_query();
+void query_data_init(query_data* data);
+void query_throttle(query_data* data, uint64_t records);
+bool query_record_match(query_data* data, as_record* record);
+bool query_record_accept(query_data* data);
+bool query_record_continue(query_data* data);
+bool query_status_ok(const query_data* data, as_status status);
+void query_check_status(query_data* data, as_status status, as_error* err);
 bool query_callback(const as_val *value, void *udata);
+VALUE query_set_filter(VALUE vSelf, VALUE vExp);
+VALUE query_set_limit(VALUE vSelf, VALUE vLimit);
+VALUE query_first(int argc, VALUE* vArgs, VALUE vSelf);
+int query_filter_size(VALUE vSelf);
+VALUE query_udf_new(int argc, VALUE* vArgs);
+VALUE query_udf_get(VALUE vSelf, VALUE vUdf);
 
 #endif // QUERY_H
-
@@ -1,6 +1,13 @@
 #include "record.h"
 #include "key.h"
 #include "client.h"
+#include "geo.h"
+#include "probes.h"
+#include <aerospike/as_arraylist.h>
+#include <aerospike/as_hashmap.h>
+#include <aerospike/as_boolean.h>
+#include <aerospike/as_double.h>
+#include <aerospike/as_rec.h>
 
 VALUE RecordClass;
 
@@ -27,10 +34,19 @@ VALUE record_initialize(VALUE vSelf, VALUE vKey, VALUE vBins, VALUE vGen, VALUE
 
 VALUE rb_record_from_c(as_record* record, as_key* key)
 {
-    VALUE vKeyParams[5], vParams[4];
+    return rb_record_from_c_raw_bins(record, key, Qnil);
+}
+
+/*
+ * convert record to ruby object, bytes of bins listed in vRawBins (bitwise operations results) are returned as binary strings
+ */
+VALUE rb_record_from_c_raw_bins(as_record* record, as_key* key, VALUE vRawBins)
+{
+    VALUE vKeyParams[5], vParams[4], vRecord;
     as_key current_key;
     as_bin bin;
     int n;
+    uint16_t bins_size = record->bins.size;
     char msg[200];
 
     if (key == NULL) {
@@ -38,6 +54,7 @@ VALUE rb_record_from_c(as_record* record, as_key* key)
     } else {
         current_key = *key;
     }
+    PROBE_RECORD_CONVERT_BEGIN(current_key.ns, bins_size);
 
     vKeyParams[0] = rb_str_new2(current_key.ns);
     vKeyParams[1] = rb_str_new2(current_key.set);
@@ -82,9 +99,23 @@ VALUE rb_record_from_c(as_record* record, as_key* key)
             break;
         case AS_BYTES: {
             VALUE vString = rb_str_new(as_bytes_get(bin.valuep), as_bytes_size(bin.valuep));
-            rb_hash_aset(vParams[1], rb_str_new2(bin.name), rb_funcall(MsgPackClass, rb_intern("unpack"), 1, vString));
+            VALUE vName = rb_str_new2(bin.name);
+            if (as_bytes_get_type(as_bytes_fromval((as_val*) bin.valuep)) != AS_BYTES_BLOB ||
+                (TYPE(vRawBins) == T_ARRAY && rb_ary_includes(vRawBins, vName) == Qtrue)) {
+                rb_hash_aset(vParams[1], vName, vString);
+            } else {
+                rb_hash_aset(vParams[1], vName, rb_funcall(MsgPackClass, rb_intern("unpack"), 1, vString));
+            }
             break;
         }
+        case AS_DOUBLE:
+        case AS_LIST:
+        case AS_MAP:
+#ifdef HAVE_AEROSPIKE_AS_GEOJSON_H
+        case AS_GEOJSON:
+#endif
+            rb_hash_aset(vParams[1], rb_str_new2(bin.name), rb_value_from_as_val((as_val*) bin.valuep));
+            break;
         case AS_UNDEF:
         default:
             sprintf(msg, "unhandled val type: %d\n", as_val_type(bin.valuep));
@@ -94,7 +125,157 @@ VALUE rb_record_from_c(as_record* record, as_key* key)
     }
 
     as_record_destroy(record);
-    return rb_class_new_instance(4, vParams, RecordClass);
+    vRecord = rb_class_new_instance(4, vParams, RecordClass);
+    PROBE_RECORD_CONVERT_END(current_key.ns, bins_size);
+
+    return vRecord;
+}
+
+static bool rb_value_from_as_map_foreach(const as_val* key, const as_val* value, void* udata)
+{
+    VALUE* vHash = (VALUE*) udata;
+    rb_hash_aset(*vHash, rb_value_from_as_val(key), rb_value_from_as_val(value));
+    return true;
+}
+
+static bool rb_value_from_as_rec_foreach(const char* name, const as_val* value, void* udata)
+{
+    VALUE* vHash = (VALUE*) udata;
+    rb_hash_aset(*vHash, rb_str_new2(name), rb_value_from_as_val(value));
+    return true;
+}
+
+/*
+ * convert udf result or complex bin value to ruby object
+ */
+VALUE rb_value_from_as_val(const as_val* value)
+{
+    if (value == NULL) {
+        return Qnil;
+    }
+
+    switch( as_val_type(value) ) {
+    case AS_NIL:
+        return Qnil;
+    case AS_BOOLEAN:
+        return as_boolean_get(as_boolean_fromval(value)) ? Qtrue : Qfalse;
+    case AS_INTEGER:
+        return LONG2NUM(as_integer_get(as_integer_fromval(value)));
+    case AS_DOUBLE:
+        return rb_float_new(as_double_get(as_double_fromval(value)));
+    case AS_STRING:
+        return rb_str_new2(as_string_get(as_string_fromval(value)));
+    case AS_BYTES: {
+        as_bytes* bytes = as_bytes_fromval(value);
+        VALUE vString = rb_str_new(as_bytes_get(bytes), as_bytes_size(bytes));
+        // only blobs are msgpack packed ruby objects, typed bytes (e.g. HLL) are returned as is
+        if (as_bytes_get_type(bytes) != AS_BYTES_BLOB) {
+            return vString;
+        }
+        return rb_funcall(MsgPackClass, rb_intern("unpack"), 1, vString);
+    }
+    case AS_LIST: {
+        as_list* list = as_list_fromval(value);
+        uint32_t n, idx = as_list_size(list);
+        VALUE vArray = rb_ary_new_capa(idx);
+        for(n = 0; n < idx; n++) {
+            rb_ary_push(vArray, rb_value_from_as_val(as_list_get(list, n)));
+        }
+        return vArray;
+    }
+    case AS_MAP: {
+        VALUE vHash = rb_hash_new();
+        as_map_foreach(as_map_fromval(value), rb_value_from_as_map_foreach, &vHash);
+        return vHash;
+    }
+#ifdef HAVE_AEROSPIKE_AS_GEOJSON_H
+    case AS_GEOJSON:
+        return rb_geojson_new(as_geojson_get(as_geojson_fromval(value)));
+#endif
+    case AS_REC: {
+        VALUE vHash = rb_hash_new();
+        as_rec_foreach(as_rec_fromval(value), rb_value_from_as_rec_foreach, &vHash);
+        return vHash;
+    }
+    case AS_PAIR: {
+        as_pair* pair = as_pair_fromval(value);
+        return rb_ary_new3(2, rb_value_from_as_val(as_pair_1(pair)), rb_value_from_as_val(as_pair_2(pair)));
+    }
+    default: {
+        char msg[200];
+        sprintf(msg, "unhandled val type: %d\n", as_val_type(value));
+        rb_funcall(LoggerInstance, rb_intern("warn"), 1, rb_str_new2(msg));
+        return Qnil;
+    }
+    }
+}
+
+static int rb_value_to_as_map_foreach(VALUE vKey, VALUE vValue, VALUE vMap)
+{
+    as_hashmap* map = (as_hashmap*) vMap;
+    as_hashmap_set(map, rb_value_to_as_val(vKey), rb_value_to_as_val(vValue));
+    return ST_CONTINUE;
+}
+
+/*
+ * convert ruby object to new as_val for udf arguments, caller owns result
+ */
+as_val* rb_value_to_as_val(VALUE vValue)
+{
+    switch( TYPE(vValue) ) {
+    case T_NIL:
+        return (as_val*) &as_nil;
+    case T_TRUE:
+    case T_FALSE:
+        return (as_val*) as_boolean_new(RTEST(vValue));
+    case T_FIXNUM:
+    case T_BIGNUM:
+        return (as_val*) as_integer_new(NUM2LL(vValue));
+    case T_FLOAT:
+        return (as_val*) as_double_new(NUM2DBL(vValue));
+    case T_SYMBOL:
+        vValue = rb_sym_to_s(vValue);
+    case T_STRING:
+        return (as_val*) as_string_new_strdup(StringValueCStr(vValue));
+    case T_ARRAY:
+        return (as_val*) rb_array_to_as_list(vValue);
+    case T_HASH: {
+        as_hashmap* map = as_hashmap_new(RHASH_SIZE(vValue));
+        rb_hash_foreach(vValue, rb_value_to_as_map_foreach, (VALUE) map);
+        return (as_val*) map;
+    }
+    default: {
+        VALUE vBytes;
+        int size;
+        uint8_t* bytes;
+#ifdef HAVE_AEROSPIKE_AS_GEOJSON_H
+        if (is_aerospike_geojson(vValue)) {
+            VALUE vGeo = rb_iv_get(vValue, "@value");
+            return (as_val*) as_geojson_new(strdup(StringValueCStr(vGeo)), true);
+        }
+#endif
+        vBytes = rb_funcall(vValue, rb_intern("to_msgpack"), 0);
+        size = RSTRING_LEN(vBytes);
+        bytes = malloc(size);
+        memcpy(bytes, RSTRING_PTR(vBytes), size);
+        return (as_val*) as_bytes_new_wrap(bytes, size, true);
+    }
+    }
+}
+
+as_list* rb_array_to_as_list(VALUE vArray)
+{
+    long n, idx;
+    as_arraylist* list;
+
+    Check_Type(vArray, T_ARRAY);
+    idx = RARRAY_LEN(vArray);
+    list = as_arraylist_new(idx, 0);
+    for(n = 0; n < idx; n++) {
+        as_arraylist_append(list, rb_value_to_as_val(rb_ary_entry(vArray, n)));
+    }
+
+    return (as_list*) list;
 }
 
 void define_record()
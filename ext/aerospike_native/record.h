@@ -8,6 +8,10 @@ RUBY_EXTERN VALUE RecordClass;
 void define_record();
 
 VALUE rb_record_from_c(as_record* record, as_key* key);
+VALUE rb_record_from_c_raw_bins(as_record* record, as_key* key, VALUE vRawBins);
+VALUE rb_value_from_as_val(const as_val* value);
+as_val* rb_value_to_as_val(VALUE vValue);
+as_list* rb_array_to_as_list(VALUE vArray);
 
 #endif // RECORD_H
 
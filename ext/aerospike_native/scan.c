@@ -1,7 +1,20 @@
 #include "scan.h"
 #include "query.h"
 #include "client.h"
+#include "record.h"
+#include "aggregation.h"
+#include "job.h"
+#include "export.h"
+#include "stats.h"
 #include <aerospike/aerospike_scan.h>
+#include <ruby/thread.h>
+
+// partitions slice is sent to the server as digest predicate when scan accepts predicates,
+// otherwise every worker scans the whole set and records of other slices are dropped on the client
+#if defined(HAVE_AS_SCAN_PREDEXP_ADD) && defined(HAVE_AS_PREDEXP_REC_DIGEST_MODULO)
+#define SCAN_SERVER_PARTITIONS
+#define SCAN_PARTITIONS_PREDEXP_SIZE 7
+#endif
 
 VALUE ScanClass;
 
@@ -60,6 +73,13 @@ VALUE scan_select(int argc, VALUE* vArgs, VALUE vSelf)
     return vSelf;
 }
 
+/*
+ * call-seq:
+ *   set_concurrent(true or false) -> AerospikeNative::Scan
+ *
+ * scan all nodes in parallel, supported by aggregate, export and background scan only,
+ * exec raises ArgumentError because records are converted and yielded in the calling thread
+ */
 VALUE scan_concurrent(VALUE vSelf, VALUE vValue)
 {
     rb_iv_set(vSelf, "@concurrent", vValue);
@@ -78,62 +98,178 @@ VALUE scan_priority(VALUE vSelf, VALUE vValue)
     return vSelf;
 }
 
+/*
+ * call-seq:
+ *   set_records_per_second(limit) -> AerospikeNative::Scan
+ *
+ * limit records rate of foreground scan, 0 or nil disables limit
+ */
+VALUE scan_records_per_second(VALUE vSelf, VALUE vValue)
+{
+    if (TYPE(vValue) != T_NIL) {
+        Check_Type(vValue, T_FIXNUM);
+        if (FIX2LONG(vValue) < 0 || FIX2LONG(vValue) > UINT32_MAX) {
+            rb_raise(rb_eArgError, "Incorrect records per second value");
+        }
+    }
+
+    rb_iv_set(vSelf, "@records_per_second", vValue);
+    return vSelf;
+}
+
 VALUE scan_no_bins(VALUE vSelf, VALUE vValue)
 {
     rb_iv_set(vSelf, "@no_bins", vValue);
     return vSelf;
 }
 
-VALUE scan_apply(int argc, VALUE* vArgs, VALUE vSelf)
+/*
+ * call-seq:
+ *   filter(exp) -> AerospikeNative::Scan
+ *
+ * set AerospikeNative::Exp filter, it is compiled into server predicate expressions,
+ * so only matched records are returned by server
+ */
+VALUE scan_set_filter(VALUE vSelf, VALUE vExp)
 {
-    if (argc < 2 || argc > 3) {  // there should only be 2 or 3 arguments
-        rb_raise(rb_eArgError, "wrong number of arguments (%d for 2..3)", argc);
-    }
+#ifdef HAVE_AS_SCAN_PREDEXP_ADD
+    return query_set_filter(vSelf, vExp);
+#else
+    rb_raise(rb_eNotImpError, "scan filter expressions are not supported by aerospike client library");
+#endif
+}
 
-    Check_Type(vArgs[0], T_STRING);
-    Check_Type(vArgs[1], T_STRING);
-    rb_iv_set(vSelf, "@udf_module", vArgs[0]);
-    rb_iv_set(vSelf, "@udf_function", vArgs[1]);
+/*
+ * call-seq:
+ *   set_partitions(partition_begin, partition_count) -> AerospikeNative::Scan
+ *
+ * restrict scan to records of the partitions slice [partition_begin, partition_begin + partition_count),
+ * see partition_slices for the way slice is applied
+ */
+VALUE scan_partitions(VALUE vSelf, VALUE vBegin, VALUE vCount)
+{
+    int begin, count;
+
+    Check_Type(vBegin, T_FIXNUM);
+    Check_Type(vCount, T_FIXNUM);
+    begin = FIX2INT(vBegin);
+    count = FIX2INT(vCount);
 
-    if (argc == 3 && TYPE(vArgs[2]) != T_NIL) {
-        Check_Type(vArgs[2], T_ARRAY);
+    if (begin < 0 || count <= 0 || begin + count > PARTITION_COUNT) {
+        rb_raise(rb_eArgError, "Incorrect partitions slice (expected inside 0..%d)", PARTITION_COUNT - 1);
     }
 
+    rb_iv_set(vSelf, "@partition_begin", vBegin);
+    rb_iv_set(vSelf, "@partition_count", vCount);
     return vSelf;
 }
 
 /*
  * call-seq:
- *   exec -> records
- *   exec(scan_policy) -> records
- *   exec { |record| ... } -> Nil
- *   exec(scan_policy) { |record| ... } -> Nil
+ *   progress -> Hash
  *
- * perform scan
+ * return progress of the last foreground scan in the same format as scan_info,
+ * records_matched is number of scanned records inside of the partitions slice
  */
-VALUE scan_exec(int argc, VALUE* vArgs, VALUE vSelf)
+VALUE scan_progress(VALUE vSelf)
 {
-    VALUE vClient, vNamespace, vSet;
-    VALUE vArray;
-    VALUE vConcurrent, vPercent, vPriority, vBins, vNoBins, vUdfModule;
-    as_scan scan;
-    as_policy_scan policy;
-    as_error err;
-    aerospike* ptr;
+    VALUE vHash, vBegin, vCount, vScanned, vMatched, vReturned;
+    int count = PARTITION_COUNT;
 
-    int n, idx = 0;
-    bool is_background = false;
+    vBegin = rb_iv_get(vSelf, "@partition_begin");
+    vCount = rb_iv_get(vSelf, "@partition_count");
+    vScanned = rb_iv_get(vSelf, "@records_scanned");
+    vMatched = rb_iv_get(vSelf, "@records_matched");
+    vReturned = rb_iv_get(vSelf, "@records_returned");
 
-    if (argc > 1) {  // there should only be 0 or 1 argument
-        rb_raise(rb_eArgError, "wrong number of arguments (%d for 0..1)", argc);
+    if (TYPE(vBegin) == T_NIL) {
+        vBegin = INT2FIX(0);
+    }
+    if (TYPE(vCount) != T_NIL) {
+        count = FIX2INT(vCount);
     }
 
-    as_policy_scan_init(&policy);
-    if(argc == 1) {
-        SET_SCAN_POLICY(policy, vArgs[0]);
+    vHash = rb_hash_new();
+    rb_hash_aset(vHash, rb_str_new2("partition_begin"), vBegin);
+    rb_hash_aset(vHash, rb_str_new2("partition_count"), INT2FIX(count));
+    if (TYPE(vScanned) == T_NIL) {
+        rb_hash_aset(vHash, rb_str_new2("progress_percent"), INT2FIX(0));
+        rb_hash_aset(vHash, rb_str_new2("records_scanned"), INT2FIX(0));
+        rb_hash_aset(vHash, rb_str_new2("records_matched"), INT2FIX(0));
+        rb_hash_aset(vHash, rb_str_new2("records_returned"), INT2FIX(0));
+        rb_hash_aset(vHash, rb_str_new2("status"), INT2FIX(AS_SCAN_STATUS_UNDEF));
+    } else {
+        rb_hash_aset(vHash, rb_str_new2("progress_percent"), INT2FIX(100));
+        rb_hash_aset(vHash, rb_str_new2("records_scanned"), vScanned);
+        rb_hash_aset(vHash, rb_str_new2("records_matched"), vMatched);
+        rb_hash_aset(vHash, rb_str_new2("records_returned"), vReturned);
+        rb_hash_aset(vHash, rb_str_new2("status"), INT2FIX(AS_SCAN_STATUS_COMPLETED));
     }
 
-    vClient = rb_iv_get(vSelf, "@client");
+    return vHash;
+}
+
+/*
+ * read partitions slice [begin, end), returns false when scan is not restricted
+ */
+static bool scan_partitions_slice(VALUE vSelf, int* begin, int* end)
+{
+    VALUE vPartitionBegin = rb_iv_get(vSelf, "@partition_begin");
+    VALUE vPartitionCount = rb_iv_get(vSelf, "@partition_count");
+
+    *begin = 0;
+    *end = PARTITION_COUNT;
+    if (TYPE(vPartitionBegin) == T_FIXNUM && TYPE(vPartitionCount) == T_FIXNUM) {
+        *begin = FIX2INT(vPartitionBegin);
+        *end = *begin + FIX2INT(vPartitionCount);
+    }
+
+    return *begin != 0 || *end != PARTITION_COUNT;
+}
+
+#ifdef SCAN_SERVER_PARTITIONS
+/*
+ * add predicate begin <= digest modulo PARTITION_COUNT < end, takes SCAN_PARTITIONS_PREDEXP_SIZE entries.
+ * Digest modulo doesn't follow partition ids, but it splits records between slices as evenly as partitions do
+ */
+static void scan_partitions_predexp(as_scan* scan, int begin, int end)
+{
+    as_scan_predexp_add(scan, as_predexp_rec_digest_modulo(PARTITION_COUNT));
+    as_scan_predexp_add(scan, as_predexp_integer_value(begin));
+    as_scan_predexp_add(scan, as_predexp_integer_greatereq());
+    as_scan_predexp_add(scan, as_predexp_rec_digest_modulo(PARTITION_COUNT));
+    as_scan_predexp_add(scan, as_predexp_integer_value(end));
+    as_scan_predexp_add(scan, as_predexp_integer_less());
+    as_scan_predexp_add(scan, as_predexp_and(2));
+}
+#endif
+
+VALUE scan_apply(int argc, VALUE* vArgs, VALUE vSelf)
+{
+    VALUE vUdf = query_udf_new(argc, vArgs);
+
+    rb_iv_set(vSelf, "@udf_module", rb_ary_entry(vUdf, 0));
+    rb_iv_set(vSelf, "@udf_function", rb_ary_entry(vUdf, 1));
+    rb_iv_set(vSelf, "@udf_arglist", rb_ary_entry(vUdf, 2));
+
+    return vSelf;
+}
+
+/*
+ * read scan settings into as_scan and query_data, as_scan should be destroyed by caller
+ */
+static void scan_prepare(VALUE vSelf, as_scan* scan, query_data* data)
+{
+    VALUE vNamespace, vSet;
+    VALUE vConcurrent, vPercent, vPriority, vBins, vNoBins;
+    VALUE vRecordsPerSecond, vLimit;
+    int n, idx = 0, partition_begin, partition_end;
+    bool sliced = scan_partitions_slice(vSelf, &partition_begin, &partition_end);
+#ifdef HAVE_AS_SCAN_PREDEXP_ADD
+    int filter_idx = query_filter_size(vSelf);
+    int predexp_size = filter_idx;
+#endif
+
     vNamespace = rb_iv_get(vSelf, "@namespace");
     vSet = rb_iv_get(vSelf, "@set");
     vConcurrent = rb_iv_get(vSelf, "@concurrent");
@@ -141,49 +277,142 @@ VALUE scan_exec(int argc, VALUE* vArgs, VALUE vSelf)
     vPriority = rb_iv_get(vSelf, "@priority");
     vNoBins = rb_iv_get(vSelf, "@no_bins");
     vBins = rb_iv_get(vSelf, "@select_bins");
-    as_scan_init(&scan, StringValueCStr(vNamespace), StringValueCStr(vSet));
+    vRecordsPerSecond = rb_iv_get(vSelf, "@records_per_second");
+    vLimit = rb_iv_get(vSelf, "@limit");
+
+    query_data_init(data);
+    if (TYPE(vRecordsPerSecond) == T_FIXNUM) {
+        data->records_per_second = FIX2UINT(vRecordsPerSecond);
+    }
+#ifdef SCAN_SERVER_PARTITIONS
+    if (sliced) {
+        predexp_size += filter_idx > 0 ? SCAN_PARTITIONS_PREDEXP_SIZE + 1 : SCAN_PARTITIONS_PREDEXP_SIZE;
+    }
+#else
+    if (sliced) {
+        data->partition_begin = partition_begin;
+        data->partition_end = partition_end;
+    }
+#endif
+    if (TYPE(vLimit) == T_FIXNUM) {
+        data->limit = FIX2ULONG(vLimit);
+    }
+
+    as_scan_init(scan, StringValueCStr(vNamespace), StringValueCStr(vSet));
 
     if (TYPE(vPercent) == T_FIXNUM) {
-        as_scan_set_percent(&scan, FIX2INT(vPercent));
+        as_scan_set_percent(scan, FIX2INT(vPercent));
     }
 
     if (TYPE(vPriority) == T_FIXNUM) {
-        as_scan_set_priority(&scan, FIX2INT(vPriority));
+        as_scan_set_priority(scan, FIX2INT(vPriority));
     }
 
     if (TYPE(vConcurrent) != T_NIL) {
-        as_scan_set_priority(&scan, RTEST(vConcurrent));
+        as_scan_set_concurrent(scan, RTEST(vConcurrent));
     }
 
     if (TYPE(vNoBins) != T_NIL) {
-        as_scan_set_nobins(&scan, RTEST(vNoBins));
+        as_scan_set_nobins(scan, RTEST(vNoBins));
     }
 
     if (TYPE(vBins) == T_ARRAY && (idx = RARRAY_LEN(vBins)) > 0) {
-        as_scan_select_inita(&scan, idx);
+        as_scan_select_init(scan, idx);
         for(n = 0; n < idx; n++) {
             VALUE vEntry = rb_ary_entry(vBins, n);
-            as_scan_select(&scan, StringValueCStr(vEntry));
+            as_scan_select(scan, StringValueCStr(vEntry));
+        }
+    }
+#ifdef HAVE_AS_SCAN_PREDEXP_ADD
+    if (predexp_size > 0) {
+        as_scan_predexp_init(scan, predexp_size);
+    }
+    if (filter_idx > 0) {
+        as_predexp_base** predexps = ALLOCA_N(as_predexp_base*, filter_idx);
+        expression_predexp(rb_iv_get(vSelf, "@filter"), predexps);
+        for(n = 0; n < filter_idx; n++) {
+            as_scan_predexp_add(scan, predexps[n]);
         }
     }
+#endif
+#ifdef SCAN_SERVER_PARTITIONS
+    if (sliced) {
+        scan_partitions_predexp(scan, partition_begin, partition_end);
+        if (filter_idx > 0) {
+            as_scan_predexp_add(scan, as_predexp_and(2));
+        }
+    }
+#endif
+}
+
+/*
+ * perform scan with udf set by apply or with vUdf of the single command
+ */
+static VALUE scan_exec_udf(int argc, VALUE* vArgs, VALUE vSelf, VALUE vUdf)
+{
+    VALUE vClient, vUdfModule;
+    as_scan scan;
+    query_data data;
+    as_policy_scan policy;
+    as_error err;
+    as_status status;
+    aerospike* ptr;
+    stats_timer timer;
+
+    bool is_background = false;
+
+    if (argc > 1) {  // there should only be 0 or 1 argument
+        rb_raise(rb_eArgError, "wrong number of arguments (%d for 0..1)", argc);
+    }
 
-    vUdfModule = rb_iv_get(vSelf, "@udf_module");
+    as_policy_scan_init(&policy);
+    if(argc == 1) {
+        SET_SCAN_POLICY(policy, vArgs[0]);
+    }
+
+    vClient = rb_iv_get(vSelf, "@client");
+    scan_prepare(vSelf, &scan, &data);
+
+    vUdf = query_udf_get(vSelf, vUdf);
+    vUdfModule = rb_ary_entry(vUdf, 0);
     switch(TYPE(vUdfModule)) {
     case T_NIL:
         break;
     case T_STRING: {
-        VALUE vUdfFunction = rb_iv_get(vSelf, "@udf_function");
-        as_scan_apply_each(&scan, StringValueCStr(vUdfModule), StringValueCStr(vUdfFunction), NULL);
+        VALUE vUdfFunction = rb_ary_entry(vUdf, 1);
+        VALUE vUdfArglist = rb_ary_entry(vUdf, 2);
+        as_list* arglist = NULL;
+        int partition_begin, partition_end;
+        if (scan_partitions_slice(vSelf, &partition_begin, &partition_end)) {
+            as_scan_destroy(&scan);
+            rb_raise(rb_eArgError, "partitions slice is not supported for background scan");
+        }
+        if (TYPE(rb_iv_get(vSelf, "@filter")) != T_NIL) {
+            as_scan_destroy(&scan);
+            rb_raise(rb_eArgError, "filter is not supported for background scan");
+        }
+        if (data.limit != 0) {
+            as_scan_destroy(&scan);
+            rb_raise(rb_eArgError, "limit is not supported for background scan");
+        }
+        if (data.records_per_second != 0) {
+            as_scan_destroy(&scan);
+            rb_raise(rb_eArgError, "records per second limit is not supported for background scan, use set_priority");
+        }
+        if (TYPE(vUdfArglist) == T_ARRAY) {
+            arglist = rb_array_to_as_list(vUdfArglist);
+        }
+        as_scan_apply_each(&scan, StringValueCStr(vUdfModule), StringValueCStr(vUdfFunction), arglist);
         is_background = true;
         break;
     }
     default:
+        as_scan_destroy(&scan);
         rb_raise(rb_eTypeError, "wrong argument type for udf module (expected String or Nil)");
     }
 
     Data_Get_Struct(vClient, aerospike, ptr);
 
-    vArray = rb_ary_new();
     if(is_background) {
         uint64_t scan_id = 0;
         if (aerospike_scan_background(ptr, &err, &policy, &scan, &scan_id) != AEROSPIKE_OK) {
@@ -194,19 +423,276 @@ VALUE scan_exec(int argc, VALUE* vArgs, VALUE vSelf)
         return ULONG2NUM(scan_id);
     }
 
-    if (aerospike_scan_foreach(ptr, &err, &policy, &scan, query_callback, &vArray) != AEROSPIKE_OK) {
+    // parallel nodes scan calls back from C client threads, which can't build ruby records or yield
+    if (RTEST(rb_iv_get(vSelf, "@concurrent"))) {
         as_scan_destroy(&scan);
-        raise_aerospike_exception(err.code, err.message);
+        rb_raise(rb_eArgError, "concurrent scan is supported only by aggregate, export and background scan");
     }
 
+    stats_timer_start(&timer, vClient, STATS_COMMAND_SCAN);
+    data.command_id = timer.id;
+    stats_timer_namespace(&timer, scan.ns, scan.set);
+    stats_timer_begin_network(&timer);
+    status = aerospike_scan_foreach(ptr, &err, &policy, &scan, query_callback, &data);
+    stats_timer_end_network(&timer);
+    stats_timer_exclude(&timer, data.conversion_ns, data.block_ns);
+    stats_timer_records(&timer, data.records_returned);
+    stats_timer_finish(&timer, query_status_ok(&data, status) ? AEROSPIKE_OK : status);
+
     as_scan_destroy(&scan);
+    rb_iv_set(vSelf, "@records_scanned", ULL2NUM(data.records_scanned));
+    rb_iv_set(vSelf, "@records_matched", ULL2NUM(data.records_matched));
+    rb_iv_set(vSelf, "@records_returned", ULL2NUM(data.records_returned));
+    query_check_status(&data, status, &err);
     if ( rb_block_given_p() ) {
         return Qnil;
     }
 
-    return vArray;
+    return data.vArray;
+}
+
+/*
+ * call-seq:
+ *   exec -> records
+ *   exec(scan_policy) -> records
+ *   exec { |record| ... } -> Nil
+ *   exec(scan_policy) { |record| ... } -> Nil
+ *
+ * perform scan
+ */
+VALUE scan_exec(int argc, VALUE* vArgs, VALUE vSelf)
+{
+    return scan_exec_udf(argc, vArgs, vSelf, Qnil);
+}
+
+
+typedef struct scan_aggregate_args_s {
+    aerospike* ptr;
+    as_error* err;
+    as_policy_scan* policy;
+    as_scan* scan;
+    aggregation_state* state;
+    as_status status;
+} scan_aggregate_args;
+
+static void* scan_aggregate_without_gvl(void* ptr)
+{
+    scan_aggregate_args* args = (scan_aggregate_args*) ptr;
+    args->status = aerospike_scan_foreach(args->ptr, args->err, args->policy, args->scan, aggregation_callback, args->state);
+    return NULL;
+}
+
+static void scan_aggregate_interrupt(void* ptr)
+{
+    aggregation_state* state = (aggregation_state*) ptr;
+    state->cancelled = true;
+}
+
+/*
+ * call-seq:
+ *   aggregate(aggregations) -> Hash
+ *   aggregate(aggregations, scan_policy) -> Hash
+ *
+ * compute aggregations natively in scan callback without ruby records, GVL is released while scanning.
+ * aggregations: count: true or bins, sum: bins, min: bins, max: bins, distinct: bins, histogram: [bin, buckets_bounds]
+ */
+VALUE scan_aggregate(int argc, VALUE* vArgs, VALUE vSelf)
+{
+    VALUE vClient;
+    as_scan scan;
+    query_data data;
+    aggregation_state state;
+    scan_aggregate_args args;
+    as_policy_scan policy;
+    as_error err;
+    aerospike* ptr;
+
+    if (argc > 2 || argc < 1) {  // there should only be 1 or 2 arguments
+        rb_raise(rb_eArgError, "wrong number of arguments (%d for 1..2)", argc);
+    }
+
+    as_policy_scan_init(&policy);
+    if(argc == 2 && TYPE(vArgs[1]) != T_NIL) {
+        SET_SCAN_POLICY(policy, vArgs[1]);
+    }
+
+    vClient = rb_iv_get(vSelf, "@client");
+    Data_Get_Struct(vClient, aerospike, ptr);
+
+    aggregation_init(&state, vArgs[0], &data);
+    scan_prepare(vSelf, &scan, &data);
+    data.without_gvl = true;
+
+    args.ptr = ptr;
+    args.err = &err;
+    args.policy = &policy;
+    args.scan = &scan;
+    args.state = &state;
+    rb_thread_call_without_gvl(scan_aggregate_without_gvl, &args, scan_aggregate_interrupt, &state);
+
+    as_scan_destroy(&scan);
+    rb_iv_set(vSelf, "@records_scanned", ULL2NUM(data.records_scanned));
+    rb_iv_set(vSelf, "@records_matched", ULL2NUM(data.records_matched));
+    rb_iv_set(vSelf, "@records_returned", ULL2NUM(data.records_returned));
+
+    if (state.cancelled) {
+        aggregation_destroy(&state);
+        rb_thread_check_ints();
+        raise_aerospike_exception(AEROSPIKE_ERR_CLIENT_ABORT, "aggregation interrupted");
+    }
+
+    if (state.out_of_memory) {
+        aggregation_destroy(&state);
+        rb_raise(rb_eNoMemError, "failed to allocate aggregation accumulators");
+    }
+
+    if (!query_status_ok(&data, args.status)) {
+        aggregation_destroy(&state);
+        raise_aerospike_exception(err.code, err.message);
+    }
+
+    return aggregation_result(&state);
 }
 
+typedef struct scan_export_args_s {
+    aerospike* ptr;
+    as_error* err;
+    as_policy_scan* policy;
+    as_scan* scan;
+    export_writer* writer;
+    as_status status;
+} scan_export_args;
+
+static void* scan_export_without_gvl(void* ptr)
+{
+    scan_export_args* args = (scan_export_args*) ptr;
+    args->status = aerospike_scan_foreach(args->ptr, args->err, args->policy, args->scan, export_callback, args->writer);
+    return NULL;
+}
+
+static void scan_export_interrupt(void* ptr)
+{
+    export_writer* writer = (export_writer*) ptr;
+    writer->cancelled = true;
+}
+
+/*
+ * call-seq:
+ *   export(path) -> Integer
+ *   export(path, options) -> Integer
+ *   export(path, options, scan_policy) -> Integer
+ *
+ * stream scanned records into file without ruby records, GVL is released while scanning.
+ * options: format: :msgpack (default) or :ndjson, compress: true for gzip output
+ */
+VALUE scan_export(int argc, VALUE* vArgs, VALUE vSelf)
+{
+    VALUE vClient;
+    VALUE vPath;
+    VALUE vFormat;
+    VALUE vOptions = Qnil;
+    as_scan scan;
+    query_data data;
+    export_writer writer;
+    scan_export_args args;
+    as_policy_scan policy;
+    as_error err;
+    aerospike* ptr;
+    int format = EXPORT_FORMAT_MSGPACK;
+    int error;
+
+    if (argc > 3 || argc < 1) {  // there should only be 1, 2 or 3 arguments
+        rb_raise(rb_eArgError, "wrong number of arguments (%d for 1..3)", argc);
+    }
+
+    vPath = vArgs[0];
+    Check_Type(vPath, T_STRING);
+
+    if (argc > 1 && TYPE(vArgs[1]) != T_NIL) {
+        Check_Type(vArgs[1], T_HASH);
+        vOptions = vArgs[1];
+    }
+
+    vFormat = rb_hash_option(vOptions, "format");
+    if (TYPE(vFormat) != T_NIL) {
+        GET_STRING(vFormat);
+        if (strcmp(StringValueCStr(vFormat), "ndjson") == 0) {
+            format = EXPORT_FORMAT_NDJSON;
+        } else if (strcmp(StringValueCStr(vFormat), "msgpack") != 0) {
+            rb_raise(rb_eArgError, "unknown export format %s (expected msgpack or ndjson)", StringValueCStr(vFormat));
+        }
+    }
+
+    as_policy_scan_init(&policy);
+    if(argc == 3 && TYPE(vArgs[2]) != T_NIL) {
+        SET_SCAN_POLICY(policy, vArgs[2]);
+    }
+
+    vClient = rb_iv_get(vSelf, "@client");
+    Data_Get_Struct(vClient, aerospike, ptr);
+
+    scan_prepare(vSelf, &scan, &data);
+    data.without_gvl = true;
+
+    error = export_writer_open(&writer, StringValueCStr(vPath), format, RTEST(rb_hash_option(vOptions, "compress")), &data);
+    if (error != 0) {
+        as_scan_destroy(&scan);
+        if (error == ENOTSUP) {
+            rb_raise(rb_eNotImpError, "compressed export is not supported (built without zlib)");
+        }
+        rb_syserr_fail_str(error, vPath);
+    }
+
+    args.ptr = ptr;
+    args.err = &err;
+    args.policy = &policy;
+    args.scan = &scan;
+    args.writer = &writer;
+    rb_thread_call_without_gvl(scan_export_without_gvl, &args, scan_export_interrupt, &writer);
+
+    as_scan_destroy(&scan);
+    rb_iv_set(vSelf, "@records_scanned", ULL2NUM(data.records_scanned));
+    rb_iv_set(vSelf, "@records_matched", ULL2NUM(data.records_matched));
+    rb_iv_set(vSelf, "@records_returned", ULL2NUM(data.records_returned));
+
+    error = export_writer_close(&writer);
+
+    if (writer.cancelled) {
+        rb_thread_check_ints();
+        raise_aerospike_exception(AEROSPIKE_ERR_CLIENT_ABORT, "export interrupted");
+    }
+
+    if (error != 0) {
+        rb_syserr_fail_str(error, vPath);
+    }
+
+    query_check_status(&data, args.status, &err);
+
+    return ULL2NUM(writer.records);
+}
+
+/*
+ * call-seq:
+ *   execute_background(module, function) -> AerospikeNative::Job
+ *   execute_background(module, function, args) -> AerospikeNative::Job
+ *   execute_background(module, function, args, scan_policy) -> AerospikeNative::Job
+ *
+ * apply record udf to every record on server side and return job handle,
+ * udf is used only by this job and isn't stored in the scan
+ */
+VALUE scan_execute_background(int argc, VALUE* vArgs, VALUE vSelf)
+{
+    VALUE vScanId, vUdf;
+
+    if (argc < 2 || argc > 4) {  // there should only be 2, 3 or 4 arguments
+        rb_raise(rb_eArgError, "wrong number of arguments (%d for 2..4)", argc);
+    }
+
+    vUdf = query_udf_new(argc > 3 ? 3 : argc, vArgs);
+    vScanId = scan_exec_udf(argc == 4 ? 1 : 0, &vArgs[3], vSelf, vUdf);
+
+    return rb_job_new(rb_iv_get(vSelf, "@client"), JOB_MODULE_SCAN, NUM2ULL(vScanId));
+}
 
 /*
  * call-seq:
@@ -253,18 +739,134 @@ VALUE scan_info(int argc, VALUE* vArgs, VALUE vSelf)
     return vHash;
 }
 
+/*
+ * call-seq:
+ *   partition_slices(workers) -> Array
+ *
+ * split all partitions into disjoint [partition_begin, partition_count] slices, one for each worker.
+ * When partition_slicing is :server slice is a digest predicate of the scan, so every worker reads only its records.
+ * When it is :client every worker scans the whole set and drops records of other slices,
+ * so cluster load grows with the number of workers
+ */
+VALUE scan_partition_slices(VALUE vSelf, VALUE vWorkers)
+{
+    VALUE vSlices;
+    int workers, n, begin = 0;
+
+    Check_Type(vWorkers, T_FIXNUM);
+    workers = FIX2INT(vWorkers);
+    if (workers <= 0 || workers > PARTITION_COUNT) {
+        rb_raise(rb_eArgError, "Incorrect workers count (expected 1..%d)", PARTITION_COUNT);
+    }
+
+    vSlices = rb_ary_new_capa(workers);
+    for(n = 0; n < workers; n++) {
+        int count = PARTITION_COUNT / workers + (n < PARTITION_COUNT % workers ? 1 : 0);
+        rb_ary_push(vSlices, rb_ary_new3(2, INT2FIX(begin), INT2FIX(count)));
+        begin += count;
+    }
+
+    return vSlices;
+}
+
+/*
+ * call-seq:
+ *   partition_slicing -> Symbol
+ *
+ * :server when partitions slice is applied by the server, :client when records are filtered after transfer
+ */
+VALUE scan_partition_slicing(VALUE vSelf)
+{
+#ifdef SCAN_SERVER_PARTITIONS
+    return ID2SYM(rb_intern("server"));
+#else
+    return ID2SYM(rb_intern("client"));
+#endif
+}
+
+/*
+ * call-seq:
+ *   merge_progress(progress_hashes) -> Hash
+ *
+ * merge progress hashes of the partition slices workers into one scan_info like hash.
+ * With client slicing every worker scans the whole set, so records_scanned of the result is the sum of records_matched
+ */
+VALUE scan_merge_progress(VALUE vSelf, VALUE vInfos)
+{
+    VALUE vHash;
+    uint64_t scanned = 0, returned = 0;
+    int n, idx, partitions = 0, done = 0, status;
+
+    Check_Type(vInfos, T_ARRAY);
+    idx = RARRAY_LEN(vInfos);
+
+    for(n = 0; n < idx; n++) {
+        VALUE vInfo = rb_ary_entry(vInfos, n);
+        VALUE vCount, vPercent, vValue;
+        Check_Type(vInfo, T_HASH);
+
+        vCount = rb_hash_aref(vInfo, rb_str_new2("partition_count"));
+        vPercent = rb_hash_aref(vInfo, rb_str_new2("progress_percent"));
+        if (TYPE(vCount) == T_FIXNUM) {
+            partitions += FIX2INT(vCount);
+            if (TYPE(vPercent) == T_FIXNUM) {
+                done += FIX2INT(vCount) * FIX2INT(vPercent);
+            }
+        }
+
+        vValue = rb_hash_aref(vInfo, rb_str_new2("records_matched"));
+        if (TYPE(vValue) == T_NIL) {
+            vValue = rb_hash_aref(vInfo, rb_str_new2("records_scanned"));
+        }
+        if (TYPE(vValue) != T_NIL) {
+            scanned += NUM2ULL(vValue);
+        }
+        vValue = rb_hash_aref(vInfo, rb_str_new2("records_returned"));
+        if (TYPE(vValue) != T_NIL) {
+            returned += NUM2ULL(vValue);
+        }
+    }
+
+    status = AS_SCAN_STATUS_INPROGRESS;
+    if (partitions == 0) {
+        status = AS_SCAN_STATUS_UNDEF;
+    } else if (done == PARTITION_COUNT * 100) {
+        status = AS_SCAN_STATUS_COMPLETED;
+    }
+
+    vHash = rb_hash_new();
+    rb_hash_aset(vHash, rb_str_new2("progress_percent"), INT2FIX(done / PARTITION_COUNT));
+    rb_hash_aset(vHash, rb_str_new2("records_scanned"), ULL2NUM(scanned));
+    rb_hash_aset(vHash, rb_str_new2("records_returned"), ULL2NUM(returned));
+    rb_hash_aset(vHash, rb_str_new2("status"), INT2FIX(status));
+
+    return vHash;
+}
+
 void define_scan()
 {
     ScanClass = rb_define_class_under(AerospikeNativeClass, "Scan", rb_cObject);
     rb_define_method(ScanClass, "initialize", scan_initialize, 3);
     rb_define_method(ScanClass, "exec", scan_exec, -1);
+    rb_define_method(ScanClass, "aggregate", scan_aggregate, -1);
+    rb_define_method(ScanClass, "export", scan_export, -1);
+    rb_define_method(ScanClass, "execute_background", scan_execute_background, -1);
     rb_define_method(ScanClass, "select", scan_select, -1);
     rb_define_method(ScanClass, "set_concurrent", scan_concurrent, 1);
     rb_define_method(ScanClass, "set_percent", scan_percent, 1);
     rb_define_method(ScanClass, "set_priority", scan_priority, 1);
     rb_define_method(ScanClass, "set_no_bins", scan_no_bins, 1);
+    rb_define_method(ScanClass, "set_records_per_second", scan_records_per_second, 1);
     rb_define_method(ScanClass, "apply", scan_apply, -1);
+    rb_define_method(ScanClass, "set_partitions", scan_partitions, 2);
+    rb_define_method(ScanClass, "filter", scan_set_filter, 1);
+    rb_define_method(ScanClass, "limit", query_set_limit, 1);
+    rb_define_method(ScanClass, "first", query_first, -1);
+    rb_define_method(ScanClass, "progress", scan_progress, 0);
     rb_define_singleton_method(ScanClass, "info", scan_info, -1);
+    rb_define_singleton_method(ScanClass, "partition_slices", scan_partition_slices, 1);
+    rb_define_singleton_method(ScanClass, "partition_slicing", scan_partition_slicing, 0);
+    rb_define_singleton_method(ScanClass, "merge_progress", scan_merge_progress, 1);
 
     rb_define_attr(ScanClass, "client", 1, 0);
     rb_define_attr(ScanClass, "select_bins", 1, 0);
@@ -272,9 +874,12 @@ void define_scan()
     rb_define_attr(ScanClass, "percent", 1, 0);
     rb_define_attr(ScanClass, "priority", 1, 0);
     rb_define_attr(ScanClass, "no_bins", 1, 0);
-    rb_define_attr(QueryClass, "udf_module", 1, 0);
-    rb_define_attr(QueryClass, "udf_function", 1, 0);
-    rb_define_attr(QueryClass, "udf_arglist", 1, 0);
+    rb_define_attr(ScanClass, "records_per_second", 1, 0);
+    rb_define_attr(ScanClass, "partition_begin", 1, 0);
+    rb_define_attr(ScanClass, "partition_count", 1, 0);
+    rb_define_attr(ScanClass, "udf_module", 1, 0);
+    rb_define_attr(ScanClass, "udf_function", 1, 0);
+    rb_define_attr(ScanClass, "udf_arglist", 1, 0);
 
     rb_define_const(ScanClass, "STATUS_UNDEFINED", INT2FIX(AS_SCAN_STATUS_UNDEF));
     rb_define_const(ScanClass, "STATUS_INPROGRESS", INT2FIX(AS_SCAN_STATUS_INPROGRESS));
@@ -285,4 +890,6 @@ void define_scan()
     rb_define_const(ScanClass, "PRIORITY_HIGH", INT2FIX(AS_SCAN_PRIORITY_HIGH));
     rb_define_const(ScanClass, "PRIORITY_MEDIUM", INT2FIX(AS_SCAN_PRIORITY_MEDIUM));
     rb_define_const(ScanClass, "PRIORITY_LOW", INT2FIX(AS_SCAN_PRIORITY_LOW));
+
+    rb_define_const(ScanClass, "PARTITION_COUNT", INT2FIX(PARTITION_COUNT));
 }
@@ -0,0 +1,386 @@
+#include "stats.h"
+#include "probes.h"
+#include <math.h>
+
+static const char* stats_command_names[STATS_COMMAND_COUNT] = {
+    "get", "put", "remove", "operate", "apply", "batch", "scan", "query"
+};
+
+static const char* stats_phase_names[STATS_PHASE_COUNT] = {
+    "network", "conversion", "total"
+};
+
+#define STATS_QUANTILES_COUNT 4
+static const double stats_quantiles[STATS_QUANTILES_COUNT] = { 0.5, 0.9, 0.99, 0.999 };
+static const char* stats_quantile_names[STATS_QUANTILES_COUNT] = { "p50", "p90", "p99", "p999" };
+
+static void stats_deallocate(void* p)
+{
+    free(p);
+}
+
+VALUE rb_stats_new()
+{
+    client_stats* stats = (client_stats*) calloc(1, sizeof(client_stats));
+
+    return Data_Wrap_Struct(rb_cObject, NULL, stats_deallocate, stats);
+}
+
+const char* stats_command_name(int command)
+{
+    return stats_command_names[command];
+}
+
+client_stats* stats_get(VALUE vClient)
+{
+    VALUE vStats = rb_iv_get(vClient, "@stats");
+    client_stats* stats;
+
+    if (TYPE(vStats) != T_DATA) {
+        return NULL;
+    }
+    Data_Get_Struct(vStats, client_stats, stats);
+
+    return stats;
+}
+
+static int stats_bucket(uint64_t value)
+{
+    int shift;
+
+    if (value < STATS_SUB_BUCKETS) {
+        return (int) value;
+    }
+    if (value >= ((uint64_t) 1 << STATS_MAX_BITS)) {
+        value = ((uint64_t) 1 << STATS_MAX_BITS) - 1;
+    }
+
+    shift = 63 - __builtin_clzll(value) - STATS_SUB_BUCKET_BITS;
+    return shift * STATS_SUB_BUCKETS + (int) (value >> shift);
+}
+
+/*
+ * highest value which falls into the bucket
+ */
+static uint64_t stats_bucket_value(int idx)
+{
+    int shift;
+
+    if (idx < STATS_SUB_BUCKETS) {
+        return (uint64_t) idx;
+    }
+
+    shift = idx / STATS_SUB_BUCKETS - 1;
+    return (((uint64_t) (idx - shift * STATS_SUB_BUCKETS) + 1) << shift) - 1;
+}
+
+/*
+ * lock-free, may be called from C client threads
+ */
+void stats_record(client_stats* stats, int command, int phase, uint64_t value)
+{
+    stats_histogram* histogram = &stats->histograms[command][phase];
+    uint64_t max = histogram->max;
+
+    __sync_fetch_and_add(&histogram->buckets[stats_bucket(value)], 1);
+    __sync_fetch_and_add(&histogram->sum, value);
+    __sync_fetch_and_add(&histogram->count, 1);
+
+    while (value > max && !__sync_bool_compare_and_swap(&histogram->max, max, value)) {
+        max = histogram->max;
+    }
+}
+
+void stats_timer_start(stats_timer* timer, VALUE vClient, int command)
+{
+    timer->stats = stats_get(vClient);
+    timer->command = command;
+    timer->network = 0;
+    timer->conversion = 0;
+    timer->id = PROBES_COMMAND_ID();
+    timer->sampled = events_sample();
+    timer->detailed = timer->sampled || PROBE_ENABLED(command__end);
+    timer->ns = "";
+    timer->set = "";
+    timer->key = NULL;
+    timer->bytes_sent = 0;
+    timer->bytes_received = 0;
+    timer->records = 0;
+    timer->phase_started_at = timer->stats == NULL && !timer->sampled ? 0 : stats_now();
+}
+
+void stats_timer_begin_network(stats_timer* timer)
+{
+    uint64_t now;
+
+    PROBE_COMMAND_BEGIN(timer->id, stats_command_names[timer->command], timer->ns, timer->set);
+    if (timer->stats == NULL && !timer->sampled) {
+        return;
+    }
+
+    now = stats_now();
+    timer->conversion += now - timer->phase_started_at;
+    timer->phase_started_at = now;
+}
+
+void stats_timer_end_network(stats_timer* timer)
+{
+    uint64_t now;
+
+    if (timer->stats == NULL && !timer->sampled) {
+        return;
+    }
+
+    now = stats_now();
+    timer->network += now - timer->phase_started_at;
+    timer->phase_started_at = now;
+}
+
+/*
+ * move records conversion made inside of callbacks from network to conversion phase
+ * and drop time spent in the block
+ */
+void stats_timer_exclude(stats_timer* timer, uint64_t conversion, uint64_t block)
+{
+    uint64_t excluded = conversion + block;
+
+    if (timer->stats == NULL && !timer->sampled) {
+        return;
+    }
+
+    timer->network = excluded > timer->network ? 0 : timer->network - excluded;
+    timer->conversion += conversion;
+}
+
+void stats_timer_key(stats_timer* timer, as_key* key)
+{
+    timer->key = key;
+    stats_timer_namespace(timer, key->ns, key->set);
+}
+
+void stats_timer_namespace(stats_timer* timer, const char* ns, const char* set)
+{
+    timer->ns = ns;
+    timer->set = set;
+}
+
+void stats_timer_sent(stats_timer* timer, const as_record* record)
+{
+    if (timer->detailed) {
+        timer->bytes_sent += events_record_size(record);
+    }
+}
+
+void stats_timer_received(stats_timer* timer, const as_record* record)
+{
+    if (timer->detailed) {
+        timer->bytes_received += events_record_size(record);
+    }
+}
+
+void stats_timer_records(stats_timer* timer, uint64_t records)
+{
+    timer->records = records;
+}
+
+static void stats_timer_push_event(stats_timer* timer, as_status status)
+{
+    command_event event;
+
+    memset(&event, 0, sizeof(command_event));
+    event.command = timer->command;
+    event.status = status;
+    strncpy(event.ns, timer->ns, AS_NAMESPACE_MAX_SIZE - 1);
+    strncpy(event.set, timer->set, AS_SET_MAX_SIZE - 1);
+    if (timer->key != NULL) {
+        memcpy(event.digest, as_key_digest(timer->key)->value, AS_DIGEST_VALUE_SIZE);
+        event.has_digest = true;
+    }
+    event.bytes_sent = timer->bytes_sent;
+    event.bytes_received = timer->bytes_received;
+    event.records = timer->records;
+    event.network = timer->network;
+    event.conversion = timer->conversion;
+
+    events_push(&event);
+}
+
+void stats_timer_finish(stats_timer* timer, as_status status)
+{
+    if (timer->stats == NULL && !timer->sampled) {
+        return;
+    }
+
+    timer->conversion += stats_now() - timer->phase_started_at;
+    if (timer->stats != NULL) {
+        stats_record(timer->stats, timer->command, STATS_PHASE_NETWORK, timer->network);
+        stats_record(timer->stats, timer->command, STATS_PHASE_CONVERSION, timer->conversion);
+        // phase percentiles don't add up, so whole command duration has its own histogram
+        stats_record(timer->stats, timer->command, STATS_PHASE_TOTAL, timer->network + timer->conversion);
+        if (status != AEROSPIKE_OK) {
+            __sync_fetch_and_add(&timer->stats->errors[timer->command], 1);
+        }
+    }
+
+    PROBE_COMMAND_END(timer->id, stats_command_names[timer->command], timer->ns, status, timer->network, timer->conversion,
+        timer->bytes_sent, timer->bytes_received, timer->records);
+    if (timer->sampled) {
+        stats_timer_push_event(timer, status);
+    }
+}
+
+static void stats_histogram_quantiles(const stats_histogram* histogram, uint64_t* values)
+{
+    uint64_t total = 0, seen = 0;
+    int idx, q = 0;
+
+    memset(values, 0, sizeof(uint64_t) * STATS_QUANTILES_COUNT);
+    for(idx = 0; idx < STATS_BUCKETS; idx++) {
+        total += histogram->buckets[idx];
+    }
+    if (total == 0) {
+        return;
+    }
+
+    for(idx = 0; idx < STATS_BUCKETS && q < STATS_QUANTILES_COUNT; idx++) {
+        seen += histogram->buckets[idx];
+        while (q < STATS_QUANTILES_COUNT && (double) seen >= ceil(stats_quantiles[q] * (double) total)) {
+            values[q] = stats_bucket_value(idx);
+            if (values[q] > histogram->max) {
+                values[q] = histogram->max;
+            }
+            q++;
+        }
+    }
+}
+
+static VALUE stats_histogram_hash(const stats_histogram* histogram)
+{
+    VALUE vHash = rb_hash_new();
+    uint64_t values[STATS_QUANTILES_COUNT];
+    uint64_t count = histogram->count;
+    int q;
+
+    stats_histogram_quantiles(histogram, values);
+
+    rb_hash_aset(vHash, rb_str_new2("count"), ULL2NUM(count));
+    rb_hash_aset(vHash, rb_str_new2("mean"), rb_float_new(count == 0 ? 0.0 : (double) histogram->sum / count / 1000.0));
+    rb_hash_aset(vHash, rb_str_new2("max"), rb_float_new(histogram->max / 1000.0));
+    for(q = 0; q < STATS_QUANTILES_COUNT; q++) {
+        rb_hash_aset(vHash, rb_str_new2(stats_quantile_names[q]), rb_float_new(values[q] / 1000.0));
+    }
+
+    return vHash;
+}
+
+static VALUE stats_to_hash(client_stats* stats)
+{
+    VALUE vHash = rb_hash_new();
+    int command, phase;
+
+    for(command = 0; command < STATS_COMMAND_COUNT; command++) {
+        VALUE vCommand = rb_hash_new();
+        rb_hash_aset(vCommand, rb_str_new2("count"), ULL2NUM(stats->histograms[command][STATS_PHASE_TOTAL].count));
+        rb_hash_aset(vCommand, rb_str_new2("errors"), ULL2NUM(stats->errors[command]));
+        for(phase = 0; phase < STATS_PHASE_COUNT; phase++) {
+            rb_hash_aset(vCommand, rb_str_new2(stats_phase_names[phase]), stats_histogram_hash(&stats->histograms[command][phase]));
+        }
+        rb_hash_aset(vHash, rb_str_new2(stats_command_names[command]), vCommand);
+    }
+
+    return vHash;
+}
+
+static VALUE stats_to_prometheus(client_stats* stats)
+{
+    VALUE vText = rb_str_new2("");
+    uint64_t values[STATS_QUANTILES_COUNT];
+    char line[256];
+    int command, phase, q;
+
+    rb_str_cat2(vText, "# HELP " STATS_PROMETHEUS_PREFIX "_command_duration_seconds Command duration by phase, phase=\"total\" is the whole command\n");
+    rb_str_cat2(vText, "# TYPE " STATS_PROMETHEUS_PREFIX "_command_duration_seconds summary\n");
+    for(command = 0; command < STATS_COMMAND_COUNT; command++) {
+        for(phase = 0; phase < STATS_PHASE_COUNT; phase++) {
+            const stats_histogram* histogram = &stats->histograms[command][phase];
+            stats_histogram_quantiles(histogram, values);
+            for(q = 0; q < STATS_QUANTILES_COUNT; q++) {
+                snprintf(line, sizeof(line), STATS_PROMETHEUS_PREFIX "_command_duration_seconds{command=\"%s\",phase=\"%s\",quantile=\"%g\"} %.9f\n",
+                    stats_command_names[command], stats_phase_names[phase], stats_quantiles[q], values[q] / 1e9);
+                rb_str_cat2(vText, line);
+            }
+            snprintf(line, sizeof(line), STATS_PROMETHEUS_PREFIX "_command_duration_seconds_sum{command=\"%s\",phase=\"%s\"} %.9f\n",
+                stats_command_names[command], stats_phase_names[phase], histogram->sum / 1e9);
+            rb_str_cat2(vText, line);
+            snprintf(line, sizeof(line), STATS_PROMETHEUS_PREFIX "_command_duration_seconds_count{command=\"%s\",phase=\"%s\"} %llu\n",
+                stats_command_names[command], stats_phase_names[phase], (unsigned long long) histogram->count);
+            rb_str_cat2(vText, line);
+        }
+    }
+
+    rb_str_cat2(vText, "# HELP " STATS_PROMETHEUS_PREFIX "_command_errors_total Failed commands\n");
+    rb_str_cat2(vText, "# TYPE " STATS_PROMETHEUS_PREFIX "_command_errors_total counter\n");
+    for(command = 0; command < STATS_COMMAND_COUNT; command++) {
+        snprintf(line, sizeof(line), STATS_PROMETHEUS_PREFIX "_command_errors_total{command=\"%s\"} %llu\n",
+            stats_command_names[command], (unsigned long long) stats->errors[command]);
+        rb_str_cat2(vText, line);
+    }
+
+    return vText;
+}
+
+/*
+ * call-seq:
+ *   stats -> Hash
+ *   stats(:prometheus) -> String
+ *
+ * return latency of commands (get, put, remove, operate, apply, batch, scan, query) measured inside the extension:
+ * network phase is aerospike client call, conversion phase is building of C values from ruby objects and back,
+ * total is the whole command duration. Hash contains count, errors and mean, max, p50, p90, p99, p999 in microseconds
+ * for network, conversion and total,
+ * :prometheus format returns summaries in seconds in Prometheus text exposition format
+ */
+VALUE client_stats_report(int argc, VALUE* vArgs, VALUE vSelf)
+{
+    VALUE vFormat = Qnil;
+    client_stats* stats;
+
+    if (argc > 1) {  // there should only be 0 or 1 argument
+        rb_raise(rb_eArgError, "wrong number of arguments (%d for 0..1)", argc);
+    }
+
+    stats = stats_get(vSelf);
+    if (stats == NULL) {
+        return Qnil;
+    }
+
+    if (argc == 1 && TYPE(vArgs[0]) != T_NIL) {
+        vFormat = vArgs[0];
+        GET_STRING(vFormat);
+        if (strcmp(StringValueCStr(vFormat), "prometheus") == 0) {
+            return stats_to_prometheus(stats);
+        }
+        if (strcmp(StringValueCStr(vFormat), "hash") != 0) {
+            rb_raise(rb_eArgError, "Incorrect stats format (expected :hash or :prometheus)");
+        }
+    }
+
+    return stats_to_hash(stats);
+}
+
+/*
+ * call-seq:
+ *   reset_stats -> nil
+ *
+ * clear latency histograms and error counters
+ */
+VALUE client_reset_stats(VALUE vSelf)
+{
+    client_stats* stats = stats_get(vSelf);
+
+    if (stats != NULL) {
+        memset(stats, 0, sizeof(client_stats));
+    }
+
+    return Qnil;
+}
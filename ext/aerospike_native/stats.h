@@ -0,0 +1,95 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include "aerospike_native.h"
+#include "events.h"
+#include <time.h>
+
+// log-linear buckets: values below 2^STATS_SUB_BUCKET_BITS ns are exact,
+// then every power of two is split into STATS_SUB_BUCKETS buckets (~3% precision)
+#define STATS_SUB_BUCKET_BITS 5
+#define STATS_SUB_BUCKETS (1 << STATS_SUB_BUCKET_BITS)
+#define STATS_MAX_BITS 40
+#define STATS_BUCKETS ((STATS_MAX_BITS - STATS_SUB_BUCKET_BITS + 1) * STATS_SUB_BUCKETS)
+#define STATS_PROMETHEUS_PREFIX "aerospike_native"
+
+enum StatsCommand {
+    STATS_COMMAND_GET,
+    STATS_COMMAND_PUT,
+    STATS_COMMAND_REMOVE,
+    STATS_COMMAND_OPERATE,
+    STATS_COMMAND_APPLY,
+    STATS_COMMAND_BATCH,
+    STATS_COMMAND_SCAN,
+    STATS_COMMAND_QUERY,
+    STATS_COMMAND_COUNT
+};
+
+enum StatsPhase {
+    STATS_PHASE_NETWORK,
+    STATS_PHASE_CONVERSION,
+    STATS_PHASE_TOTAL,
+    STATS_PHASE_COUNT
+};
+
+typedef struct stats_histogram_s {
+    uint64_t count;
+    uint64_t sum;
+    uint64_t max;
+    uint64_t buckets[STATS_BUCKETS];
+} stats_histogram;
+
+typedef struct client_stats_s {
+    stats_histogram histograms[STATS_COMMAND_COUNT][STATS_PHASE_COUNT];
+    uint64_t errors[STATS_COMMAND_COUNT];
+} client_stats;
+
+/*
+ * command timer: conversion phase is measured from start till begin_network
+ * and from end_network till finish, network phase in between.
+ * Bytes are counted only when the command is sampled for subscribers or probes are attached
+ */
+typedef struct stats_timer_s {
+    client_stats* stats;
+    int command;
+    uint64_t id;
+    uint64_t phase_started_at;
+    uint64_t network;
+    uint64_t conversion;
+    bool sampled;
+    bool detailed;
+    const char* ns;
+    const char* set;
+    as_key* key;
+    uint64_t bytes_sent;
+    uint64_t bytes_received;
+    uint64_t records;
+} stats_timer;
+
+static inline uint64_t stats_now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+VALUE rb_stats_new();
+const char* stats_command_name(int command);
+client_stats* stats_get(VALUE vClient);
+void stats_record(client_stats* stats, int command, int phase, uint64_t value);
+
+void stats_timer_start(stats_timer* timer, VALUE vClient, int command);
+void stats_timer_begin_network(stats_timer* timer);
+void stats_timer_end_network(stats_timer* timer);
+void stats_timer_exclude(stats_timer* timer, uint64_t conversion, uint64_t block);
+void stats_timer_key(stats_timer* timer, as_key* key);
+void stats_timer_namespace(stats_timer* timer, const char* ns, const char* set);
+void stats_timer_sent(stats_timer* timer, const as_record* record);
+void stats_timer_received(stats_timer* timer, const as_record* record);
+void stats_timer_records(stats_timer* timer, uint64_t records);
+void stats_timer_finish(stats_timer* timer, as_status status);
+
+VALUE client_stats_report(int argc, VALUE* vArgs, VALUE vSelf);
+VALUE client_reset_stats(VALUE vSelf);
+
+#endif // STATS_H
@@ -1,6 +1,16 @@
 #include "udf.h"
 #include "client.h"
 #include <aerospike/aerospike_udf.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <strings.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <ruby/thread.h>
+#ifdef HAVE_OPENSSL_SHA_H
+#include <openssl/sha.h>
+#endif
 
 VALUE UdfClass;
 
@@ -12,73 +22,387 @@ VALUE udf_initialize(VALUE vSelf, VALUE vClient)
     return vSelf;
 }
 
+static int udf_content_map(const char* path, udf_content* content)
+{
+    struct stat st;
+    int fd, error;
+
+    content->data = NULL;
+    content->size = 0;
+    content->mapped = false;
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return errno;
+    }
+
+    if (fstat(fd, &st) != 0) {
+        error = errno;
+        close(fd);
+        return error;
+    }
+
+    if (st.st_size > 0) {
+        void* data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            error = errno;
+            close(fd);
+            return error;
+        }
+        content->data = (uint8_t*) data;
+        content->size = st.st_size;
+        content->mapped = true;
+    }
+
+    close(fd);
+    return 0;
+}
+
+static void udf_content_unmap(udf_content* content)
+{
+    if (content->mapped) {
+        munmap(content->data, content->size);
+        content->mapped = false;
+    }
+}
+
+/*
+ * check local content against hash reported by udf-list (hex sha1 of module), modules are never unchanged
+ * if hash can't be computed
+ */
+static bool udf_content_unchanged(as_udf_files* files, const char* name, const udf_content* content)
+{
+#ifdef HAVE_OPENSSL_SHA_H
+    unsigned char digest[SHA_DIGEST_LENGTH];
+    char hash[SHA_DIGEST_LENGTH * 2 + 1];
+    uint32_t n;
+
+    if (files == NULL) {
+        return false;
+    }
+
+    SHA1(content->size > 0 ? content->data : (const uint8_t*) "", content->size, digest);
+    for(n = 0; n < SHA_DIGEST_LENGTH; n++) {
+        sprintf(hash + n * 2, "%02x", digest[n]);
+    }
+
+    for(n = 0; n < files->size; n++) {
+        if (strcmp(files->entries[n].name, name) == 0) {
+            return strncasecmp((const char*) files->entries[n].hash, hash, SHA_DIGEST_LENGTH * 2) == 0;
+        }
+    }
+#endif
+
+    return false;
+}
+
+static as_status udf_content_put(aerospike* as, as_error* err, as_policy_info* policy, const char* name, udf_content* content)
+{
+    as_bytes bytes;
+    as_status status;
+
+    // content is only wrapped, mapped file is unmapped by caller
+    as_bytes_init_wrap(&bytes, content->data, (uint32_t) content->size, false);
+    status = aerospike_udf_put(as, err, policy, name, AS_UDF_TYPE_LUA, &bytes);
+    as_bytes_destroy(&bytes);
+
+    return status;
+}
+
+/*
+ * call-seq:
+ *   put(filename) -> true or false
+ *   put(filename, policy_settings) -> true or false
+ *   put(name, body) -> true or false
+ *   put(name, body, policy_settings) -> true or false
+ *
+ * register lua module from file (mapped into memory, any size) or from string body. Module is not uploaded again
+ * if its hash in list is equal to local content hash (returns false), use \{'force' => true\} in policy_settings to upload anyway
+ */
 VALUE udf_put(int argc, VALUE* vArgs, VALUE vSelf)
 {
-    VALUE vClient;
-    FILE* file;
+    VALUE vClient, vSettings = Qnil, vBody = Qnil;
     aerospike* ptr;
-//    uint8_t* content; //, p_write;
-    int read, size;
     as_error err;
     as_string base_string;
-    as_bytes udf_content;
     as_policy_info policy;
+    as_udf_files files;
+    udf_content content;
+    const char* name;
+    bool force = false, unchanged;
+    as_status status;
+    int error;
 
-    if (argc > 2 || argc < 1) {  // there should only be 1 or 2 argument
-        rb_raise(rb_eArgError, "wrong number of arguments (%d for 1..2)", argc);
+    if (argc > 3 || argc < 1) {  // there should only be 1..3 arguments
+        rb_raise(rb_eArgError, "wrong number of arguments (%d for 1..3)", argc);
     }
 
     Check_Type(vArgs[0], T_STRING);
-    file = fopen(StringValueCStr(vArgs[0]), "r");
-
-    if (!file) {
-        rb_funcall(LoggerInstance, rb_intern("warn"), 1, rb_str_new2("register UDF: File Not Found"));
-        return Qfalse;
+    if (argc > 1 && TYPE(vArgs[1]) == T_STRING) {
+        vBody = vArgs[1];
+        if (argc == 3) {
+            vSettings = vArgs[2];
+        }
+    } else if (argc == 3) {
+        rb_raise(rb_eTypeError, "wrong argument type (expected String body)");
+    } else if (argc == 2) {
+        vSettings = vArgs[1];
     }
 
     as_policy_info_init(&policy);
-    if(argc == 2 && TYPE(vArgs[1]) != T_NIL) {
-        SET_INFO_POLICY(policy, vArgs[1]);
+    if (TYPE(vSettings) != T_NIL) {
+        SET_INFO_POLICY(policy, vSettings);
+        force = RTEST(rb_hash_option(vSettings, "force"));
+    }
+
+    if (TYPE(vBody) == T_STRING) {
+        name = StringValueCStr(vArgs[0]);
+        content.data = (uint8_t*) RSTRING_PTR(vBody);
+        content.size = RSTRING_LEN(vBody);
+        content.mapped = false;
+    } else {
+        error = udf_content_map(StringValueCStr(vArgs[0]), &content);
+        if (error == ENOENT) {
+            rb_funcall(LoggerInstance, rb_intern("warn"), 1, rb_str_new2("register UDF: File Not Found"));
+            return Qfalse;
+        } else if (error != 0) {
+            rb_syserr_fail_str(error, vArgs[0]);
+        }
+        name = as_basename(&base_string, StringValueCStr(vArgs[0]));
     }
 
-    // Read the file's content into a local buffer.
+    vClient = rb_iv_get(vSelf, "@client");
+    Data_Get_Struct(vClient, aerospike, ptr);
 
-    uint8_t* content = (uint8_t*)malloc(1024 * 1024);
+    if (!force) {
+        as_udf_files_init(&files, 0);
+        if (aerospike_udf_list(ptr, &err, &policy, &files) != AEROSPIKE_OK) {
+            as_udf_files_destroy(&files);
+            udf_content_unmap(&content);
+            raise_aerospike_exception(err.code, err.message);
+        }
+        unchanged = udf_content_unchanged(&files, name, &content);
+        as_udf_files_destroy(&files);
+        if (unchanged) {
+            udf_content_unmap(&content);
+            return Qfalse;
+        }
+    }
 
-    if (! content) {
-        rb_funcall(LoggerInstance, rb_intern("warn"), 1, rb_str_new2("script content allocation failed"));
-        return Qfalse;
+    // Register the UDF file in the database cluster.
+    status = udf_content_put(ptr, &err, &policy, name, &content);
+    udf_content_unmap(&content);
+    if (status != AEROSPIKE_OK) {
+        raise_aerospike_exception(err.code, err.message);
     }
 
-    uint8_t* p_write = content;
-    read = (int)fread(p_write, 1, 512, file);
-    size = 0;
+    return Qtrue;
+}
+
+static void* udf_put_all_worker(void* ptr)
+{
+    udf_put_all_args* args = (udf_put_all_args*) ptr;
+
+    while (!args->cancelled) {
+        udf_upload* upload;
+        udf_content content;
+        size_t idx;
+
+        pthread_mutex_lock(&args->lock);
+        idx = args->next++;
+        pthread_mutex_unlock(&args->lock);
+        if (idx >= args->count) {
+            break;
+        }
 
-    while (read) {
-        size += read;
-        p_write += read;
-        read = (int)fread(p_write, 1, 512, file);
+        upload = &args->uploads[idx];
+        upload->error = udf_content_map(upload->path, &content);
+        if (upload->error != 0) {
+            continue;
+        }
+
+        if (!udf_content_unchanged(args->files, upload->name, &content)) {
+            upload->status = udf_content_put(args->as, &upload->err, args->policy, upload->name, &content);
+            upload->uploaded = upload->status == AEROSPIKE_OK;
+        }
+        udf_content_unmap(&content);
+    }
+
+    return NULL;
+}
+
+static void* udf_put_all_without_gvl(void* ptr)
+{
+    udf_put_all_args* args = (udf_put_all_args*) ptr;
+    pthread_t threads[UDF_PUT_ALL_CONCURRENCY];
+    int n, count = 0;
+    size_t idx;
+
+    for(n = 0; n < UDF_PUT_ALL_CONCURRENCY && (size_t) n < args->count; n++) {
+        if (pthread_create(&threads[count], NULL, udf_put_all_worker, args) == 0) {
+            count++;
+        }
+    }
+    if (count == 0) {
+        udf_put_all_worker(args);
+    }
+    for(n = 0; n < count; n++) {
+        pthread_join(threads[n], NULL);
+    }
+
+    // all modules are sent, now wait until every node has them
+    for(idx = 0; idx < args->count && args->wait && !args->cancelled; idx++) {
+        udf_upload* upload = &args->uploads[idx];
+        if (upload->uploaded) {
+            upload->status = aerospike_udf_put_wait(args->as, &upload->err, args->policy, upload->name, UDF_WAIT_INTERVAL);
+        }
+    }
+
+    return NULL;
+}
+
+static void udf_put_all_interrupt(void* ptr)
+{
+    udf_put_all_args* args = (udf_put_all_args*) ptr;
+    args->cancelled = true;
+}
+
+static VALUE udf_put_all_run(VALUE vArgs)
+{
+    udf_put_all_args* args = (udf_put_all_args*) vArgs;
+    VALUE vResult = rb_ary_new();
+    size_t idx;
+
+    rb_thread_call_without_gvl(udf_put_all_without_gvl, args, udf_put_all_interrupt, args);
+    rb_thread_check_ints();
+
+    for(idx = 0; idx < args->count; idx++) {
+        udf_upload* upload = &args->uploads[idx];
+        if (upload->error != 0) {
+            rb_syserr_fail_str(upload->error, rb_str_new2(upload->path));
+        }
+        if (upload->status != AEROSPIKE_OK) {
+            raise_aerospike_exception(upload->err.code, upload->err.message);
+        }
+        if (upload->uploaded) {
+            rb_ary_push(vResult, rb_str_new2(upload->name));
+        }
+    }
+
+    return vResult;
+}
+
+static VALUE udf_put_all_cleanup(VALUE vArgs)
+{
+    udf_put_all_args* args = (udf_put_all_args*) vArgs;
+
+    if (args->files != NULL) {
+        as_udf_files_destroy(args->files);
     }
+    free(args->uploads);
+    pthread_mutex_destroy(&args->lock);
 
-    fclose(file);
+    return Qnil;
+}
 
-    // Wrap the local buffer as an as_bytes object.
-    as_bytes_init_wrap(&udf_content, content, size, true);
+/*
+ * call-seq:
+ *   put_all(dir) -> Array
+ *   put_all(dir, policy_settings) -> Array
+ *
+ * register all changed *.lua modules of directory in parallel and wait once until all nodes have them,
+ * returns names of uploaded modules. Use \{'force' => true\} to upload unchanged modules too and \{'wait' => false\} to skip waiting
+ */
+VALUE udf_put_all(int argc, VALUE* vArgs, VALUE vSelf)
+{
+    VALUE vClient, vDir;
+    aerospike* ptr;
+    as_error err;
+    as_policy_info policy;
+    as_udf_files files;
+    udf_put_all_args args;
+    DIR* dir;
+    struct dirent* entry;
+    const char* path;
+    size_t capacity = 16;
+
+    if (argc > 2 || argc < 1) {  // there should only be 1 or 2 arguments
+        rb_raise(rb_eArgError, "wrong number of arguments (%d for 1..2)", argc);
+    }
+
+    vDir = vArgs[0];
+    Check_Type(vDir, T_STRING);
+
+    memset(&args, 0, sizeof(args));
+    args.wait = true;
+    as_policy_info_init(&policy);
+    if (argc == 2 && TYPE(vArgs[1]) != T_NIL) {
+        SET_INFO_POLICY(policy, vArgs[1]);
+        if (RTEST(rb_hash_option(vArgs[1], "force"))) {
+            args.files = NULL;
+        } else {
+            args.files = &files;
+        }
+        args.wait = rb_hash_option(vArgs[1], "wait") != Qfalse;
+    } else {
+        args.files = &files;
+    }
 
     vClient = rb_iv_get(vSelf, "@client");
     Data_Get_Struct(vClient, aerospike, ptr);
 
-    // Register the UDF file in the database cluster.
-    if (aerospike_udf_put(ptr, &err, &policy, as_basename(&base_string, StringValueCStr(vArgs[0])), AS_UDF_TYPE_LUA,
-            &udf_content) != AEROSPIKE_OK) {
-        as_bytes_destroy(&udf_content);
-        raise_aerospike_exception(err.code, err.message);
+    // nothing inside of readdir loop may raise, otherwise dir leaks
+    path = StringValueCStr(vDir);
+    dir = opendir(path);
+    if (dir == NULL) {
+        rb_sys_fail_str(vDir);
     }
 
-    // This frees the local buffer.
-    as_bytes_destroy(&udf_content);
+    args.uploads = (udf_upload*) calloc(capacity, sizeof(udf_upload));
+    if (args.uploads == NULL) {
+        closedir(dir);
+        rb_raise(rb_eNoMemError, "failed to allocate udf uploads");
+    }
+    while ((entry = readdir(dir)) != NULL) {
+        size_t len = strlen(entry->d_name);
+        udf_upload* upload;
 
-    return Qtrue;
+        if (len <= 4 || strcmp(entry->d_name + len - 4, ".lua") != 0 || len >= AS_UDF_FILE_NAME_SIZE) {
+            continue;
+        }
+        if (args.count == capacity) {
+            upload = (udf_upload*) realloc(args.uploads, capacity * 2 * sizeof(udf_upload));
+            if (upload == NULL) {
+                closedir(dir);
+                free(args.uploads);
+                rb_raise(rb_eNoMemError, "failed to allocate udf uploads");
+            }
+            capacity *= 2;
+            args.uploads = upload;
+            memset(args.uploads + args.count, 0, (capacity - args.count) * sizeof(udf_upload));
+        }
+
+        upload = &args.uploads[args.count++];
+        snprintf(upload->path, sizeof(upload->path), "%s/%s", path, entry->d_name);
+        strcpy(upload->name, entry->d_name);
+        upload->status = AEROSPIKE_OK;
+    }
+    closedir(dir);
+
+    if (args.files != NULL) {
+        as_udf_files_init(&files, 0);
+        if (aerospike_udf_list(ptr, &err, &policy, &files) != AEROSPIKE_OK) {
+            as_udf_files_destroy(&files);
+            free(args.uploads);
+            raise_aerospike_exception(err.code, err.message);
+        }
+    }
+
+    args.as = ptr;
+    args.policy = &policy;
+    pthread_mutex_init(&args.lock, NULL);
+
+    return rb_ensure(udf_put_all_run, (VALUE) &args, udf_put_all_cleanup, (VALUE) &args);
 }
 
 VALUE udf_remove(int argc, VALUE* vArgs, VALUE vSelf)
@@ -235,6 +559,7 @@ void define_udf()
     UdfClass = rb_define_class_under(AerospikeNativeClass, "Udf", rb_cObject);
     rb_define_method(UdfClass, "initialize", udf_initialize, 1);
     rb_define_method(UdfClass, "put", udf_put, -1);
+    rb_define_method(UdfClass, "put_all", udf_put_all, -1);
     rb_define_method(UdfClass, "remove", udf_remove, -1);
     rb_define_method(UdfClass, "list", udf_list, -1);
     rb_define_method(UdfClass, "get", udf_get, -1);
@@ -2,6 +2,39 @@
 #define UDF_H
 
 #include "aerospike_native.h"
+#include <limits.h>
+#include <pthread.h>
+#include <aerospike/as_udf.h>
+
+#define UDF_PUT_ALL_CONCURRENCY 8
+#define UDF_WAIT_INTERVAL 100
+
+typedef struct udf_content_s {
+    uint8_t* data;
+    size_t size;
+    bool mapped;
+} udf_content;
+
+typedef struct udf_upload_s {
+    char path[PATH_MAX];
+    char name[AS_UDF_FILE_NAME_SIZE];
+    bool uploaded;
+    int error;
+    as_status status;
+    as_error err;
+} udf_upload;
+
+typedef struct udf_put_all_args_s {
+    aerospike* as;
+    as_policy_info* policy;
+    as_udf_files* files;
+    udf_upload* uploads;
+    size_t count;
+    size_t next;
+    bool wait;
+    pthread_mutex_t lock;
+    volatile bool cancelled;
+} udf_put_all_args;
 
 RUBY_EXTERN VALUE UdfClass;
 void define_udf();